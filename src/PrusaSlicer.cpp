@@ -518,6 +518,8 @@ int CLI::run(int argc, char **argv)
                 if (printer_technology == ptFFF) {
                     for (auto* mo : model.objects)
                         fff_print.auto_assign_extruders(mo);
+                    const ConfigOptionBool *opt_low_memory = m_config.opt<ConfigOptionBool>("low_memory");
+                    fff_print.set_low_memory(opt_low_memory != nullptr && opt_low_memory->value);
                 }
                 print->apply(model, m_print_config);
                 std::string err = print->validate();
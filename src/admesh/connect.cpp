@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 
 #include <boost/predef/other/endian.h>
@@ -34,6 +35,11 @@
 #define BOOST_POOL_NO_MT
 #include <boost/pool/object_pool.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/parallel_sort.h>
+
 #include "stl.h"
 
 struct HashEdge {
@@ -51,12 +57,13 @@ struct HashEdge {
 	int        which_edge;
 	HashEdge  *next;
 
-	void load_exact(stl_file *stl, const stl_vertex *a, const stl_vertex *b)
+	// shortest_edge is updated with the length of this edge, measured by the maximum norm.
+	void load_exact(float &shortest_edge, const stl_vertex *a, const stl_vertex *b)
 	{
 		{
 	    	stl_vertex diff = (*a - *b).cwiseAbs();
 	    	float max_diff = std::max(diff(0), std::max(diff(1), diff(2)));
-	    	stl->stats.shortest_edge = std::min(max_diff, stl->stats.shortest_edge);
+	    	shortest_edge = std::min(max_diff, shortest_edge);
 	  	}
 
 	  	// Ensure identical vertex ordering of equal edges.
@@ -120,6 +127,25 @@ private:
 	}
 };
 
+// Connect edge_a with edge_b: only the two neighbor slots of the two edges are written,
+// thus edges of different pairs may be connected from multiple threads.
+static void connect_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
+{
+	// Facet a's neighbor is facet b
+	stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
+	stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
+
+	// Facet b's neighbor is facet a
+	stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
+	stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
+
+	if ((edge_a.which_edge < 3 && edge_b.which_edge < 3) || (edge_a.which_edge > 2 && edge_b.which_edge > 2)) {
+		// These facets are oriented in opposite directions, their normals are probably messed up.
+		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
+		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
+	}
+}
+
 struct HashTableEdges {
 	HashTableEdges(size_t number_of_faces) {
 		this->M = (int)hash_size_from_nr_faces(number_of_faces);
@@ -242,19 +268,7 @@ private:
 	// Connect edge_a with edge_b, update edge connection statistics.
 	static void record_neighbors(stl_file *stl, const HashEdge &edge_a, const HashEdge &edge_b)
 	{
-		// Facet a's neighbor is facet b
-		stl->neighbors_start[edge_a.facet_number].neighbor[edge_a.which_edge % 3] = edge_b.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] = (edge_b.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		// Facet b's neighbor is facet a
-		stl->neighbors_start[edge_b.facet_number].neighbor[edge_b.which_edge % 3] = edge_a.facet_number;	/* sets the .neighbor part */
-		stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] = (edge_a.which_edge + 2) % 3; /* sets the .which_vertex_not part */
-
-		if ((edge_a.which_edge < 3 && edge_b.which_edge < 3) || (edge_a.which_edge > 2 && edge_b.which_edge > 2)) {
-			// These facets are oriented in opposite directions, their normals are probably messed up.
-			stl->neighbors_start[edge_a.facet_number].which_vertex_not[edge_a.which_edge % 3] += 3;
-			stl->neighbors_start[edge_b.facet_number].which_vertex_not[edge_b.which_edge % 3] += 3;
-		}
+		connect_neighbors(stl, edge_a, edge_b);
 
 		// Count successful connects:
 		// Total connects:
@@ -454,22 +468,82 @@ void stl_check_facets_exact(stl_file *stl)
 		  	++ i;
   	}
 
-  	// Initialize hash table.
-  	HashTableEdges hash_table(stl->stats.number_of_facets);
 	for (auto &neighbor : stl->neighbors_start)
 		neighbor.reset();
 
-  	// Connect neighbor edges.
-	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i) {
-		const stl_facet &facet = stl->facet_start[i];
-		for (int j = 0; j < 3; ++ j) {
-			HashEdge edge;
-			edge.facet_number = i;
-			edge.which_edge = j;
-			edge.load_exact(stl, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
-			hash_table.insert_edge_exact(stl, edge);
-		}
-	}
+	// Instead of inserting the edges one by one into HashTableEdges, collect all the edges in parallel
+	// and sort them by their keys. Edges of equal keys are ordered by their facet and edge index,
+	// which is the order in which they would have been inserted into the hash table.
+	std::vector<HashEdge> edges(size_t(stl->stats.number_of_facets) * 3);
+	float shortest_edge = tbb::parallel_reduce(tbb::blocked_range<uint32_t>(0, stl->stats.number_of_facets, 4096), stl->stats.shortest_edge,
+		[stl, &edges](const tbb::blocked_range<uint32_t> &range, float shortest_edge) {
+			for (uint32_t i = range.begin(); i < range.end(); ++ i) {
+				const stl_facet &facet = stl->facet_start[i];
+				for (int j = 0; j < 3; ++ j) {
+					HashEdge &edge = edges[i * 3 + j];
+					edge.facet_number = i;
+					edge.which_edge = j;
+					edge.next = nullptr;
+					edge.load_exact(shortest_edge, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
+				}
+			}
+			return shortest_edge;
+		},
+		[](float a, float b) { return std::min(a, b); });
+	stl->stats.shortest_edge = shortest_edge;
+	tbb::parallel_sort(edges.begin(), edges.end(), [](const HashEdge &l, const HashEdge &r) {
+		int cmp = memcmp(l.key, r.key, sizeof(l.key));
+		return cmp < 0 || (cmp == 0 && l.facet_number * 3 + l.which_edge % 3 < r.facet_number * 3 + r.which_edge % 3);
+	});
+
+	// Connect neighbor edges. Each run of equal keys is matched independently the same way HashTableEdges::insert_edge() does:
+	// an edge is connected with the first yet unconnected edge of another facet, otherwise it stays unconnected.
+	stl->stats.connected_edges = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, edges.size(), 16384), 0,
+		[stl, &edges](const tbb::blocked_range<size_t> &range, int connected_edges) {
+			std::vector<const HashEdge*> unmatched;
+			for (size_t i = range.begin(); i < range.end(); ++ i) {
+				if (i > 0 && edges[i - 1] == edges[i])
+					// Not the start of a run, it is processed together with the start of the run.
+					continue;
+				unmatched.clear();
+				for (size_t j = i; j < edges.size() && edges[j] == edges[i]; ++ j) {
+					const HashEdge &edge = edges[j];
+					auto it = std::find_if(unmatched.begin(), unmatched.end(), [&edge](const HashEdge *other) { return other->facet_number != edge.facet_number; });
+					if (it == unmatched.end())
+						unmatched.emplace_back(&edge);
+					else {
+						connect_neighbors(stl, edge, **it);
+						unmatched.erase(it);
+						connected_edges += 2;
+					}
+				}
+			}
+			return connected_edges;
+		},
+		std::plus<int>());
+
+	// Count the connected facets. Each edge has been connected at most once, thus the counts are the same
+	// as if they were updated incrementally by HashTableEdges::record_neighbors().
+	struct ConnectedFacets { int edges_1 = 0; int edges_2 = 0; int edges_3 = 0; };
+	ConnectedFacets connected = tbb::parallel_reduce(tbb::blocked_range<uint32_t>(0, stl->stats.number_of_facets, 16384), ConnectedFacets(),
+		[stl](const tbb::blocked_range<uint32_t> &range, ConnectedFacets connected) {
+			for (uint32_t i = range.begin(); i < range.end(); ++ i) {
+				int num_neighbors = stl->neighbors_start[i].num_neighbors();
+				connected.edges_1 += num_neighbors >= 1;
+				connected.edges_2 += num_neighbors >= 2;
+				connected.edges_3 += num_neighbors == 3;
+			}
+			return connected;
+		},
+		[](ConnectedFacets a, const ConnectedFacets &b) {
+			a.edges_1 += b.edges_1;
+			a.edges_2 += b.edges_2;
+			a.edges_3 += b.edges_3;
+			return a;
+		});
+	stl->stats.connected_facets_1_edge = connected.edges_1;
+	stl->stats.connected_facets_2_edge = connected.edges_2;
+	stl->stats.connected_facets_3_edge = connected.edges_3;
 
 #if 0
 	printf("Number of faces: %d, number of manifold edges: %d, number of connected edges: %d, number of unconnected edges: %d\r\n", 
@@ -661,7 +735,7 @@ void stl_fill_holes(stl_file *stl)
 			HashEdge edge;
 	  		edge.facet_number = i;
 	  		edge.which_edge = j;
-	  		edge.load_exact(stl, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
+	  		edge.load_exact(stl->stats.shortest_edge, &facet.vertex[j], &facet.vertex[(j + 1) % 3]);
 	  		hash_table.insert_edge_exact(stl, edge);
 		}
 	}
@@ -711,7 +785,7 @@ void stl_fill_holes(stl_file *stl)
 	      				HashEdge edge;
 	        			edge.facet_number = stl->stats.number_of_facets - 1;
 	        			edge.which_edge = k;
-	        			edge.load_exact(stl, &new_facet.vertex[k], &new_facet.vertex[(k + 1) % 3]);
+	        			edge.load_exact(stl->stats.shortest_edge, &new_facet.vertex[k], &new_facet.vertex[(k + 1) % 3]);
 	        			hash_table.insert_edge_exact(stl, edge);
 	      			}
 	      			break;
@@ -65,51 +65,64 @@ static void reverse_facet(stl_file *stl, int facet_num)
 	stl->neighbors_start[facet_num].which_vertex_not[2] = (stl->neighbors_start[facet_num].which_vertex_not[2] + 3) % 6;
 }
 
-// Returns true if the normal was flipped.
-static bool check_normal_vector(stl_file *stl, int facet_num, int normal_fix_flag)
+enum class NormalStatus {
+	// Stored normal is within tolerance.
+	Exact,
+	// Stored normal is not within tolerance, but its direction is OK.
+	Direction,
+	// Stored normal is not within tolerance and backwards.
+	Backwards,
+	Unknown
+};
+
+// Compare the stored normal of the facet with the normal calculated from its vertices, which is returned in "normal".
+static NormalStatus classify_normal_vector(const stl_facet &facet, stl_normal &normal)
 {
-	stl_facet *facet = &stl->facet_start[facet_num];
-
-	stl_normal normal;
-	stl_calculate_normal(normal, facet);
+	normal = (facet.vertex[1] - facet.vertex[0]).cross(facet.vertex[2] - facet.vertex[0]);
 	stl_normalize_vector(normal);
-	stl_normal normal_dif = (normal - facet->normal).cwiseAbs();
+	stl_normal normal_dif = (normal - facet.normal).cwiseAbs();
 
 	const float eps = 0.001f;
-	if (normal_dif(0) < eps && normal_dif(1) < eps && normal_dif(2) < eps) {
-		// Normal is within tolerance. It is not really necessary to change the values here, but just for consistency, I will.
-		facet->normal = normal;
-		return false;
-	}
+	if (normal_dif(0) < eps && normal_dif(1) < eps && normal_dif(2) < eps)
+		return NormalStatus::Exact;
 
-	stl_normal test_norm = facet->normal;
+	stl_normal test_norm = facet.normal;
 	stl_normalize_vector(test_norm);
 	normal_dif = (normal - test_norm).cwiseAbs();
-	if (normal_dif(0) < eps && normal_dif(1) < eps && normal_dif(2) < eps) {
-		// The normal is not within tolerance, but direction is OK.
-		if (normal_fix_flag) {
-	  		facet->normal = normal;
-	  		++ stl->stats.normals_fixed;
-		}
-		return false;
-	}
+	if (normal_dif(0) < eps && normal_dif(1) < eps && normal_dif(2) < eps)
+		return NormalStatus::Direction;
 
 	test_norm *= -1.f;
 	normal_dif = (normal - test_norm).cwiseAbs();
-	if (normal_dif(0) < eps && normal_dif(1) < eps && normal_dif(2) < eps) {
-		// The normal is not within tolerance and backwards.
-		if (normal_fix_flag) {
-	  		facet->normal = normal;
-	  		++ stl->stats.normals_fixed;
-		}
-		return true;
+	if (normal_dif(0) < eps && normal_dif(1) < eps && normal_dif(2) < eps)
+		return NormalStatus::Backwards;
+
+	return NormalStatus::Unknown;
+}
+
+// Returns true if the normal was flipped.
+static bool check_normal_vector(stl_file *stl, int facet_num, int normal_fix_flag)
+{
+	stl_facet *facet = &stl->facet_start[facet_num];
+
+	stl_normal   normal;
+	NormalStatus status = classify_normal_vector(*facet, normal);
+	if (status == NormalStatus::Exact) {
+		// Normal is within tolerance. It is not really necessary to change the values here, but just for consistency, I will.
+		facet->normal = normal;
+		return false;
 	}
 	if (normal_fix_flag) {
 		facet->normal = normal;
 		++ stl->stats.normals_fixed;
 	}
-	// Status is unknown.
-	return false;
+	return status == NormalStatus::Backwards;
+}
+
+bool stl_normal_backwards(const stl_facet &facet)
+{
+	stl_normal normal;
+	return classify_normal_vector(facet, normal) == NormalStatus::Backwards;
 }
 
 void stl_fix_normal_directions(stl_file *stl)
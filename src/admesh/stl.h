@@ -168,6 +168,8 @@ struct indexed_triangle_set
 };
 
 extern bool stl_open(stl_file *stl, const char *file);
+// Fill in the stl_file from a binary STL already loaded into memory, the same way stl_open() reads a binary STL file.
+extern bool stl_open_binary(stl_file *stl, const char *data, size_t size);
 extern void stl_stats_out(stl_file *stl, FILE *file, char *input_file);
 extern bool stl_print_neighbors(stl_file *stl, char *file);
 extern bool stl_write_ascii(stl_file *stl, const char *file, const char *label);
@@ -182,6 +184,8 @@ extern bool stl_write_quad_object(stl_file *stl, char *file);
 extern void stl_verify_neighbors(stl_file *stl);
 extern void stl_fill_holes(stl_file *stl);
 extern void stl_fix_normal_directions(stl_file *stl);
+// Is the stored normal of the facet backwards? stl_fix_normal_directions() orients the first facet of each part by this test.
+extern bool stl_normal_backwards(const stl_facet &facet);
 extern void stl_fix_normal_values(stl_file *stl);
 extern void stl_reverse_all_facets(stl_file *stl);
 extern void stl_translate(stl_file *stl, float x, float y, float z);
@@ -245,6 +245,41 @@ bool stl_open(stl_file *stl, const char *file)
   	return result;
 }
 
+bool stl_open_binary(stl_file *stl, const char *data, size_t size)
+{
+	stl->clear();
+	if (size < STL_MIN_FILE_SIZE || (size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) {
+		BOOST_LOG_TRIVIAL(error) << "stl_open_binary: The data has the wrong size.";
+		return false;
+	}
+	stl->stats.type = binary;
+	stl->stats.number_of_facets = uint32_t((size - HEADER_SIZE) / SIZEOF_STL_FACET);
+	stl->stats.original_num_facets = stl->stats.number_of_facets;
+	memcpy(stl->stats.header, data, LABEL_SIZE);
+	stl->stats.header[LABEL_SIZE] = '\0';
+	uint32_t header_num_facets;
+	memcpy(&header_num_facets, data + LABEL_SIZE, sizeof(uint32_t));
+#if BOOST_ENDIAN_BIG_BYTE
+	stl_internal_reverse_quads((char*)&header_num_facets, 4);
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+	if (stl->stats.number_of_facets != header_num_facets)
+		BOOST_LOG_TRIVIAL(info) << "stl_open_binary: Warning: Data size doesn't match number of facets in the header";
+
+	stl_allocate(stl);
+	bool first = true;
+	for (uint32_t i = 0; i < stl->stats.number_of_facets; ++ i) {
+		stl_facet &facet = stl->facet_start[i];
+		memcpy(&facet, data + HEADER_SIZE + size_t(i) * SIZEOF_STL_FACET, SIZEOF_STL_FACET);
+#if BOOST_ENDIAN_BIG_BYTE
+		stl_internal_reverse_quads((char*)&facet, 48);
+#endif /* BOOST_ENDIAN_BIG_BYTE */
+		stl_facet_stats(stl, facet, first);
+	}
+	stl->stats.size = stl->stats.max - stl->stats.min;
+	stl->stats.bounding_diameter = stl->stats.size.norm();
+	return true;
+}
+
 void stl_allocate(stl_file *stl) 
 {
   	//  Allocate memory for the entire .STL file.
@@ -77,6 +77,9 @@ void AppConfig::set_defaults()
         if (get("export_sources_full_pathnames").empty())
             set("export_sources_full_pathnames", "0");
 
+        if (get("mesh_cache").empty())
+            set("mesh_cache", "0");
+
 #ifdef _WIN32
         if (get("associate_3mf").empty())
             set("associate_3mf", "0");
@@ -0,0 +1,185 @@
+#include "BandedMesh.hpp"
+#include "Exception.hpp"
+#include "TriangleMesh.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+namespace Slic3r {
+
+// Bump the version whenever the layout of the file or the transformation of the vertices changes.
+static constexpr const uint32_t BANDED_MESH_VERSION  = 1;
+static constexpr const char     BANDED_MESH_MAGIC[8] = { 'P', 'S', 'B', 'M', 'E', 'S', 'H', 0 };
+
+static_assert(sizeof(BandedFacet) == 3 * sizeof(stl_vertex) + 2 * sizeof(Vec3i), "BandedFacet is stored into a file as a raw structure");
+
+// Header of a banded mesh file. The header is followed by the table of bands, then by the facets sorted by their minimum Z.
+struct BandedMeshHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t sizeof_facet;
+    uint64_t num_bands;
+    uint64_t num_facets;
+};
+
+bool BandedMesh::create(const indexed_triangle_set &its, const Transform3d &trafo, const std::string &path, size_t facets_per_band, std::function<void()> throw_on_cancel)
+{
+    assert(facets_per_band > 0);
+
+    // Transform the vertices the same way as slice_mesh() does: scale up in XY, not in Z.
+    static constexpr const double s = 1. / SCALING_FACTOR;
+    Transform3d t = trafo;
+    t.prescale(Vec3d(s, s, 1.));
+    const Transform3f tf = t.cast<float>();
+
+    std::vector<Vec3i> face_edge_ids = its_face_edge_ids(its, throw_on_cancel);
+    throw_on_cancel();
+
+    // Sort the facets by their minimum Z.
+    std::vector<std::pair<float, uint32_t>> order(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, order.size()), [&its, &tf, &order](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const stl_triangle_vertex_indices &face = its.indices[i];
+            order[i] = { std::min((tf * its.vertices[face(0)]).z(), std::min((tf * its.vertices[face(1)]).z(), (tf * its.vertices[face(2)]).z())), uint32_t(i) };
+        }
+    });
+    tbb::parallel_sort(order.begin(), order.end());
+    throw_on_cancel();
+
+    BandedMeshHeader header;
+    ::memcpy(header.magic, BANDED_MESH_MAGIC, sizeof(BANDED_MESH_MAGIC));
+    header.version      = BANDED_MESH_VERSION;
+    header.sizeof_facet = sizeof(BandedFacet);
+    header.num_bands    = (order.size() + facets_per_band - 1) / facets_per_band;
+    header.num_facets   = order.size();
+    std::vector<BandInfo> bands(header.num_bands);
+    for (size_t i = 0; i < bands.size(); ++ i) {
+        BandInfo &band   = bands[i];
+        band.first_facet = i * facets_per_band;
+        band.num_facets  = std::min(facets_per_band, order.size() - band.first_facet);
+        band.min_z       = order[band.first_facet].first;
+        band.max_z       = band.min_z;
+    }
+
+    FILE *fp = boost::nowide::fopen(path.c_str(), "wb");
+    if (fp == nullptr) {
+        BOOST_LOG_TRIVIAL(error) << "BandedMesh: Couldn't create " << path;
+        return false;
+    }
+    // The table of bands is written again once the maximum Zs of the bands are known.
+    bool ok = ::fwrite(&header, sizeof(BandedMeshHeader), 1, fp) == 1 &&
+              ::fwrite(bands.data(), sizeof(BandInfo), bands.size(), fp) == bands.size();
+    // Transform the facets in blocks in parallel, write them sequentially.
+    static constexpr const size_t block_size = 65536;
+    std::vector<BandedFacet> block;
+    try {
+        for (size_t block_begin = 0; ok && block_begin < order.size(); block_begin += block_size) {
+            throw_on_cancel();
+            block.resize(std::min(block_size, order.size() - block_begin));
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, block.size()), [&its, &tf, &face_edge_ids, &order, &block, block_begin](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    const uint32_t  face_idx = order[block_begin + i].second;
+                    BandedFacet    &facet    = block[i];
+                    facet.indices  = its.indices[face_idx];
+                    facet.edge_ids = face_edge_ids[face_idx];
+                    for (int j = 0; j < 3; ++ j)
+                        facet.vertices[j] = tf * its.vertices[facet.indices(j)];
+                }
+            });
+            for (size_t i = 0; i < block.size(); ++ i) {
+                BandInfo &band = bands[(block_begin + i) / facets_per_band];
+                for (const stl_vertex &v : block[i].vertices)
+                    band.max_z = std::max(band.max_z, v.z());
+            }
+            ok = ::fwrite(block.data(), sizeof(BandedFacet), block.size(), fp) == block.size();
+        }
+    } catch (...) {
+        ::fclose(fp);
+        boost::filesystem::remove(path);
+        throw;
+    }
+    ok = ok && ::fseek(fp, long(sizeof(BandedMeshHeader)), SEEK_SET) == 0 &&
+         ::fwrite(bands.data(), sizeof(BandInfo), bands.size(), fp) == bands.size();
+    ok = ::fclose(fp) == 0 && ok;
+    if (! ok) {
+        BOOST_LOG_TRIVIAL(error) << "BandedMesh: Failed to write " << path;
+        boost::system::error_code ec;
+        boost::filesystem::remove(path, ec);
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(debug) << "BandedMesh: Stored " << order.size() << " facets in " << bands.size() << " bands into " << path;
+    return true;
+}
+
+bool BandedMesh::open(const std::string &path)
+{
+    *this = BandedMesh();
+
+    FILE *fp = boost::nowide::fopen(path.c_str(), "rb");
+    if (fp == nullptr) {
+        BOOST_LOG_TRIVIAL(error) << "BandedMesh: Couldn't open " << path;
+        return false;
+    }
+    BandedMeshHeader      header;
+    std::vector<BandInfo> bands;
+    bool ok = ::fread(&header, sizeof(BandedMeshHeader), 1, fp) == 1 &&
+        ::memcmp(header.magic, BANDED_MESH_MAGIC, sizeof(BANDED_MESH_MAGIC)) == 0 && header.version == BANDED_MESH_VERSION &&
+        header.sizeof_facet == sizeof(BandedFacet) && header.num_bands <= header.num_facets;
+    if (ok) {
+        bands.assign(header.num_bands, BandInfo());
+        ok = ::fread(bands.data(), sizeof(BandInfo), bands.size(), fp) == bands.size();
+    }
+    ::fclose(fp);
+
+    // Validate the table of bands against the size of the file. The bands shall cover all the facets in their order.
+    uint64_t data_offset = sizeof(BandedMeshHeader) + header.num_bands * sizeof(BandInfo);
+    if (ok) {
+        boost::system::error_code ec;
+        ok = boost::filesystem::file_size(path, ec) == data_offset + header.num_facets * sizeof(BandedFacet) && ! ec;
+    }
+    uint64_t next_facet = 0;
+    for (size_t i = 0; ok && i < bands.size(); ++ i) {
+        const BandInfo &band = bands[i];
+        ok = band.first_facet == next_facet && band.num_facets > 0 && band.min_z <= band.max_z && (i == 0 || bands[i - 1].min_z <= band.min_z);
+        next_facet += band.num_facets;
+    }
+    if (! ok || next_facet != header.num_facets) {
+        BOOST_LOG_TRIVIAL(error) << "BandedMesh: Invalid file " << path;
+        return false;
+    }
+
+    m_path        = path;
+    m_bands       = std::move(bands);
+    m_num_facets  = header.num_facets;
+    m_data_offset = data_offset;
+    return true;
+}
+
+BandedMesh::Band BandedMesh::map_band(size_t idx) const
+{
+    const BandInfo &info   = m_bands[idx];
+    uint64_t        offset = m_data_offset + info.first_facet * sizeof(BandedFacet);
+    // Mapping has to start at a multiple of the allocation granularity.
+    uint64_t        delta  = offset % boost::iostreams::mapped_file_source::alignment();
+    Band            band;
+    try {
+        band.m_mapped.open(m_path, size_t(delta + info.num_facets * sizeof(BandedFacet)), boost::iostreams::stream_offset(offset - delta));
+    } catch (const std::exception &ex) {
+        throw Slic3r::RuntimeError(std::string("BandedMesh: Couldn't map ") + m_path + ": " + ex.what());
+    }
+    band.m_begin = reinterpret_cast<const BandedFacet*>(band.m_mapped.data() + delta);
+    band.m_size  = size_t(info.num_facets);
+    return band;
+}
+
+} // namespace Slic3r
@@ -0,0 +1,84 @@
+#ifndef slic3r_BandedMesh_hpp_
+#define slic3r_BandedMesh_hpp_
+
+#include "libslic3r.h"
+#include "Point.hpp"
+
+#include <admesh/stl.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace Slic3r {
+
+// Triangle of a BandedMesh, self-contained to be sliced without the rest of the mesh.
+struct BandedFacet
+{
+    // Vertices transformed for slicing: scaled in XY, not scaled in Z.
+    stl_vertex                  vertices[3];
+    // Indices of the vertices and of the edges in the source mesh, for chaining the slices into loops.
+    stl_triangle_vertex_indices indices;
+    Vec3i                       edge_ids;
+};
+
+// Out-of-core storage of a mesh for slicing of models, which are too big to be kept in memory together with their slices.
+// Triangles are sorted by their minimum Z and grouped into Z bands of a limited number of triangles, the bands are
+// stored into a file and mapped into memory one by one, see slice_mesh(const BandedMesh&, ...).
+class BandedMesh
+{
+public:
+    struct BandInfo {
+        // Z span of the triangles of this band, unscaled.
+        float       min_z;
+        float       max_z;
+        uint64_t    first_facet;
+        uint64_t    num_facets;
+    };
+
+    // Triangles of a single band mapped into memory. The facets are valid as long as the Band exists.
+    class Band {
+    public:
+        const BandedFacet*  begin() const { return m_begin; }
+        const BandedFacet*  end()   const { return m_begin + m_size; }
+        size_t              size()  const { return m_size; }
+        const BandedFacet&  operator[](size_t idx) const { return m_begin[idx]; }
+
+    private:
+        boost::iostreams::mapped_file_source    m_mapped;
+        const BandedFacet                      *m_begin { nullptr };
+        size_t                                  m_size  { 0 };
+        friend class BandedMesh;
+    };
+
+    BandedMesh() = default;
+
+    // Transform the mesh by trafo, sort its triangles into bands of at most facets_per_band triangles and write them into a file.
+    // The whole source mesh has to be in memory, the banded mesh may then be sliced by a process with much less memory available.
+    // Returns false if the file could not be written.
+    static bool create(const indexed_triangle_set &its, const Transform3d &trafo, const std::string &path,
+                       size_t facets_per_band = 1 << 20, std::function<void()> throw_on_cancel = []{});
+
+    // Read the table of bands of a file written by create(). Returns false if the file is not a valid banded mesh.
+    bool                    open(const std::string &path);
+    bool                    empty() const { return m_bands.empty(); }
+    const std::string&      path() const { return m_path; }
+    size_t                  num_facets() const { return m_num_facets; }
+    size_t                  num_bands() const { return m_bands.size(); }
+    const BandInfo&         band_info(size_t idx) const { return m_bands[idx]; }
+    // Map triangles of a band into memory. Throws Slic3r::RuntimeError if the file could not be mapped.
+    Band                    map_band(size_t idx) const;
+
+private:
+    std::string             m_path;
+    std::vector<BandInfo>   m_bands;
+    uint64_t                m_num_facets  { 0 };
+    // Offset of the first facet in the file.
+    uint64_t                m_data_offset { 0 };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_BandedMesh_hpp_
@@ -36,6 +36,10 @@ namespace pt = boost::property_tree;
 
 #include <fast_float/fast_float.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
 // https://github.com/boostorg/spirit/pull/586
 // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
@@ -469,7 +473,9 @@ namespace Slic3r {
         }
 
         bool _load_model_from_file(const std::string& filename, Model& model, DynamicPrintConfig& config, ConfigSubstitutionContext& config_substitutions);
+        bool _create_model_xml_parser();
         bool _extract_model_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
+        bool _extract_model_from_buffer(const std::string& buffer, const mz_zip_archive_file_stat& stat);
         void _extract_layer_heights_profile_config_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
         void _extract_layer_config_ranges_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, ConfigSubstitutionContext& config_substitutions);
         void _extract_sla_support_points_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
@@ -546,7 +552,11 @@ namespace Slic3r {
         bool _handle_start_config_metadata(const char** attributes, unsigned int num_attributes);
         bool _handle_end_config_metadata();
 
+        // Splits the triangle meshes of the given volumes out of the object geometry.
+        // Does not modify the importer, thus it may run for multiple objects in parallel.
+        bool _build_volume_meshes(const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>& meshes, std::string& error) const;
         bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions);
+        bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>&& meshes, ConfigSubstitutionContext& config_substitutions);
 
         // callbacks to parse the .model file
         static void XMLCALL _handle_start_model_xml_element(void* userData, const char* name, const char** attributes);
@@ -636,29 +646,76 @@ namespace Slic3r {
 
         m_name = boost::filesystem::path(filename).stem().string();
 
-        // we first loop the entries to read from the archive the .model file only, in order to extract the version from it
+        // we first loop the entries to read from the archive the .model files only, in order to extract the version from them
+        std::vector<mz_zip_archive_file_stat> model_entries;
         for (mz_uint i = 0; i < num_entries; ++i) {
             if (mz_zip_reader_file_stat(&archive, i, &stat)) {
                 std::string name(stat.m_filename);
                 std::replace(name.begin(), name.end(), '\\', '/');
 
-                if (boost::algorithm::istarts_with(name, MODEL_FOLDER) && boost::algorithm::iends_with(name, MODEL_EXTENSION)) {
-                    try
-                    {
-                        // valid model name -> extract model
-                        if (!_extract_model_from_archive(archive, stat)) {
-                            close_zip_reader(&archive);
-                            add_error("Archive does not contain a valid model");
-                            return false;
+                if (boost::algorithm::istarts_with(name, MODEL_FOLDER) && boost::algorithm::iends_with(name, MODEL_EXTENSION))
+                    model_entries.emplace_back(stat);
+            }
+        }
+
+        // Multiple .model files are decompressed in parallel, each with its own zip reader, as a zip reader
+        // may not be shared between threads. The decompressed files are then parsed in the archive order,
+        // as the parser builds the model. To bound the peak memory, only as many .model files are held
+        // decompressed at the same time as there are worker threads. A single .model file is parsed while
+        // being decompressed.
+        const bool               inflate_in_parallel = model_entries.size() > 1;
+        const size_t             max_inflated        = std::max(1, tbb::this_task_arena::max_concurrency());
+        std::vector<std::string> model_buffers;
+        for (size_t batch_begin = 0; batch_begin < model_entries.size(); batch_begin += max_inflated) {
+            const size_t batch_end = std::min(model_entries.size(), batch_begin + max_inflated);
+            if (inflate_in_parallel) {
+                model_buffers.assign(batch_end - batch_begin, std::string());
+                std::vector<char> extracted(model_buffers.size(), 0);
+                tbb::parallel_for(tbb::blocked_range<size_t>(batch_begin, batch_end, 1),
+                    [&filename, &model_entries, &model_buffers, &extracted, batch_begin](const tbb::blocked_range<size_t>& range) {
+                        mz_zip_archive entry_archive;
+                        mz_zip_zero_struct(&entry_archive);
+                        if (!open_zip_reader(&entry_archive, filename))
+                            return;
+                        for (size_t i = range.begin(); i < range.end(); ++ i) {
+                            const mz_zip_archive_file_stat& entry = model_entries[i];
+                            std::string& buffer = model_buffers[i - batch_begin];
+                            buffer.assign((size_t)entry.m_uncomp_size, 0);
+                            extracted[i - batch_begin] = buffer.empty() ||
+                                mz_zip_reader_extract_to_mem(&entry_archive, entry.m_file_index, (void*)buffer.data(), buffer.size(), 0);
                         }
-                    }
-                    catch (const std::exception& e)
-                    {
-                        // ensure the zip archive is closed and rethrow the exception
+                        close_zip_reader(&entry_archive);
+                    });
+
+                if (std::find(extracted.begin(), extracted.end(), 0) != extracted.end()) {
+                    close_zip_reader(&archive);
+                    add_error("Error while extracting model data from zip archive");
+                    return false;
+                }
+            }
+
+            for (size_t i = batch_begin; i < batch_end; ++ i) {
+                try
+                {
+                    // valid model name -> extract model
+                    bool valid = inflate_in_parallel ?
+                        _extract_model_from_buffer(model_buffers[i - batch_begin], model_entries[i]) :
+                        _extract_model_from_archive(archive, model_entries[i]);
+                    if (!valid) {
                         close_zip_reader(&archive);
-                        throw Slic3r::FileIOError(e.what());
+                        add_error("Archive does not contain a valid model");
+                        return false;
                     }
                 }
+                catch (const std::exception& e)
+                {
+                    // ensure the zip archive is closed and rethrow the exception
+                    close_zip_reader(&archive);
+                    throw Slic3r::FileIOError(e.what());
+                }
+                // release the decompressed data as soon as it has been parsed
+                if (inflate_in_parallel)
+                    std::string().swap(model_buffers[i - batch_begin]);
             }
         }
 
@@ -750,6 +807,21 @@ namespace Slic3r {
             }
         }
 
+        // The volumes of all the objects are generated at the end, so that the triangle meshes
+        // of the objects may be split out of their geometries in parallel.
+        struct ObjectVolumes
+        {
+            ModelObject*                              model_object { nullptr };
+            const Geometry*                           geometry { nullptr };
+            const ObjectMetadata::VolumeMetadataList* volumes { nullptr };
+            // Used if the object has no volumes metadata.
+            ObjectMetadata::VolumeMetadataList        whole_geometry;
+            std::vector<TriangleMesh>                 meshes;
+            std::string                               error;
+        };
+        std::vector<ObjectVolumes> objects_volumes;
+        objects_volumes.reserve(m_objects.size());
+
         for (const IdToModelObjectMap::value_type& object : m_objects) {
             if (object.second >= int(m_model->objects.size())) {
                 add_error("Unable to find object");
@@ -784,8 +856,9 @@ namespace Slic3r {
                 model_object->sla_drain_holes = std::move(obj_drain_holes->second);
             }
 
-            ObjectMetadata::VolumeMetadataList volumes;
-            ObjectMetadata::VolumeMetadataList* volumes_ptr = nullptr;
+            ObjectVolumes& object_volumes = objects_volumes.emplace_back();
+            object_volumes.model_object = model_object;
+            object_volumes.geometry     = &obj_geometry->second;
 
             IdToMetadataMap::iterator obj_metadata = m_objects_metadata.find(object.first);
             if (obj_metadata != m_objects_metadata.end()) {
@@ -800,19 +873,33 @@ namespace Slic3r {
                 }
 
                 // select object's detected volumes
-                volumes_ptr = &obj_metadata->second.volumes;
+                object_volumes.volumes = &obj_metadata->second.volumes;
             }
             else {
                 // config data not found, this model was not saved using slic3r pe
 
                 // add the entire geometry as the single volume to generate
-                volumes.emplace_back(0, (int)obj_geometry->second.triangles.size() - 1);
+                object_volumes.whole_geometry.emplace_back(0, (int)obj_geometry->second.triangles.size() - 1);
 
                 // select as volumes
-                volumes_ptr = &volumes;
+                object_volumes.volumes = &object_volumes.whole_geometry;
             }
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_volumes.size()),
+            [this, &objects_volumes](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i) {
+                    ObjectVolumes& ov = objects_volumes[i];
+                    _build_volume_meshes(*ov.geometry, *ov.volumes, ov.meshes, ov.error);
+                }
+            });
 
-            if (!_generate_volumes(*model_object, obj_geometry->second, *volumes_ptr, config_substitutions))
+        for (ObjectVolumes& ov : objects_volumes) {
+            if (!ov.error.empty()) {
+                add_error(ov.error);
+                return false;
+            }
+            if (!_generate_volumes(*ov.model_object, *ov.geometry, *ov.volumes, std::move(ov.meshes), config_substitutions))
                 return false;
         }
 
@@ -838,13 +925,8 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Importer::_extract_model_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat)
+    bool _3MF_Importer::_create_model_xml_parser()
     {
-        if (stat.m_uncomp_size == 0) {
-            add_error("Found invalid size");
-            return false;
-        }
-
         _destroy_xml_parser();
 
         m_xml_parser = XML_ParserCreate(nullptr);
@@ -857,6 +939,57 @@ namespace Slic3r {
         XML_SetElementHandler(m_xml_parser, _3MF_Importer::_handle_start_model_xml_element, _3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _3MF_Importer::_handle_model_xml_characters);
 
+        return true;
+    }
+
+    bool _3MF_Importer::_extract_model_from_buffer(const std::string& buffer, const mz_zip_archive_file_stat& stat)
+    {
+        if (buffer.empty()) {
+            add_error("Found invalid size");
+            return false;
+        }
+
+        if (!_create_model_xml_parser())
+            return false;
+
+        try
+        {
+            // XML_Parse() takes the length as int, thus the buffer is fed in chunks.
+            static constexpr const size_t max_chunk_size = 64 * 1024 * 1024;
+            for (size_t offset = 0; offset < buffer.size(); offset += max_chunk_size) {
+                const size_t chunk_size = std::min(max_chunk_size, buffer.size() - offset);
+                const int    is_final   = (offset + chunk_size == buffer.size()) ? 1 : 0;
+                if (!XML_Parse(m_xml_parser, buffer.data() + offset, (int)chunk_size, is_final) || parse_error()) {
+                    char error_buf[1024];
+                    ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", parse_error_message(), stat.m_filename, (int)XML_GetCurrentLineNumber(m_xml_parser));
+                    throw Slic3r::FileIOError(error_buf);
+                }
+            }
+        }
+        catch (const version_error& e)
+        {
+            // rethrow the exception
+            throw Slic3r::FileIOError(e.what());
+        }
+        catch (std::exception& e)
+        {
+            add_error(e.what());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool _3MF_Importer::_extract_model_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat)
+    {
+        if (stat.m_uncomp_size == 0) {
+            add_error("Found invalid size");
+            return false;
+        }
+
+        if (!_create_model_xml_parser())
+            return false;
+
         struct CallbackData
         {
             XML_Parser& parser;
@@ -1933,39 +2066,25 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    bool _3MF_Importer::_build_volume_meshes(const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>& meshes, std::string& error) const
     {
-        if (!object.volumes.empty()) {
-            add_error("Found invalid volumes count");
-            return false;
-        }
-
         unsigned int geo_tri_count = (unsigned int)geometry.triangles.size();
-        unsigned int renamed_volumes_count = 0;
+
+        meshes.clear();
+        meshes.reserve(volumes.size());
 
         for (const ObjectMetadata::VolumeMetadata& volume_data : volumes) {
             if (geo_tri_count <= volume_data.first_triangle_id || geo_tri_count <= volume_data.last_triangle_id || volume_data.last_triangle_id < volume_data.first_triangle_id) {
-                add_error("Found invalid triangle id");
+                error = "Found invalid triangle id";
                 return false;
             }
 
-            Transform3d volume_matrix_to_object = Transform3d::Identity();
-            bool        has_transform 		    = false;
-            // extract the volume transformation from the volume's metadata, if present
-            for (const Metadata& metadata : volume_data.metadata) {
-                if (metadata.key == MATRIX_KEY) {
-                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
-                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
-                    break;
-                }
-            }
-
             // splits volume out of imported geometry
             indexed_triangle_set its;
             its.indices.assign(geometry.triangles.begin() + volume_data.first_triangle_id, geometry.triangles.begin() + volume_data.last_triangle_id + 1);
             const size_t triangles_count = its.indices.size();
             if (triangles_count == 0) {
-                add_error("An empty triangle mesh found");
+                error = "An empty triangle mesh found";
                 return false;
             }
 
@@ -1975,7 +2094,7 @@ namespace Slic3r {
                 for (const Vec3i& face : its.indices) {
                     for (const int tri_id : face) {
                         if (tri_id < 0 || tri_id >= int(geometry.vertices.size())) {
-                            add_error("Found invalid vertex id");
+                            error = "Found invalid vertex id";
                             return false;
                         }
                         min_id = std::min(min_id, tri_id);
@@ -1997,7 +2116,50 @@ namespace Slic3r {
                 // Remove the vertices, that are not referenced by any face.
                 its_compactify_vertices(its, true);
 
-            TriangleMesh triangle_mesh(std::move(its), volume_data.mesh_stats);
+            meshes.emplace_back(std::move(its), volume_data.mesh_stats);
+        }
+
+        return true;
+    }
+
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    {
+        std::vector<TriangleMesh> meshes;
+        std::string               error;
+        if (!_build_volume_meshes(geometry, volumes, meshes, error)) {
+            add_error(error);
+            return false;
+        }
+
+        return _generate_volumes(object, geometry, volumes, std::move(meshes), config_substitutions);
+    }
+
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>&& meshes, ConfigSubstitutionContext& config_substitutions)
+    {
+        if (!object.volumes.empty()) {
+            add_error("Found invalid volumes count");
+            return false;
+        }
+
+        assert(meshes.size() == volumes.size());
+
+        unsigned int renamed_volumes_count = 0;
+
+        for (size_t volume_idx = 0; volume_idx < volumes.size(); ++volume_idx) {
+            const ObjectMetadata::VolumeMetadata& volume_data = volumes[volume_idx];
+            TriangleMesh& triangle_mesh = meshes[volume_idx];
+            const size_t triangles_count = triangle_mesh.its.indices.size();
+
+            Transform3d volume_matrix_to_object = Transform3d::Identity();
+            bool        has_transform 		    = false;
+            // extract the volume transformation from the volume's metadata, if present
+            for (const Metadata& metadata : volume_data.metadata) {
+                if (metadata.key == MATRIX_KEY) {
+                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
+                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
+                    break;
+                }
+            }
 
             if (m_version == 0) {
                 // if the 3mf was not produced by PrusaSlicer and there is only one instance,
@@ -2170,8 +2332,8 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_object_to_model_stream(MZ_ParallelDeflate &model_stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_object_stream(MZ_ParallelDeflate &model_stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_config_ranges_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2378,19 +2540,15 @@ namespace Slic3r {
 
     bool _3MF_Exporter::_add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data)
     {
-        mz_zip_writer_staged_context context;
-        if (!mz_zip_writer_add_staged_open(&archive, &context, MODEL_FILE.c_str(), 
-            m_zip64 ? 
-                // Maximum expected and allowed 3MF file size is 16GiB.
-                // This switches the ZIP file to a 64bit mode, which adds a tiny bit of overhead to file records.
-                (uint64_t(1) << 30) * 16 : 
-                // Maximum expected 3MF file size is 4GB-1. This is a workaround for interoperability with Windows 10 3D model fixing API, see
-                // GH issue #6193.
-                (uint64_t(1) << 32) - 1,
-            nullptr, nullptr, 0, MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0)) {
-            add_error("Unable to add model file to archive");
-            return false;
-        }
+        // The model file is compressed in blocks on worker threads while being generated.
+        MZ_ParallelDeflate model_stream(MZ_DEFAULT_LEVEL);
+        const mz_uint64 max_model_file_size = m_zip64 ?
+            // Maximum expected and allowed 3MF file size is 16GiB.
+            // This switches the ZIP file to a 64bit mode, which adds a tiny bit of overhead to file records.
+            (uint64_t(1) << 30) * 16 :
+            // Maximum expected 3MF file size is 4GB-1. This is a workaround for interoperability with Windows 10 3D model fixing API, see
+            // GH issue #6193.
+            (uint64_t(1) << 32) - 1;
 
         {
             std::stringstream stream;
@@ -2423,7 +2581,7 @@ namespace Slic3r {
             stream << " <" << METADATA_TAG << " name=\"Application\">" << SLIC3R_APP_KEY << "-" << SLIC3R_VERSION << "</" << METADATA_TAG << ">\n";
             stream << " <" << RESOURCES_TAG << ">\n";
             std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
+            if (! buf.empty() && ! model_stream.append(buf.data(), buf.size())) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
@@ -2446,9 +2604,8 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_stream(model_stream, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
                 add_error("Unable to add object to archive");
-                mz_zip_writer_add_staged_finish(&context);
                 return false;
             }
         }
@@ -2461,7 +2618,6 @@ namespace Slic3r {
             // Store the transformations of all the ModelInstances of all ModelObjects, indexed in a linear fashion.
             if (!_add_build_to_model_stream(stream, build_items)) {
                 add_error("Unable to add build to archive");
-                mz_zip_writer_add_staged_finish(&context);
                 return false;
             }
 
@@ -2469,8 +2625,9 @@ namespace Slic3r {
            
             std::string buf = stream.str();
 
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                ! mz_zip_writer_add_staged_finish(&context)) {
+            if ((! buf.empty() && ! model_stream.append(buf.data(), buf.size())) ||
+                model_stream.size() > max_model_file_size ||
+                ! model_stream.add_to_archive(archive, MODEL_FILE, max_model_file_size)) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
@@ -2479,7 +2636,7 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(MZ_ParallelDeflate &model_stream, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -2495,8 +2652,8 @@ namespace Slic3r {
             if (id == 0) {
                 std::string buf = stream.str();
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                if ((! buf.empty() && ! model_stream.append(buf.data(), buf.size())) ||
+                    ! _add_mesh_to_object_stream(model_stream, object, volumes_offsets)) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
@@ -2519,7 +2676,7 @@ namespace Slic3r {
 
         object_id += id;
         std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
+        return buf.empty() || model_stream.append(buf.data(), buf.size());
     }
 
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
@@ -2542,7 +2699,7 @@ namespace Slic3r {
     using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
 #endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_mesh_to_object_stream(MZ_ParallelDeflate &model_stream, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
     {
         std::string output_buffer;
         output_buffer += "   <";
@@ -2551,9 +2708,9 @@ namespace Slic3r {
         output_buffer += VERTICES_TAG;
         output_buffer += ">\n";
 
-        auto flush = [this, &output_buffer, &context](bool force = false) {
+        auto flush = [this, &output_buffer, &model_stream](bool force = false) {
             if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
+                if (! model_stream.append(output_buffer.data(), output_buffer.size())) {
                     add_error("Error during writing or compression");
                     return false;
                 }
@@ -2592,7 +2749,35 @@ namespace Slic3r {
 #endif
         };
 
-        char buf[256];
+        // Vertices and triangles are formatted on worker threads in chunks, which are then appended to the model
+        // stream in order. A batch of chunks is formatted at a time to limit the memory held by the formatted text.
+        auto format_parallel = [&output_buffer, &flush](size_t count, auto &&format) {
+            static constexpr size_t chunk_size = 4096;
+            static constexpr size_t batch_size = chunk_size * 256;
+            std::vector<std::string> chunks;
+            for (size_t batch_begin = 0; batch_begin < count; batch_begin += batch_size) {
+                size_t batch_end = std::min(count, batch_begin + batch_size);
+                chunks.assign((batch_end - batch_begin + chunk_size - 1) / chunk_size, std::string());
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()),
+                    [batch_begin, batch_end, &chunks, &format](const tbb::blocked_range<size_t>& range) {
+                        // The numeric locale is set per thread.
+                        CNumericLocalesSetter locales_setter;
+                        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+                            size_t begin = batch_begin + chunk_idx * chunk_size;
+                            size_t end   = std::min(batch_end, begin + chunk_size);
+                            for (size_t i = begin; i < end; ++ i)
+                                format(i, chunks[chunk_idx]);
+                        }
+                    });
+                for (const std::string& chunk : chunks) {
+                    output_buffer += chunk;
+                    if (! flush())
+                        return false;
+                }
+            }
+            return true;
+        };
+
         unsigned int vertices_count = 0;
         for (ModelVolume* volume : object.volumes) {
             if (volume == nullptr)
@@ -2610,7 +2795,8 @@ namespace Slic3r {
 
             const Transform3d& matrix = volume->get_matrix();
 
-            for (size_t i = 0; i < its.vertices.size(); ++i) {
+            bool formatted = format_parallel(its.vertices.size(), [&its, &matrix, &format_coordinate](size_t i, std::string& out) {
+                char buf[256];
                 Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
                 char *ptr = buf;
                 boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
@@ -2620,11 +2806,10 @@ namespace Slic3r {
                 boost::spirit::karma::generate(ptr, "\" z=\"");
                 ptr = format_coordinate(v.z(), ptr);
                 boost::spirit::karma::generate(ptr, "\"/>\n");
-                *ptr = '\0';
-                output_buffer += buf;
-                if (! flush())
-                    return false;
-            }
+                out.append(buf, ptr);
+            });
+            if (! formatted)
+                return false;
         }
 
         output_buffer += "    </";
@@ -2649,53 +2834,54 @@ namespace Slic3r {
             triangles_count += (int)its.indices.size();
             volume_it->second.last_triangle_id = triangles_count - 1;
 
-            for (int i = 0; i < int(its.indices.size()); ++ i) {
+            const int first_vertex_id = volume_it->second.first_vertex_id;
+            bool formatted = format_parallel(its.indices.size(), [&its, volume, is_left_handed, first_vertex_id](size_t tri_idx, std::string& out) {
+                const int i = int(tri_idx);
                 {
                     const Vec3i &idx = its.indices[i];
+                    char buf[256];
                     char *ptr = buf;
                     boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << TRIANGLE_TAG <<
                         " v1=\"" << boost::spirit::int_ <<
                         "\" v2=\"" << boost::spirit::int_ <<
                         "\" v3=\"" << boost::spirit::int_ << "\"",
-                        idx[is_left_handed ? 2 : 0] + volume_it->second.first_vertex_id,
-                        idx[1] + volume_it->second.first_vertex_id,
-                        idx[is_left_handed ? 0 : 2] + volume_it->second.first_vertex_id);
-                    *ptr = '\0';
-                    output_buffer += buf;
+                        idx[is_left_handed ? 2 : 0] + first_vertex_id,
+                        idx[1] + first_vertex_id,
+                        idx[is_left_handed ? 0 : 2] + first_vertex_id);
+                    out.append(buf, ptr);
                 }
 
                 std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
                 if (! custom_supports_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SUPPORTS_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_supports_data_string;
-                    output_buffer += "\"";
+                    out += " ";
+                    out += CUSTOM_SUPPORTS_ATTR;
+                    out += "=\"";
+                    out += custom_supports_data_string;
+                    out += "\"";
                 }
 
                 std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
                 if (! custom_seam_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SEAM_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_seam_data_string;
-                    output_buffer += "\"";
+                    out += " ";
+                    out += CUSTOM_SEAM_ATTR;
+                    out += "=\"";
+                    out += custom_seam_data_string;
+                    out += "\"";
                 }
 
                 std::string mmu_painting_data_string = volume->mmu_segmentation_facets.get_triangle_as_string(i);
                 if (! mmu_painting_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += MMU_SEGMENTATION_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += mmu_painting_data_string;
-                    output_buffer += "\"";
+                    out += " ";
+                    out += MMU_SEGMENTATION_ATTR;
+                    out += "=\"";
+                    out += mmu_painting_data_string;
+                    out += "\"";
                 }
 
-                output_buffer += "/>\n";
-
-                if (! flush())
-                    return false;
-            }
+                out += "/>\n";
+            });
+            if (! formatted)
+                return false;
         }
 
         output_buffer += "    </";
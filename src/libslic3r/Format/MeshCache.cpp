@@ -0,0 +1,297 @@
+#include "../libslic3r.h"
+#include "../Model.hpp"
+#include "../TriangleMesh.hpp"
+#include "../Utils.hpp"
+
+#include "MeshCache.hpp"
+#include "OBJ.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <string>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/format.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include "miniz_extension.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#ifdef _WIN32
+#define DIR_SEPARATOR '\\'
+#else
+#define DIR_SEPARATOR '/'
+#endif
+
+namespace Slic3r {
+
+namespace fs = boost::filesystem;
+
+// Bump the version whenever the layout of the cache file or the import of STL / OBJ changes.
+static constexpr const uint32_t MESH_CACHE_VERSION  = 1;
+static constexpr const char     MESH_CACHE_MAGIC[8] = { 'P', 'S', 'M', 'E', 'S', 'H', 'C', 0 };
+// Once the cache grows over this size, the least recently used entries are removed.
+static constexpr const uint64_t MESH_CACHE_MAX_SIZE = uint64_t(4) << 30;
+
+// Identification of the source file contents.
+struct MeshCacheKey
+{
+    uint64_t source_size { 0 };
+    uint64_t source_hash { 0 };
+};
+
+// Header of a cache file. The header is followed by the raw TriangleMeshStats of the mesh and of the convex hull,
+// then by the vertices and indices of the mesh and of the convex hull.
+struct MeshCacheHeader
+{
+    char     magic[8];
+    uint32_t version;
+    // The statistics are stored as raw structures, like with the Undo / Redo serialization.
+    uint32_t sizeof_stats;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint64_t num_vertices;
+    uint64_t num_indices;
+    uint64_t hull_num_vertices;
+    uint64_t hull_num_indices;
+
+    uint64_t file_size() const {
+        return sizeof(MeshCacheHeader) + 2 * uint64_t(sizeof_stats) +
+            (num_vertices + hull_num_vertices) * sizeof(stl_vertex) + (num_indices + hull_num_indices) * sizeof(stl_triangle_vertex_indices);
+    }
+};
+
+static fs::path mesh_cache_dir()
+{
+    return data_dir().empty() ? fs::path() : fs::path(data_dir()) / "cache" / "meshes";
+}
+
+static fs::path mesh_cache_path(const MeshCacheKey &key)
+{
+    return mesh_cache_dir() / (boost::format("%016x-%016x.mesh") % key.source_size % key.source_hash).str();
+}
+
+// Hash the source file in blocks of 4MB in parallel, then combine the CRCs of the blocks.
+static bool mesh_cache_key(const char *source_path, MeshCacheKey &key)
+{
+    if (mesh_cache_dir().empty())
+        return false;
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        key.source_size = fs::file_size(fs::path(source_path));
+        if (key.source_size == 0)
+            return false;
+        mapped.open(fs::path(source_path));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Couldn't map " << source_path << ": " << ex.what();
+        return false;
+    }
+    static constexpr const size_t block_size = 4 * 1024 * 1024;
+    std::vector<mz_ulong> crcs((mapped.size() + block_size - 1) / block_size, MZ_CRC32_INIT);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, crcs.size(), 1), [&mapped, &crcs](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            size_t begin = i * block_size;
+            crcs[i] = mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const mz_uint8*>(mapped.data() + begin), std::min(block_size, mapped.size() - begin));
+        }
+    });
+    // 64bit FNV-1a over the block CRCs.
+    key.source_hash = 0xcbf29ce484222325ULL;
+    for (mz_ulong crc : crcs)
+        key.source_hash = (key.source_hash ^ uint64_t(crc)) * 0x100000001b3ULL;
+    return true;
+}
+
+static bool mesh_cache_load(const MeshCacheKey &key, TriangleMesh &mesh, TriangleMesh &convex_hull)
+{
+    const fs::path path = mesh_cache_path(key);
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        if (! fs::exists(path))
+            return false;
+        mapped.open(path);
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Couldn't map " << path.string() << ": " << ex.what();
+        return false;
+    }
+
+    // Validate the header against the source file and the size of the cache file.
+    MeshCacheHeader header;
+    if (mapped.size() < sizeof(MeshCacheHeader))
+        return false;
+    ::memcpy(&header, mapped.data(), sizeof(MeshCacheHeader));
+    if (::memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 || header.version != MESH_CACHE_VERSION ||
+        header.sizeof_stats != sizeof(TriangleMeshStats) || header.source_size != key.source_size || header.source_hash != key.source_hash ||
+        header.num_vertices > uint64_t(std::numeric_limits<int>::max()) || header.hull_num_vertices > uint64_t(std::numeric_limits<int>::max()) ||
+        header.num_indices > mapped.size() || header.hull_num_indices > mapped.size() || header.file_size() != mapped.size()) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Invalid cache file " << path.string();
+        return false;
+    }
+
+    const char *data = mapped.data() + sizeof(MeshCacheHeader);
+    auto read_stats = [&data](TriangleMeshStats &stats) {
+        ::memcpy(reinterpret_cast<char*>(&stats), data, sizeof(TriangleMeshStats));
+        data += sizeof(TriangleMeshStats);
+    };
+    auto read_its = [&data](indexed_triangle_set &its, uint64_t num_vertices, uint64_t num_indices) {
+        its.vertices.resize(num_vertices);
+        its.indices.resize(num_indices);
+        ::memcpy(reinterpret_cast<char*>(its.vertices.data()), data, num_vertices * sizeof(stl_vertex));
+        data += num_vertices * sizeof(stl_vertex);
+        ::memcpy(reinterpret_cast<char*>(its.indices.data()), data, num_indices * sizeof(stl_triangle_vertex_indices));
+        data += num_indices * sizeof(stl_triangle_vertex_indices);
+        std::atomic<bool> valid { true };
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size(), 65536), [&its, &valid](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                if (its.indices[i].minCoeff() < 0 || its.indices[i].maxCoeff() >= int(its.vertices.size()))
+                    valid = false;
+        });
+        return bool(valid);
+    };
+    TriangleMeshStats    stats, hull_stats;
+    indexed_triangle_set its, hull_its;
+    read_stats(stats);
+    read_stats(hull_stats);
+    if (! read_its(its, header.num_vertices, header.num_indices) || ! read_its(hull_its, header.hull_num_vertices, header.hull_num_indices) ||
+        stats.number_of_facets != its.indices.size() || hull_stats.number_of_facets != hull_its.indices.size() || its.indices.empty()) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Invalid cache file " << path.string();
+        return false;
+    }
+    mesh        = TriangleMesh(std::move(its), stats);
+    convex_hull = TriangleMesh(std::move(hull_its), hull_stats);
+
+    // Mark the cache entry as recently used.
+    mapped.close();
+    try {
+        fs::last_write_time(path, std::time(nullptr));
+    } catch (const std::exception &) {
+    }
+    return true;
+}
+
+// Remove the least recently used cache entries until the cache fits MESH_CACHE_MAX_SIZE.
+static void mesh_cache_prune()
+{
+    try {
+        std::vector<std::pair<std::time_t, fs::path>> entries;
+        uint64_t                                      total_size = 0;
+        for (const fs::directory_entry &entry : fs::directory_iterator(mesh_cache_dir()))
+            if (fs::is_regular_file(entry.status()) && entry.path().extension() == ".mesh") {
+                total_size += fs::file_size(entry.path());
+                entries.emplace_back(fs::last_write_time(entry.path()), entry.path());
+            }
+        if (total_size <= MESH_CACHE_MAX_SIZE)
+            return;
+        std::sort(entries.begin(), entries.end());
+        for (const auto &entry : entries) {
+            total_size -= fs::file_size(entry.second);
+            fs::remove(entry.second);
+            if (total_size <= MESH_CACHE_MAX_SIZE)
+                break;
+        }
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Failed to prune the cache: " << ex.what();
+    }
+}
+
+static bool mesh_cache_store(const MeshCacheKey &key, const TriangleMesh &mesh, const TriangleMesh &convex_hull)
+{
+    MeshCacheHeader header;
+    ::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+    header.version           = MESH_CACHE_VERSION;
+    header.sizeof_stats      = sizeof(TriangleMeshStats);
+    header.source_size       = key.source_size;
+    header.source_hash       = key.source_hash;
+    header.num_vertices      = mesh.its.vertices.size();
+    header.num_indices       = mesh.its.indices.size();
+    header.hull_num_vertices = convex_hull.its.vertices.size();
+    header.hull_num_indices  = convex_hull.its.indices.size();
+
+    // Write into a temporary file first, so that a concurrently running instance never maps a partially written file.
+    const fs::path path     = mesh_cache_path(key);
+    const fs::path path_tmp = path.string() + ".tmp";
+    try {
+        fs::create_directories(path.parent_path());
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Couldn't create the cache directory " << path.parent_path().string() << ": " << ex.what();
+        return false;
+    }
+    FILE *fp = boost::nowide::fopen(path_tmp.string().c_str(), "wb");
+    if (fp == nullptr) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Couldn't create " << path_tmp.string();
+        return false;
+    }
+    bool ok =
+        ::fwrite(&header, sizeof(MeshCacheHeader), 1, fp) == 1 &&
+        ::fwrite(&mesh.stats(), sizeof(TriangleMeshStats), 1, fp) == 1 &&
+        ::fwrite(&convex_hull.stats(), sizeof(TriangleMeshStats), 1, fp) == 1 &&
+        ::fwrite(mesh.its.vertices.data(), sizeof(stl_vertex), mesh.its.vertices.size(), fp) == mesh.its.vertices.size() &&
+        ::fwrite(mesh.its.indices.data(), sizeof(stl_triangle_vertex_indices), mesh.its.indices.size(), fp) == mesh.its.indices.size() &&
+        ::fwrite(convex_hull.its.vertices.data(), sizeof(stl_vertex), convex_hull.its.vertices.size(), fp) == convex_hull.its.vertices.size() &&
+        ::fwrite(convex_hull.its.indices.data(), sizeof(stl_triangle_vertex_indices), convex_hull.its.indices.size(), fp) == convex_hull.its.indices.size();
+    ok = ::fclose(fp) == 0 && ok;
+    try {
+        if (ok)
+            fs::rename(path_tmp, path);
+        else
+            fs::remove(path_tmp);
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Couldn't store " << path.string() << ": " << ex.what();
+        ok = false;
+    }
+    if (! ok) {
+        BOOST_LOG_TRIVIAL(error) << "Mesh cache: Failed to write " << path.string();
+        return false;
+    }
+    mesh_cache_prune();
+    return true;
+}
+
+bool mesh_cache_load(const char *source_path, TriangleMesh &mesh, TriangleMesh &convex_hull)
+{
+    MeshCacheKey key;
+    return mesh_cache_key(source_path, key) && mesh_cache_load(key, mesh, convex_hull);
+}
+
+bool mesh_cache_store(const char *source_path, const TriangleMesh &mesh, const TriangleMesh &convex_hull)
+{
+    MeshCacheKey key;
+    return mesh_cache_key(source_path, key) && mesh_cache_store(key, mesh, convex_hull);
+}
+
+bool load_mesh_cached(const char *path, Model *model, const char *object_name_in)
+{
+    TriangleMesh mesh;
+    TriangleMesh convex_hull;
+    MeshCacheKey key;
+    const bool   has_key = mesh_cache_key(path, key);
+    if (has_key && mesh_cache_load(key, mesh, convex_hull))
+        BOOST_LOG_TRIVIAL(info) << "Mesh cache: Loaded " << path << " from the cache";
+    else {
+        bool loaded = boost::algorithm::iends_with(path, ".obj") ? load_obj(path, &mesh) : mesh.ReadSTLFile(path);
+        if (! loaded || mesh.empty())
+            return false;
+        convex_hull = mesh.convex_hull_3d();
+        if (has_key)
+            mesh_cache_store(key, mesh, convex_hull);
+    }
+
+    std::string object_name;
+    if (object_name_in == nullptr) {
+        const char *last_slash = strrchr(path, DIR_SEPARATOR);
+        object_name.assign((last_slash == nullptr) ? path : last_slash + 1);
+    } else
+       object_name.assign(object_name_in);
+
+    model->add_object(object_name.c_str(), path, std::move(mesh), std::move(convex_hull));
+    return true;
+}
+
+}; // namespace Slic3r
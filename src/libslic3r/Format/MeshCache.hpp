@@ -0,0 +1,25 @@
+#ifndef slic3r_Format_MeshCache_hpp_
+#define slic3r_Format_MeshCache_hpp_
+
+namespace Slic3r {
+
+class TriangleMesh;
+class Model;
+
+// Binary cache of meshes imported from STL and OBJ files.
+// The imported and repaired mesh is stored together with its statistics and its convex hull into data_dir()/cache/meshes,
+// keyed by the size and a hash of the source file contents. Reopening a known file then maps the cache file
+// instead of parsing, repairing and calculating the convex hull again.
+// The cache is disabled if data_dir() is not set.
+
+// Load an STL or OBJ file into a provided model through the mesh cache. Store the mesh into the cache on a cache miss.
+extern bool load_mesh_cached(const char *path, Model *model, const char *object_name = nullptr);
+
+// Load a mesh of a source file from the cache. Returns false if there is no valid cache entry for the source file.
+extern bool mesh_cache_load(const char *source_path, TriangleMesh &mesh, TriangleMesh &convex_hull);
+// Store a mesh of a source file into the cache. Returns false if the cache entry could not be written.
+extern bool mesh_cache_store(const char *source_path, const TriangleMesh &mesh, const TriangleMesh &convex_hull);
+
+}; // namespace Slic3r
+
+#endif /* slic3r_Format_MeshCache_hpp_ */
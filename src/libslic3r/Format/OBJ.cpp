@@ -3,12 +3,20 @@
 #include "../TriangleMesh.hpp"
 
 #include "OBJ.hpp"
-#include "objparser.hpp"
 
+#include <atomic>
+#include <charconv>
 #include <string>
 
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <fast_float/fast_float.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 #ifdef _WIN32
 #define DIR_SEPARATOR '\\'
 #else
@@ -17,76 +25,184 @@
 
 namespace Slic3r {
 
+// Part of an OBJ file, parsed by a single thread.
+struct ObjChunk
+{
+    const char                              *begin { nullptr };
+    const char                              *end   { nullptr };
+    // Vertices defined inside this chunk.
+    std::vector<stl_vertex>                  vertices;
+    // Triangles defined inside this chunk, quads are split into two triangles.
+    std::vector<stl_triangle_vertex_indices> indices;
+    // Positions into the flattened indices, which were specified relative to the current vertex in the file
+    // (negative indices). These are relative to the start of this chunk, to be shifted by the vertices of the preceding chunks.
+    std::vector<size_t>                      relative;
+    // Vertices preceding this chunk.
+    size_t                                   vertices_offset { 0 };
+    size_t                                   indices_offset  { 0 };
+    std::string                              error;
+};
+
+static inline const char* obj_skip_whitespaces(const char *c, const char *end)
+{
+    while (c != end && (*c == ' ' || *c == '\t'))
+        ++ c;
+    return c;
+}
+
+static inline bool obj_whitespace_or_end(const char *c, const char *end)
+{
+    return c == end || *c == ' ' || *c == '\t';
+}
+
+// Parse "x y z [w]" of a vertex geometry line, w is ignored.
+static bool obj_parse_vertex(const char *c, const char *end, stl_vertex &out)
+{
+    for (int i = 0; i < 3; ++ i) {
+        c = obj_skip_whitespaces(c, end);
+        if (c != end && *c == '+')
+            ++ c;
+        auto [pend, ec] = fast_float::from_chars(c, end, out(i));
+        if (ec != std::errc() || ! obj_whitespace_or_end(pend, end))
+            return false;
+        c = pend;
+    }
+    return true;
+}
+
+// Parse the vertex and face lines of a chunk, all other lines are ignored.
+// Like ObjParser::objparse(), lines ending with either CR or LF are accepted and malformed vertices or faces are skipped.
+static void obj_parse_chunk(ObjChunk &chunk)
+{
+    int  face[4];
+    bool face_relative[4];
+    for (const char *line = chunk.begin; line != chunk.end;) {
+        const char *line_end = line;
+        while (line_end != chunk.end && *line_end != '\n' && *line_end != '\r')
+            ++ line_end;
+        const char *c = obj_skip_whitespaces(line, line_end);
+        if (c != line_end && *c == 'v' && c + 1 != line_end && (c[1] == ' ' || c[1] == '\t')) {
+            // v - vertex geometry
+            stl_vertex vertex;
+            if (obj_parse_vertex(c + 2, line_end, vertex))
+                chunk.vertices.emplace_back(vertex);
+        } else if (c != line_end && *c == 'f') {
+            // f - face, only the vertex indices are used, texture and normal indices are skipped.
+            int  cnt   = 0;
+            bool valid = true;
+            for (c = obj_skip_whitespaces(c + 1, line_end); c != line_end; c = obj_skip_whitespaces(c, line_end)) {
+                if (cnt == 4) {
+                    // Non-triangular and non-quad faces are not supported as of now.
+                    chunk.error = "The file contains polygons with more than 4 vertices.";
+                    return;
+                }
+                if (*c == '+')
+                    ++ c;
+                int idx = 0;
+                auto [pend, ec] = std::from_chars(c, line_end, idx);
+                if (ec != std::errc() || ! (obj_whitespace_or_end(pend, line_end) || *pend == '/')) {
+                    valid = false;
+                    break;
+                }
+                face_relative[cnt] = idx < 0;
+                face[cnt ++]       = idx < 0 ? idx + int(chunk.vertices.size()) : idx - 1;
+                for (c = pend; ! obj_whitespace_or_end(c, line_end); ++ c) ;
+            }
+            if (valid && cnt > 0) {
+                if (cnt < 3) {
+                    chunk.error = "The file contains polygons with less than 3 vertices.";
+                    return;
+                }
+                // Insert one or two faces (triangulate a quad).
+                auto emit = [&chunk, &face, &face_relative](int i, int j, int k) {
+                    const int corners[3] = { i, j, k };
+                    for (int l = 0; l < 3; ++ l)
+                        if (face_relative[corners[l]])
+                            chunk.relative.emplace_back(chunk.indices.size() * 3 + l);
+                    chunk.indices.emplace_back(face[i], face[j], face[k]);
+                };
+                emit(0, 1, 2);
+                if (cnt == 4)
+                    emit(0, 2, 3);
+            }
+        }
+        line = line_end == chunk.end ? line_end : line_end + 1;
+    }
+}
+
 bool load_obj(const char *path, TriangleMesh *meshptr)
 {
     if (meshptr == nullptr)
         return false;
-    
-    // Parse the OBJ file.
-    ObjParser::ObjData data;
-    if (! ObjParser::objparse(path, data)) {
-        BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path;
+
+    // Map the OBJ file. An empty file cannot be mapped, it is reported as an empty mesh below.
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        if (boost::filesystem::file_size(boost::filesystem::path(path)) > 0)
+            mapped.open(boost::filesystem::path(path));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". " << ex.what();
         return false;
     }
-    
-    // Count the faces and verify, that all faces are triangular.
-    size_t num_faces = 0;
-    size_t num_quads = 0;
-    for (size_t i = 0; i < data.vertices.size(); ++ i) {
-        // Find the end of face.
-        size_t j = i;
-        for (; j < data.vertices.size() && data.vertices[j].coordIdx != -1; ++ j) ;
-        if (size_t num_face_vertices = j - i; num_face_vertices > 0) {
-            if (num_face_vertices > 4) {
-                // Non-triangular and non-quad faces are not supported as of now.
-                BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains polygons with more than 4 vertices.";
-                return false;
-            } else if (num_face_vertices < 3) {
-                // Non-triangular and non-quad faces are not supported as of now.
-                BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains polygons with less than 2 vertices.";
-                return false;
-            }
-            if (num_face_vertices == 4)
-                ++ num_quads;
-            ++ num_faces;
-            i = j;
+
+    // Split the file into chunks on line boundaries.
+    static constexpr const size_t chunk_size = 4 * 1024 * 1024;
+    std::vector<ObjChunk> chunks;
+    const char *data_end = mapped.is_open() ? mapped.data() + mapped.size() : nullptr;
+    for (const char *begin = mapped.is_open() ? mapped.data() : nullptr; begin != data_end;) {
+        const char *end = begin + std::min(chunk_size, size_t(data_end - begin));
+        while (end != data_end && *end != '\n' && *end != '\r')
+            ++ end;
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end   = end;
+        begin = end;
+    }
+
+    // Parse the chunks in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size(), 1), [&chunks](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            obj_parse_chunk(chunks[i]);
+    });
+    size_t num_vertices = 0;
+    size_t num_faces    = 0;
+    for (ObjChunk &chunk : chunks) {
+        if (! chunk.error.empty()) {
+            BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". " << chunk.error;
+            return false;
         }
+        chunk.vertices_offset = num_vertices;
+        chunk.indices_offset  = num_faces;
+        num_vertices += chunk.vertices.size();
+        num_faces    += chunk.indices.size();
     }
-    
-    // Convert ObjData into indexed triangle set.
-    indexed_triangle_set its;
-    size_t num_vertices = data.coordinates.size() / 4;
-    its.vertices.reserve(num_vertices);
-    its.indices.reserve(num_faces + num_quads);
-    for (size_t i = 0; i < num_vertices; ++ i) {
-        size_t j = i << 2;
-        its.vertices.emplace_back(data.coordinates[j], data.coordinates[j + 1], data.coordinates[j + 2]);
+    if (num_vertices > size_t(std::numeric_limits<int>::max())) {
+        BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains too many vertices.";
+        return false;
     }
-    int indices[4];
-    for (size_t i = 0; i < data.vertices.size();)
-        if (data.vertices[i].coordIdx == -1)
-            ++ i;
-        else {
-            int cnt = 0;
-            while (i < data.vertices.size())
-                if (const ObjParser::ObjVertex &vertex = data.vertices[i ++]; vertex.coordIdx == -1) {
-                    break;
-                } else {
-                    assert(cnt < 4);
-                    if (vertex.coordIdx < 0 || vertex.coordIdx >= int(its.vertices.size())) {
-                        BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains invalid vertex index.";
-                        return false;
-                    }
-                    indices[cnt ++] = vertex.coordIdx;
-                }
-            if (cnt) {
-                assert(cnt == 3 || cnt == 4);
-                // Insert one or two faces (triangulate a quad).
-                its.indices.emplace_back(indices[0], indices[1], indices[2]);
-                if (cnt == 4)
-                    its.indices.emplace_back(indices[0], indices[2], indices[3]);
-            }
+
+    // Concatenate the chunks into an indexed triangle set, shift the relative indices by the vertices of the preceding chunks.
+    indexed_triangle_set its;
+    its.vertices.resize(num_vertices);
+    its.indices.resize(num_faces);
+    std::atomic<bool> indices_valid { true };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size(), 1), [&chunks, &its, &indices_valid, num_vertices](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            ObjChunk &chunk = chunks[i];
+            for (size_t idx : chunk.relative)
+                chunk.indices[idx / 3](idx % 3) += int(chunk.vertices_offset);
+            for (const stl_triangle_vertex_indices &face : chunk.indices)
+                if (face.minCoeff() < 0 || face.maxCoeff() >= int(num_vertices))
+                    indices_valid = false;
+            std::copy(chunk.vertices.begin(), chunk.vertices.end(), its.vertices.begin() + chunk.vertices_offset);
+            std::copy(chunk.indices.begin(), chunk.indices.end(), its.indices.begin() + chunk.indices_offset);
+            chunk = ObjChunk();
         }
+    });
+    if (! indices_valid) {
+        BOOST_LOG_TRIVIAL(error) << "load_obj: failed to parse " << path << ". The file contains invalid vertex index.";
+        return false;
+    }
 
     *meshptr = TriangleMesh(std::move(its));
     if (meshptr->empty()) {
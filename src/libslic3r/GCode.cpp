@@ -36,6 +36,7 @@
 
 #include <tbb/parallel_for.h>
 #include <tbb/pipeline.h>
+#include <tbb/task_arena.h>
 
 #include <Shiny/Shiny.h>
 
@@ -182,8 +183,8 @@ namespace Slic3r {
                     double dE = length * (segment_length / wipe_dist) * 0.95;
                     //FIXME one shall not generate the unnecessary G1 Fxxx commands, here wipe_speed is a constant inside this cycle.
                     // Is it here for the cooling markers? Or should it be outside of the cycle?
-                    gcode += gcodegen.writer().set_speed(wipe_speed * 60, "", gcodegen.enable_cooling_markers() ? ";_WIPE" : "");
-                    gcode += gcodegen.writer().extrude_to_xy(
+                    gcodegen.writer().set_speed(gcode, wipe_speed * 60, "", gcodegen.enable_cooling_markers() ? ";_WIPE" : "");
+                    gcodegen.writer().extrude_to_xy(gcode,
                         gcodegen.point_to_gcode(line.b),
                         -dE,
                         "wipe and retract"
@@ -1358,7 +1359,7 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
             this->process_layers(print, tool_ordering, collect_layers_to_print(object), *print_object_instance_sequential_active - object.instances().data(), file);
 #ifdef HAS_PRESSURE_EQUALIZER
             if (m_pressure_equalizer)
-                file.write(m_pressure_equalizer->process("", true));
+                file.write(m_pressure_equalizer->process_layer(std::string(), true));
 #endif /* HAS_PRESSURE_EQUALIZER */
             ++ finished_objects;
             // Flag indicating whether the nozzle temperature changes from 1st to 2nd layer were performed.
@@ -1418,7 +1419,7 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
         this->process_layers(print, tool_ordering, print_object_instances_ordering, layers_to_print, file);
 #ifdef HAS_PRESSURE_EQUALIZER
         if (m_pressure_equalizer)
-            file.write(m_pressure_equalizer->process("", true));
+            file.write(m_pressure_equalizer->process_layer(std::string(), true));
 #endif /* HAS_PRESSURE_EQUALIZER */
         if (m_wipe_tower)
             // Purge the extruder, pull out the active filament.
@@ -1488,6 +1489,37 @@ void GCode::_do_export(Print& print, GCodeOutputStream &file, ThumbnailsGenerato
     print.throw_if_canceled();
 }
 
+// Number of layers, for which the avoid crossing perimeters boundaries and the seam placement data are precomputed
+// in parallel ahead of the serial G-code generator. Limits the memory held by the precomputed data.
+static size_t precompute_layers_batch_size()
+{
+    return std::max<size_t>(16, 4 * size_t(tbb::this_task_arena::max_concurrency()));
+}
+
+static void append_layers_to_precompute(const GCode::LayerToPrint &layer_to_print, std::vector<const Layer*> &out)
+{
+    // Both are precomputed, as the motion planner plans travels over both the object and the support layer.
+    if (layer_to_print.object_layer != nullptr)
+        out.emplace_back(layer_to_print.object_layer);
+    if (layer_to_print.support_layer != nullptr)
+        out.emplace_back(layer_to_print.support_layer);
+}
+
+// Precompute the data of a batch of layers in parallel, so that the serial G-code generator only queries them.
+void GCode::precompute_layers(const Print &print, const std::vector<const Layer*> &layers)
+{
+    if (m_config.avoid_crossing_perimeters)
+        m_avoid_crossing_perimeters.init_layers(layers);
+    if (! m_config.spiral_vase)
+        m_seam_placer.precompute_layers(print, layers);
+}
+
+void GCode::clear_precomputed_layers()
+{
+    m_avoid_crossing_perimeters.clear_layers();
+    m_seam_placer.clear_precomputed();
+}
+
 // Process all layers of all objects (non-sequential mode) with a parallel pipeline:
 // Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
 // and export G-code into file.
@@ -1500,12 +1532,22 @@ void GCode::process_layers(
 {
     // The pipeline is variable: The vase mode filter is optional.
     size_t layer_to_print_idx = 0;
+    // Layers up to this index are precomputed.
+    size_t precomputed_end = 0;
     const auto generator = tbb::make_filter<void, GCode::LayerResult>(tbb::filter::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> GCode::LayerResult {
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx, &precomputed_end](tbb::flow_control& fc) -> GCode::LayerResult {
             if (layer_to_print_idx == layers_to_print.size()) {
                 fc.stop();
                 return {};
             } else {
+                if (layer_to_print_idx == precomputed_end) {
+                    precomputed_end = std::min(layers_to_print.size(), layer_to_print_idx + precompute_layers_batch_size());
+                    std::vector<const Layer*> layers;
+                    for (size_t idx = layer_to_print_idx; idx < precomputed_end; ++ idx)
+                        for (const LayerToPrint &layer_to_print : layers_to_print[idx].second)
+                            append_layers_to_precompute(layer_to_print, layers);
+                    this->precompute_layers(print, layers);
+                }
                 const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
                 const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
                 if (m_wipe_tower && layer_tools.has_wipe_tower)
@@ -1517,21 +1559,34 @@ void GCode::process_layers(
     const auto spiral_vase = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(tbb::filter::serial_in_order,
         [&spiral_vase = *this->m_spiral_vase.get()](GCode::LayerResult in) -> GCode::LayerResult {
             spiral_vase.enable(in.spiral_vase_enable);
-            return { spiral_vase.process_layer(std::move(in.gcode)), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
+            // The spiral vase modifies the G-code, thus the extrusion blocks would not match the G-code anymore.
+            return { spiral_vase.process_layer(std::move(in.gcode)), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush,
+                     in.spiral_vase_enable ? CoolingBuffer::ExtrusionBlocks() : std::move(in.cooling_blocks) };
         });
     const auto cooling = tbb::make_filter<GCode::LayerResult, std::string>(tbb::filter::serial_in_order,
         [&cooling_buffer = *this->m_cooling_buffer.get()](GCode::LayerResult in) -> std::string {
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+            return cooling_buffer.process_layer(std::move(in.gcode), std::move(in.cooling_blocks), in.layer_id, in.cooling_buffer_flush);
         });
     const auto output = tbb::make_filter<std::string, void>(tbb::filter::serial_in_order,
         [&output_stream](std::string s) { output_stream.write(s); }
     );
+#ifdef HAS_PRESSURE_EQUALIZER
+    // The pressure equalizer keeps the last lines of a layer in its circular buffer, the buffer is flushed after the pipeline finishes.
+    const auto pressure_equalizer = tbb::make_filter<std::string, std::string>(tbb::filter::serial_in_order,
+        [pressure_equalizer = this->m_pressure_equalizer.get()](std::string s) -> std::string {
+            return pressure_equalizer ? pressure_equalizer->process_layer(std::move(s), false) : std::move(s);
+        });
+    const auto output_filters = pressure_equalizer & output;
+#else /* HAS_PRESSURE_EQUALIZER */
+    const auto &output_filters = output;
+#endif /* HAS_PRESSURE_EQUALIZER */
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase)
-        tbb::parallel_pipeline(12, generator & spiral_vase & cooling & output);
+        tbb::parallel_pipeline(12, generator & spiral_vase & cooling & output_filters);
     else
-        tbb::parallel_pipeline(12, generator & cooling & output);
+        tbb::parallel_pipeline(12, generator & cooling & output_filters);
+    this->clear_precomputed_layers();
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
@@ -1546,12 +1601,21 @@ void GCode::process_layers(
 {
     // The pipeline is variable: The vase mode filter is optional.
     size_t layer_to_print_idx = 0;
+    // Layers up to this index are precomputed.
+    size_t precomputed_end = 0;
     const auto generator = tbb::make_filter<void, GCode::LayerResult>(tbb::filter::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx](tbb::flow_control& fc) -> GCode::LayerResult {
+        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, &precomputed_end, single_object_idx](tbb::flow_control& fc) -> GCode::LayerResult {
             if (layer_to_print_idx == layers_to_print.size()) {
                 fc.stop();
                 return {};
             } else {
+                if (layer_to_print_idx == precomputed_end) {
+                    precomputed_end = std::min(layers_to_print.size(), layer_to_print_idx + precompute_layers_batch_size());
+                    std::vector<const Layer*> layers;
+                    for (size_t idx = layer_to_print_idx; idx < precomputed_end; ++ idx)
+                        append_layers_to_precompute(layers_to_print[idx], layers);
+                    this->precompute_layers(print, layers);
+                }
                 LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
                 print.throw_if_canceled();
                 return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, single_object_idx);
@@ -1560,21 +1624,34 @@ void GCode::process_layers(
     const auto spiral_vase = tbb::make_filter<GCode::LayerResult, GCode::LayerResult>(tbb::filter::serial_in_order,
         [&spiral_vase = *this->m_spiral_vase.get()](GCode::LayerResult in)->GCode::LayerResult {
             spiral_vase.enable(in.spiral_vase_enable);
-            return { spiral_vase.process_layer(std::move(in.gcode)), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
+            // The spiral vase modifies the G-code, thus the extrusion blocks would not match the G-code anymore.
+            return { spiral_vase.process_layer(std::move(in.gcode)), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush,
+                     in.spiral_vase_enable ? CoolingBuffer::ExtrusionBlocks() : std::move(in.cooling_blocks) };
         });
     const auto cooling = tbb::make_filter<GCode::LayerResult, std::string>(tbb::filter::serial_in_order,
         [&cooling_buffer = *this->m_cooling_buffer.get()](GCode::LayerResult in)->std::string {
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+            return cooling_buffer.process_layer(std::move(in.gcode), std::move(in.cooling_blocks), in.layer_id, in.cooling_buffer_flush);
         });
     const auto output = tbb::make_filter<std::string, void>(tbb::filter::serial_in_order,
         [&output_stream](std::string s) { output_stream.write(s); }
     );
+#ifdef HAS_PRESSURE_EQUALIZER
+    // The pressure equalizer keeps the last lines of a layer in its circular buffer, the buffer is flushed after the pipeline finishes.
+    const auto pressure_equalizer = tbb::make_filter<std::string, std::string>(tbb::filter::serial_in_order,
+        [pressure_equalizer = this->m_pressure_equalizer.get()](std::string s) -> std::string {
+            return pressure_equalizer ? pressure_equalizer->process_layer(std::move(s), false) : std::move(s);
+        });
+    const auto output_filters = pressure_equalizer & output;
+#else /* HAS_PRESSURE_EQUALIZER */
+    const auto &output_filters = output;
+#endif /* HAS_PRESSURE_EQUALIZER */
 
     // The pipeline elements are joined using const references, thus no copying is performed.
     if (m_spiral_vase)
-        tbb::parallel_pipeline(12, generator & spiral_vase & cooling & output);
+        tbb::parallel_pipeline(12, generator & spiral_vase & cooling & output_filters);
     else
-        tbb::parallel_pipeline(12, generator & cooling & output);
+        tbb::parallel_pipeline(12, generator & cooling & output_filters);
+    this->clear_precomputed_layers();
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override)
@@ -2045,7 +2122,11 @@ GCode::LayerResult GCode::process_layer(
         m_enable_loop_clipping = !enable;
     }
 
+    // G-code of the whole layer is appended into a single buffer. Preallocate it to the size of the previous layer,
+    // so that the buffer is not reallocated repeatedly while the layer is being exported.
     std::string gcode;
+    gcode.reserve(m_last_layer_gcode_size + m_last_layer_gcode_size / 8);
+    m_cooling_blocks.clear();
     assert(is_decimal_separator_point()); // for the sprintfs
 
     // add tag for processor
@@ -2274,7 +2355,7 @@ GCode::LayerResult GCode::process_layer(
     } // for objects
 
     // Extrude the skirt, brim, support, perimeters, infill ordered by the extruders.
-    std::vector<std::unique_ptr<EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
+    std::vector<std::shared_ptr<const EdgeGrid::Grid>> lower_layer_edge_grids(layers.size());
     for (unsigned int extruder_id : layer_tools.extruders)
     {
         gcode += (layer_tools.has_wipe_tower && m_wipe_tower) ?
@@ -2299,7 +2380,7 @@ GCode::LayerResult GCode::process_layer(
                     path.mm3_per_mm = mm3_per_mm;
                 }
                 //FIXME using the support_material_speed of the 1st object printed.
-                gcode += this->extrude_loop(loop, "skirt", m_config.support_material_speed.value);
+                this->extrude_loop(gcode, loop, "skirt", m_config.support_material_speed.value);
             }
             m_avoid_crossing_perimeters.use_external_mp(false);
             // Allow a straight travel move to the first object point if this is the first layer (but don't in next layers).
@@ -2312,7 +2393,7 @@ GCode::LayerResult GCode::process_layer(
             this->set_origin(0., 0.);
             m_avoid_crossing_perimeters.use_external_mp();
             for (const ExtrusionEntity *ee : print.brim().entities) {
-                gcode += this->extrude_entity(*ee, "brim", m_config.support_material_speed.value);
+                this->extrude_entity(gcode, *ee, "brim", m_config.support_material_speed.value);
             }
             m_brim_done = true;
             m_avoid_crossing_perimeters.use_external_mp(false);
@@ -2355,7 +2436,7 @@ GCode::LayerResult GCode::process_layer(
                 if (instance_to_print.object_by_extruder.support != nullptr && !print_wipe_extrusions) {
                     m_layer = layer_to_print.support_layer;
                     m_object_layer_over_raft = false;
-                    gcode += this->extrude_support(
+                    this->extrude_support(gcode,
                         // support_extrusion_role is erSupportMaterial, erSupportMaterialInterface or erMixed for all extrusion paths.
                         instance_to_print.object_by_extruder.support->chained_path_from(m_last_pos, instance_to_print.object_by_extruder.support_extrusion_role));
                     m_layer = layer_to_print.layer();
@@ -2367,14 +2448,14 @@ GCode::LayerResult GCode::process_layer(
                     const auto& by_region_specific = is_anything_overridden ? island.by_region_per_copy(by_region_per_copy_cache, static_cast<unsigned int>(instance_to_print.instance_id), extruder_id, print_wipe_extrusions != 0) : island.by_region;
                     //FIXME the following code prints regions in the order they are defined, the path is not optimized in any way.
                     if (print.config().infill_first) {
-                        gcode += this->extrude_infill(print, by_region_specific, false);
-                        gcode += this->extrude_perimeters(print, by_region_specific, lower_layer_edge_grids[instance_to_print.layer_id]);
+                        this->extrude_infill(gcode, print, by_region_specific, false);
+                        this->extrude_perimeters(gcode, print, by_region_specific, lower_layer_edge_grids[instance_to_print.layer_id]);
                     } else {
-                        gcode += this->extrude_perimeters(print, by_region_specific, lower_layer_edge_grids[instance_to_print.layer_id]);
-                        gcode += this->extrude_infill(print,by_region_specific, false);
+                        this->extrude_perimeters(gcode, print, by_region_specific, lower_layer_edge_grids[instance_to_print.layer_id]);
+                        this->extrude_infill(gcode, print,by_region_specific, false);
                     }
                     // ironing
-                    gcode += this->extrude_infill(print,by_region_specific, true);
+                    this->extrude_infill(gcode, print,by_region_specific, true);
                 }
                 if (this->config().gcode_label_objects)
                     gcode += std::string("; stop printing object ") + instance_to_print.print_object.model_object()->name + " id:" + std::to_string(instance_to_print.layer_id) + " copy " + std::to_string(instance_to_print.instance_id) + "\n";
@@ -2397,21 +2478,15 @@ GCode::LayerResult GCode::process_layer(
             // Flush the cooling buffer at each object layer or possibly at the last layer, even if it contains just supports (This should not happen).
             object_layer || last_layer);
 
-#ifdef HAS_PRESSURE_EQUALIZER
-    // Apply pressure equalization if enabled;
-    // printf("G-code before filter:\n%s\n", gcode.c_str());
-    if (m_pressure_equalizer)
-        gcode = m_pressure_equalizer->process(gcode.c_str(), false);
-    // printf("G-code after filter:\n%s\n", out.c_str());
-#endif /* HAS_PRESSURE_EQUALIZER */
-
     file.write(gcode);
 #endif
 
     BOOST_LOG_TRIVIAL(trace) << "Exported layer " << layer.id() << " print_z " << print_z <<
     log_memory_info();
 
+    m_last_layer_gcode_size = gcode.size();
     result.gcode = std::move(gcode);
+    result.cooling_blocks = std::move(m_cooling_blocks);
     result.cooling_buffer_flush = object_layer || raft_layer || last_layer;
     return result;
 }
@@ -2491,13 +2566,9 @@ std::string GCode::change_layer(coordf_t print_z)
         gcode += m_writer.update_progress(++ m_layer_index, m_layer_count);
     coordf_t z = print_z + m_config.z_offset.value;  // in unscaled coordinates
     if (EXTRUDER_CONFIG(retract_layer_change) && m_writer.will_move_z(z))
-        gcode += this->retract();
+        this->retract(gcode);
 
-    {
-        std::ostringstream comment;
-        comment << "move to next layer (" << m_layer_index << ")";
-        gcode += m_writer.travel_to_z(z, comment.str());
-    }
+    m_writer.travel_to_z(gcode, z, "move to next layer (" + std::to_string(m_layer_index) + ")");
 
     // forget last wiping path as wiping after raising Z is pointless
     m_wipe.reset_path();
@@ -2507,36 +2578,13 @@ std::string GCode::change_layer(coordf_t print_z)
 
 
 
-static std::unique_ptr<EdgeGrid::Grid> calculate_layer_edge_grid(const Layer& layer)
-{
-    auto out = make_unique<EdgeGrid::Grid>();
-
-    // Create the distance field for a layer below.
-    const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
-    out->create(layer.lslices, distance_field_resolution);
-    out->calculate_sdf();
-#if 0
-        {
-            static int iRun = 0;
-            BoundingBox bbox = (*lower_layer_edge_grid)->bbox();
-            bbox.min(0) -= scale_(5.f);
-            bbox.min(1) -= scale_(5.f);
-            bbox.max(0) += scale_(5.f);
-            bbox.max(1) += scale_(5.f);
-            EdgeGrid::save_png(*(*lower_layer_edge_grid), bbox, scale_(0.1f), debug_out_path("GCode_extrude_loop_edge_grid-%d.png", iRun++));
-        }
-#endif
-    return out;
-}
-
-
-std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, double speed, std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid)
+void GCode::extrude_loop(std::string &gcode, ExtrusionLoop loop, std::string description, double speed, std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid)
 {
     // get a copy; don't modify the orientation of the original loop object otherwise
     // next copies (if any) would not detect the correct orientation
 
     if (m_layer->lower_layer && lower_layer_edge_grid != nullptr && ! *lower_layer_edge_grid)
-        *lower_layer_edge_grid = calculate_layer_edge_grid(*m_layer->lower_layer);
+        *lower_layer_edge_grid = m_seam_placer.lower_layer_edge_grid(*m_layer);
 
     // extrude all loops ccw
     bool was_clockwise = loop.make_counter_clockwise();
@@ -2561,23 +2609,22 @@ std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, dou
     // get paths
     ExtrusionPaths paths;
     loop.clip_end(clip_length, &paths);
-    if (paths.empty()) return "";
+    if (paths.empty()) return;
 
     // apply the small perimeter speed
     if (is_perimeter(paths.front().role()) && loop.length() <= SMALL_PERIMETER_LENGTH && speed == -1)
         speed = m_config.small_perimeter_speed.get_abs_value(m_config.perimeter_speed);
 
     // extrude along the path
-    std::string gcode;
     for (ExtrusionPaths::iterator path = paths.begin(); path != paths.end(); ++path) {
 //    description += ExtrusionLoop::role_to_string(loop.loop_role());
 //    description += ExtrusionEntity::role_to_string(path->role);
         path->simplify(m_scaled_resolution);
-        gcode += this->_extrude(*path, description, speed);
+        this->_extrude(gcode, *path, description, speed);
     }
 
     // reset acceleration
-    gcode += m_writer.set_acceleration((unsigned int)(m_config.default_acceleration.value + 0.5));
+    m_writer.set_acceleration(gcode, (unsigned int)(m_config.default_acceleration.value + 0.5));
 
     if (m_wipe.enable)
         m_wipe.path = paths.front().polyline;  // TODO: don't limit wipe to last path
@@ -2613,69 +2660,62 @@ std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, dou
         Point  pt = ((nd * nd >= l2) ? p2 : (p1 + v * (nd / sqrt(l2)))).cast<coord_t>();
         pt.rotate(angle, paths.front().polyline.points.front());
         // generate the travel move
-        gcode += m_writer.travel_to_xy(this->point_to_gcode(pt), "move inwards before travel");
+        m_writer.travel_to_xy(gcode, this->point_to_gcode(pt), "move inwards before travel");
     }
-
-    return gcode;
 }
 
-std::string GCode::extrude_multi_path(ExtrusionMultiPath multipath, std::string description, double speed)
+void GCode::extrude_multi_path(std::string &gcode, ExtrusionMultiPath multipath, std::string description, double speed)
 {
     // extrude along the path
-    std::string gcode;
     for (ExtrusionPath path : multipath.paths) {
 //    description += ExtrusionLoop::role_to_string(loop.loop_role());
 //    description += ExtrusionEntity::role_to_string(path->role);
         path.simplify(m_scaled_resolution);
-        gcode += this->_extrude(path, description, speed);
+        this->_extrude(gcode, path, description, speed);
     }
     if (m_wipe.enable) {
         m_wipe.path = std::move(multipath.paths.back().polyline);  // TODO: don't limit wipe to last path
         m_wipe.path.reverse();
     }
     // reset acceleration
-    gcode += m_writer.set_acceleration((unsigned int)floor(m_config.default_acceleration.value + 0.5));
-    return gcode;
+    m_writer.set_acceleration(gcode, (unsigned int)floor(m_config.default_acceleration.value + 0.5));
 }
 
-std::string GCode::extrude_entity(const ExtrusionEntity &entity, std::string description, double speed, std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid)
+void GCode::extrude_entity(std::string &gcode, const ExtrusionEntity &entity, std::string description, double speed, std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid)
 {
     if (const ExtrusionPath* path = dynamic_cast<const ExtrusionPath*>(&entity))
-        return this->extrude_path(*path, description, speed);
+        this->extrude_path(gcode, *path, description, speed);
     else if (const ExtrusionMultiPath* multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity))
-        return this->extrude_multi_path(*multipath, description, speed);
+        this->extrude_multi_path(gcode, *multipath, description, speed);
     else if (const ExtrusionLoop* loop = dynamic_cast<const ExtrusionLoop*>(&entity))
-        return this->extrude_loop(*loop, description, speed, lower_layer_edge_grid);
+        this->extrude_loop(gcode, *loop, description, speed, lower_layer_edge_grid);
     else
         throw Slic3r::InvalidArgument("Invalid argument supplied to extrude()");
-    return "";
 }
 
-std::string GCode::extrude_path(ExtrusionPath path, std::string description, double speed)
+void GCode::extrude_path(std::string &gcode, ExtrusionPath path, std::string description, double speed)
 {
 //    description += ExtrusionEntity::role_to_string(path.role());
     path.simplify(m_scaled_resolution);
-    std::string gcode = this->_extrude(path, description, speed);
+    this->_extrude(gcode, path, description, speed);
     if (m_wipe.enable) {
         m_wipe.path = std::move(path.polyline);
         m_wipe.path.reverse();
     }
     // reset acceleration
-    gcode += m_writer.set_acceleration((unsigned int)floor(m_config.default_acceleration.value + 0.5));
-    return gcode;
+    m_writer.set_acceleration(gcode, (unsigned int)floor(m_config.default_acceleration.value + 0.5));
 }
 
 // Extrude perimeters: Decide where to put seams (hide or align seams).
-std::string GCode::extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::unique_ptr<EdgeGrid::Grid> &lower_layer_edge_grid)
+void GCode::extrude_perimeters(std::string &gcode, const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::shared_ptr<const EdgeGrid::Grid> &lower_layer_edge_grid)
 {
-    std::string gcode;
     for (const ObjectByExtruder::Island::Region &region : by_region)
         if (! region.perimeters.empty()) {
             m_config.apply(print.get_print_region(&region - &by_region.front()).config());
 
             // plan_perimeters tries to place seams, it needs to have the lower_layer_edge_grid calculated already.
             if (m_layer->lower_layer && ! lower_layer_edge_grid)
-                lower_layer_edge_grid = calculate_layer_edge_grid(*m_layer->lower_layer);
+                lower_layer_edge_grid = m_seam_placer.lower_layer_edge_grid(*m_layer);
 
             m_seam_placer.plan_perimeters(std::vector<const ExtrusionEntity*>(region.perimeters.begin(), region.perimeters.end()),
                 *m_layer, m_config.seam_position, this->last_pos(), EXTRUDER_CONFIG(nozzle_diameter),
@@ -2683,15 +2723,13 @@ std::string GCode::extrude_perimeters(const Print &print, const std::vector<Obje
                 (lower_layer_edge_grid ? lower_layer_edge_grid.get() : nullptr));
 
             for (const ExtrusionEntity* ee : region.perimeters)
-                gcode += this->extrude_entity(*ee, "perimeter", -1., &lower_layer_edge_grid);
+                this->extrude_entity(gcode, *ee, "perimeter", -1., &lower_layer_edge_grid);
         }
-    return gcode;
 }
 
 // Chain the paths hierarchically by a greedy algorithm to minimize a travel distance.
-std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, bool ironing)
+void GCode::extrude_infill(std::string &gcode, const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, bool ironing)
 {
-    std::string 		 gcode;
     ExtrusionEntitiesPtr extrusions;
     const char*          extrusion_name = ironing ? "ironing" : "infill";
     for (const ObjectByExtruder::Island::Region &region : by_region)
@@ -2706,23 +2744,32 @@ std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectBy
                 chain_and_reorder_extrusion_entities(extrusions, &m_last_pos);
                 for (const ExtrusionEntity *fill : extrusions) {
                     auto *eec = dynamic_cast<const ExtrusionEntityCollection*>(fill);
-                    if (eec) {
-                        for (ExtrusionEntity *ee : eec->chained_path_from(m_last_pos).entities)
-                            gcode += this->extrude_entity(*ee, extrusion_name);
-                    } else
-                        gcode += this->extrude_entity(*fill, extrusion_name);
+                    if (eec == nullptr)
+                        this->extrude_entity(gcode, *fill, extrusion_name);
+                    else if (eec->no_sort) {
+                        for (const ExtrusionEntity *ee : eec->entities)
+                            this->extrude_entity(gcode, *ee, extrusion_name);
+                    } else {
+                        // Chain the infill paths without cloning the whole collection, only the reversed paths are copied.
+                        ExtrusionEntitiesPtr entities = eec->entities;
+                        for (const std::pair<size_t, bool> &idx : chain_extrusion_entities(entities, &m_last_pos))
+                            if (idx.second) {
+                                std::unique_ptr<ExtrusionEntity> reversed(entities[idx.first]->clone());
+                                reversed->reverse();
+                                this->extrude_entity(gcode, *reversed, extrusion_name);
+                            } else
+                                this->extrude_entity(gcode, *entities[idx.first], extrusion_name);
+                    }
                 }
             }
         }
-    return gcode;
 }
 
-std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fills)
+void GCode::extrude_support(std::string &gcode, const ExtrusionEntityCollection &support_fills)
 {
     static constexpr const char *support_label            = "support material";
     static constexpr const char *support_interface_label  = "support material interface";
 
-    std::string gcode;
     if (! support_fills.entities.empty()) {
         const double  support_speed            = m_config.support_material_speed.value;
         const double  support_interface_speed  = m_config.support_material_interface_speed.get_abs_value(support_speed);
@@ -2733,21 +2780,20 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
             const double speed = (role == erSupportMaterial) ? support_speed : support_interface_speed;
             const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(ee);
             if (path)
-                gcode += this->extrude_path(*path, label, speed);
+                this->extrude_path(gcode, *path, label, speed);
             else {
                 const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(ee);
                 if (multipath)
-                    gcode += this->extrude_multi_path(*multipath, label, speed);
+                    this->extrude_multi_path(gcode, *multipath, label, speed);
                 else {
                     const ExtrusionEntityCollection *eec = dynamic_cast<const ExtrusionEntityCollection*>(ee);
                     assert(eec);
                     if (eec)
-                        gcode += this->extrude_support(*eec);
+                        this->extrude_support(gcode, *eec);
                 }
             }
         }
     }
-    return gcode;
 }
 
 bool GCode::GCodeOutputStream::is_error() const 
@@ -2817,16 +2863,14 @@ void GCode::GCodeOutputStream::write_format(const char* format, ...)
     va_end(args);
 }
 
-std::string GCode::_extrude(const ExtrusionPath &path, std::string description, double speed)
+void GCode::_extrude(std::string &gcode, const ExtrusionPath &path, std::string description, double speed)
 {
-    std::string gcode;
-
     if (is_bridge(path.role()))
         description += " (bridge)";
 
     // go to first point of extrusion path
     if (!m_last_pos_defined || m_last_pos != path.first_point()) {
-        gcode += this->travel_to(
+        this->travel_to(gcode,
             path.first_point(),
             path.role(),
             "move to first " + description + " point"
@@ -2834,7 +2878,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
     }
 
     // compensate retraction
-    gcode += this->unretract();
+    this->unretract(gcode);
 
     // adjust acceleration
     if (m_config.default_acceleration.value > 0) {
@@ -2852,7 +2896,7 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
         } else {
             acceleration = m_config.default_acceleration.value;
         }
-        gcode += m_writer.set_acceleration((unsigned int)floor(acceleration + 0.5));
+        m_writer.set_acceleration(gcode, (unsigned int)floor(acceleration + 0.5));
     }
 
     // calculate extrusion length per distance unit
@@ -2963,29 +3007,44 @@ std::string GCode::_extrude(const ExtrusionPath &path, std::string description,
             comment += ";_EXTERNAL_PERIMETER";
     }
 
+    // Record the block of extrusion moves for the cooling buffer, so that the cooling buffer will not need to parse them.
+    CoolingBuffer::ExtrusionBlock block;
+    block.set_speed_start    = gcode.size();
     // F is mm per minute.
-    gcode += m_writer.set_speed(F, "", comment);
+    m_writer.set_speed(gcode, F, "", comment);
+    block.set_speed_end      = gcode.size();
     double path_length = 0.;
     {
         std::string comment = m_config.gcode_comments ? description : "";
-        for (const Line &line : path.polyline.lines()) {
-            const double line_length = line.length() * SCALING_FACTOR;
+        const Points &pts = path.polyline.points;
+        for (size_t i = 1; i < pts.size(); ++ i) {
+            const double line_length = (pts[i] - pts[i - 1]).cast<double>().norm() * SCALING_FACTOR;
             path_length += line_length;
-            gcode += m_writer.extrude_to_xy(
-                this->point_to_gcode(line.b),
+            m_writer.extrude_to_xy(gcode,
+                this->point_to_gcode(pts[i]),
                 e_per_mm * line_length,
                 comment);
         }
     }
+    block.moves_end          = gcode.size();
     if (m_enable_cooling_markers)
         gcode += is_bridge(path.role()) ? ";_BRIDGE_FAN_END\n" : ";_EXTRUDE_END\n";
+    block.end                = gcode.size();
+    block.feedrate           = float(F) / 60.f;
+    block.length             = float(path_length);
+    block.x                  = float(m_writer.get_position().x());
+    block.y                  = float(m_writer.get_position().y());
+    block.e                  = float(m_writer.extruder()->E());
+    block.adjustable         = m_enable_cooling_markers && ! is_bridge(path.role());
+    block.external_perimeter = m_enable_cooling_markers && path.role() == erExternalPerimeter;
+    block.bridge             = is_bridge(path.role());
+    m_cooling_blocks.emplace_back(block);
 
     this->set_last_pos(path.last_point());
-    return gcode;
 }
 
 // This method accepts &point in print coordinates.
-std::string GCode::travel_to(const Point &point, ExtrusionRole role, std::string comment)
+void GCode::travel_to(std::string &gcode, const Point &point, ExtrusionRole role, const std::string &comment)
 {
     /*  Define the travel move as a line between current position and the taget point.
         This is expressed in print coordinates, so it will need to be translated by
@@ -3014,13 +3073,12 @@ std::string GCode::travel_to(const Point &point, ExtrusionRole role, std::string
     m_avoid_crossing_perimeters.reset_once_modifiers();
 
     // generate G-code for the travel move
-    std::string gcode;
     if (needs_retraction) {
         if (m_config.avoid_crossing_perimeters && could_be_wipe_disabled)
             m_wipe.reset_path();
 
         Point last_post_before_retract = this->last_pos();
-        gcode += this->retract();
+        this->retract(gcode);
         // When "Wipe while retracting" is enabled, then extruder moves to another position, and travel from this position can cross perimeters.
         // Because of it, it is necessary to call avoid crossing perimeters again with new starting point after calling retraction()
         // FIXME Lukas H.: Try to predict if this second calling of avoid crossing perimeters will be needed or not. It could save computations.
@@ -3040,10 +3098,9 @@ std::string GCode::travel_to(const Point &point, ExtrusionRole role, std::string
     // use G1 because we rely on paths being straight (G0 may make round paths)
     if (travel.size() >= 2) {
         for (size_t i = 1; i < travel.size(); ++ i)
-            gcode += m_writer.travel_to_xy(this->point_to_gcode(travel.points[i]), comment);
+            m_writer.travel_to_xy(gcode, this->point_to_gcode(travel.points[i]), comment);
         this->set_last_pos(travel.points.back());
     }
-    return gcode;
 }
 
 bool GCode::needs_retraction(const Polyline &travel, ExtrusionRole role)
@@ -3074,16 +3131,17 @@ bool GCode::needs_retraction(const Polyline &travel, ExtrusionRole role)
     return true;
 }
 
-std::string GCode::retract(bool toolchange)
+void GCode::retract(std::string &gcode, bool toolchange)
 {
-    std::string gcode;
-
     if (m_writer.extruder() == nullptr)
-        return gcode;
+        return;
 
     // wipe (if it's enabled for this extruder and we have a stored wipe path)
     if (EXTRUDER_CONFIG(wipe) && m_wipe.has_path()) {
-        gcode += toolchange ? m_writer.retract_for_toolchange(true) : m_writer.retract(true);
+        if (toolchange)
+            m_writer.retract_for_toolchange(gcode, true);
+        else
+            m_writer.retract(gcode, true);
         gcode += m_wipe.wipe(*this, toolchange);
     }
 
@@ -3091,13 +3149,14 @@ std::string GCode::retract(bool toolchange)
         (the extruder might be already retracted fully or partially). We call these
         methods even if we performed wipe, since this will ensure the entire retraction
         length is honored in case wipe path was too short.  */
-    gcode += toolchange ? m_writer.retract_for_toolchange() : m_writer.retract();
+    if (toolchange)
+        m_writer.retract_for_toolchange(gcode);
+    else
+        m_writer.retract(gcode);
 
-    gcode += m_writer.reset_e();
+    m_writer.reset_e(gcode);
     if (m_writer.extruder()->retract_length() > 0 || m_config.use_firmware_retraction)
-        gcode += m_writer.lift();
-
-    return gcode;
+        m_writer.lift(gcode);
 }
 
 std::string GCode::set_extruder(unsigned int extruder_id, double print_z)
@@ -223,6 +223,8 @@ private:
         bool        spiral_vase_enable { false };
         // Should the cooling buffer content be flushed at the end of this layer?
         bool        cooling_buffer_flush { false };
+        // Extrusion blocks emitted into gcode, to be processed by the cooling buffer without parsing them.
+        CoolingBuffer::ExtrusionBlocks cooling_blocks;
     };
     LayerResult process_layer(
         const Print                     &print,
@@ -253,16 +255,21 @@ private:
         std::vector<LayerToPrint>                layers_to_print,
         const size_t                             single_object_idx,
         GCodeOutputStream                       &output_stream);
+    // Precompute the avoid crossing perimeters boundaries and the seam placement data of a batch of layers in parallel,
+    // ahead of the serial G-code generator. clear_precomputed_layers() releases them.
+    void precompute_layers(const Print &print, const std::vector<const Layer*> &layers);
+    void clear_precomputed_layers();
 
     void            set_last_pos(const Point &pos) { m_last_pos = pos; m_last_pos_defined = true; }
     bool            last_pos_defined() const { return m_last_pos_defined; }
     void            set_extruders(const std::vector<unsigned int> &extruder_ids);
     std::string     preamble();
     std::string     change_layer(coordf_t print_z);
-    std::string     extrude_entity(const ExtrusionEntity &entity, std::string description = "", double speed = -1., std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
-    std::string     extrude_loop(ExtrusionLoop loop, std::string description, double speed = -1., std::unique_ptr<EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
-    std::string     extrude_multi_path(ExtrusionMultiPath multipath, std::string description = "", double speed = -1.);
-    std::string     extrude_path(ExtrusionPath path, std::string description = "", double speed = -1.);
+    // The extrude_*() methods append the G-code into the G-code buffer of the layer being exported.
+    void            extrude_entity(std::string &gcode, const ExtrusionEntity &entity, std::string description = "", double speed = -1., std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
+    void            extrude_loop(std::string &gcode, ExtrusionLoop loop, std::string description, double speed = -1., std::shared_ptr<const EdgeGrid::Grid> *lower_layer_edge_grid = nullptr);
+    void            extrude_multi_path(std::string &gcode, ExtrusionMultiPath multipath, std::string description = "", double speed = -1.);
+    void            extrude_path(std::string &gcode, ExtrusionPath path, std::string description = "", double speed = -1.);
 
     // Extruding multiple objects with soluble / non-soluble / combined supports
     // on a multi-material printer, trying to minimize tool switches.
@@ -327,14 +334,20 @@ private:
 		// For sequential print, the instance of the object to be printing has to be defined.
 		const size_t                     				 single_object_instance_idx);
 
-    std::string     extrude_perimeters(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::unique_ptr<EdgeGrid::Grid> &lower_layer_edge_grid);
-    std::string     extrude_infill(const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, bool ironing);
-    std::string     extrude_support(const ExtrusionEntityCollection &support_fills);
+    void            extrude_perimeters(std::string &gcode, const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, std::shared_ptr<const EdgeGrid::Grid> &lower_layer_edge_grid);
+    void            extrude_infill(std::string &gcode, const Print &print, const std::vector<ObjectByExtruder::Island::Region> &by_region, bool ironing);
+    void            extrude_support(std::string &gcode, const ExtrusionEntityCollection &support_fills);
 
-    std::string     travel_to(const Point &point, ExtrusionRole role, std::string comment);
+    std::string     travel_to(const Point &point, ExtrusionRole role, std::string comment)
+        { std::string gcode; this->travel_to(gcode, point, role, comment); return gcode; }
+    // Append-style variant of travel_to(), emitting into a caller owned G-code buffer.
+    void            travel_to(std::string &gcode, const Point &point, ExtrusionRole role, const std::string &comment);
     bool            needs_retraction(const Polyline &travel, ExtrusionRole role = erNone);
-    std::string     retract(bool toolchange = false);
-    std::string     unretract() { return m_writer.unlift() + m_writer.unretract(); }
+    std::string     retract(bool toolchange = false)
+        { std::string gcode; this->retract(gcode, toolchange); return gcode; }
+    void            retract(std::string &gcode, bool toolchange = false);
+    std::string     unretract() { std::string gcode; this->unretract(gcode); return gcode; }
+    void            unretract(std::string &gcode) { m_writer.unlift(gcode); m_writer.unretract(gcode); }
     std::string     set_extruder(unsigned int extruder_id, double print_z);
 
     // Cache for custom seam enforcers/blockers for each layer.
@@ -382,6 +395,10 @@ private:
     // Support for G-Code Processor
     float                               m_last_height{ 0.0f };
     float                               m_last_layer_z{ 0.0f };
+    // Size of the G-code generated for the last layer, used to preallocate the G-code buffer of the next layer.
+    size_t                              m_last_layer_gcode_size { 0 };
+    // Extrusion blocks emitted by _extrude() into the G-code buffer of the layer being exported, passed to the cooling buffer.
+    CoolingBuffer::ExtrusionBlocks      m_cooling_blocks;
     float                               m_max_layer_z{ 0.0f };
     float                               m_last_width{ 0.0f };
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
@@ -412,7 +429,8 @@ private:
     // Processor
     GCodeProcessor m_processor;
 
-    std::string _extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
+    // Append G-code of a single extrusion path to a G-code buffer of the layer being exported.
+    void _extrude(std::string &gcode, const ExtrusionPath &path, std::string description = "", double speed = -1);
     void print_machine_envelope(GCodeOutputStream &file, Print &print);
     void _print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
     void _print_first_layer_extruder_temperatures(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
@@ -10,9 +10,12 @@
 #include "AvoidCrossingPerimeters.hpp"
 
 #include <numeric>
+#include <queue>
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 struct TravelPoint
@@ -455,6 +458,136 @@ static std::vector<TravelPoint> simplify_travel(const AvoidCrossingPerimeters::B
     return simplified_path;
 }
 
+// Upper limit of the number of reflex vertices, for which the visibility graph is searched.
+// The visibility matrix of the reflex vertices is quadratic in memory.
+static constexpr size_t travel_router_max_vertices    = 1024;
+// Upper limit of the number of vertices expanded by A*, the contour walk is used if the path is not found sooner.
+static constexpr size_t travel_router_max_expansions  = 256;
+// Number of the last found paths remembered by TravelRouter.
+static constexpr size_t travel_router_cache_size      = 16;
+
+void AvoidCrossingPerimeters::TravelRouter::init(std::shared_ptr<const LayerBoundaries> layer_boundaries, const Boundary &boundary)
+{
+    // The boundary stays alive as long as m_layer_boundaries holds it, thus an equal address means the same boundary.
+    if (m_boundary == &boundary)
+        return;
+    this->reset();
+    m_layer_boundaries = std::move(layer_boundaries);
+    m_boundary         = &boundary;
+}
+
+void AvoidCrossingPerimeters::TravelRouter::reset()
+{
+    m_layer_boundaries.reset();
+    m_boundary = nullptr;
+    m_visibility.clear();
+    m_cache.clear();
+}
+
+bool AvoidCrossingPerimeters::TravelRouter::visible(const Point &a, const Point &b) const
+{
+    FirstIntersectionVisitor visitor(m_boundary->grid);
+    visitor.pt_current = &a;
+    visitor.pt_next    = &b;
+    m_boundary->grid.visit_cells_intersecting_line(a, b, visitor);
+    return ! visitor.intersect;
+}
+
+bool AvoidCrossingPerimeters::TravelRouter::visible(size_t vertex_a, size_t vertex_b)
+{
+    const size_t num_vertices = m_boundary->reflex_vertices.size();
+    if (m_visibility.empty())
+        m_visibility.assign(num_vertices * num_vertices, 0);
+    uint8_t &state = m_visibility[vertex_a * num_vertices + vertex_b];
+    if (state == 0) {
+        state = this->visible(m_boundary->reflex_vertices[vertex_a], m_boundary->reflex_vertices[vertex_b]) ? 1 : 2;
+        m_visibility[vertex_b * num_vertices + vertex_a] = state;
+    }
+    return state == 1;
+}
+
+bool AvoidCrossingPerimeters::TravelRouter::shortest_path(const Point &start, const Point &end, Points &path_out)
+{
+    if (m_boundary == nullptr)
+        return false;
+
+    for (auto it = m_cache.begin(); it != m_cache.end(); ++ it)
+        if (it->start == start && it->end == end) {
+            path_out = it->path;
+            std::rotate(m_cache.begin(), it, it + 1);
+            return true;
+        }
+
+    const Points &vertices     = m_boundary->reflex_vertices;
+    const size_t  num_vertices = vertices.size();
+    Points        path;
+    if (! this->visible(start, end)) {
+        if (num_vertices > travel_router_max_vertices)
+            return false;
+
+        // Lazy A* over the reflex vertices and the end point, which is indexed by num_vertices. The edges are queued
+        // without testing their visibility, which is only tested once an edge is popped from the queue. Thus the costly
+        // EdgeGrid walks are only done for the edges of paths not longer than the shortest path.
+        const size_t        end_idx   = num_vertices;
+        const size_t        start_idx = num_vertices + 1;
+        const size_t        invalid   = std::numeric_limits<size_t>::max();
+        std::vector<size_t> parent(num_vertices + 1, invalid);
+        std::vector<bool>   closed(num_vertices + 1, false);
+        struct QueueItem {
+            // Cost of the path through the edge plus the distance to the end.
+            double estimate;
+            double cost;
+            size_t idx;
+            size_t from;
+            bool operator>(const QueueItem &rhs) const { return estimate > rhs.estimate; }
+        };
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        auto position   = [&vertices, &start, &end, start_idx, end_idx](size_t idx) -> const Point& {
+            return idx == end_idx ? end : idx == start_idx ? start : vertices[idx];
+        };
+        auto distance   = [](const Point &a, const Point &b) { return (b - a).cast<double>().norm(); };
+        auto push_edges = [&queue, &closed, &position, &distance, &end, num_vertices](size_t from, double cost) {
+            const Point &pt = position(from);
+            for (size_t next_idx = 0; next_idx <= num_vertices; ++ next_idx)
+                if (! closed[next_idx] && next_idx != from) {
+                    const Point &next      = position(next_idx);
+                    double       next_cost = cost + distance(pt, next);
+                    queue.push({ next_cost + distance(next, end), next_cost, next_idx, from });
+                }
+        };
+        // Visibility from the start point is not cached, as the start point differs for every travel.
+        auto edge_visible = [this, &position, start_idx, end_idx](size_t from, size_t to) {
+            return (from == start_idx || to == end_idx) ? this->visible(position(from), position(to)) : this->visible(from, to);
+        };
+
+        push_edges(start_idx, 0.);
+        size_t num_expansions = 0;
+        while (! queue.empty()) {
+            const QueueItem item = queue.top();
+            queue.pop();
+            if (closed[item.idx] || ! edge_visible(item.from, item.idx))
+                continue;
+            closed[item.idx] = true;
+            parent[item.idx] = item.from;
+            if (item.idx == end_idx || ++ num_expansions > travel_router_max_expansions)
+                break;
+            push_edges(item.idx, item.cost);
+        }
+
+        if (! closed[end_idx])
+            return false;
+        for (size_t idx = parent[end_idx]; idx != start_idx; idx = parent[idx])
+            path.emplace_back(vertices[idx]);
+        std::reverse(path.begin(), path.end());
+    }
+
+    if (m_cache.size() == travel_router_cache_size)
+        m_cache.pop_back();
+    m_cache.insert(m_cache.begin(), { start, end, path });
+    path_out = std::move(path);
+    return true;
+}
+
 // called by get_perimeter_spacing() / get_perimeter_spacing_external()
 static inline float get_default_perimeter_spacing(const PrintObject &print_object)
 {
@@ -509,6 +642,7 @@ static float get_perimeter_spacing_external(const Layer &layer)
 
 // Called by avoid_perimeters() and by simplify_travel_heuristics().
 static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &boundary,
+                                     AvoidCrossingPerimeters::TravelRouter   &router,
                                      const Point                             &start,
                                      const Point                             &end,
                                      const Layer                             &layer,
@@ -574,10 +708,16 @@ static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &bo
             auto it_second = it_second_r.base() - 1;
             // The exit point from the boundary polygon
             const Intersection &intersection_second = *it_second;
-            Direction           shortest_direction  = get_shortest_direction(boundary, intersection_first, intersection_second,
-                                                                             boundary.boundaries_params[intersection_first.border_idx].back());
-            // Append the path around the border into the path
-            if (shortest_direction == Direction::Forward)
+            left_idx  = intersection_second.line_idx;
+            right_idx = (intersection_second.line_idx >= (boundaries[intersection_second.border_idx].points.size() - 1)) ? 0 : (intersection_second.line_idx + 1);
+            const Point exit_point = get_middle_point_offset(boundaries[intersection_second.border_idx], left_idx, right_idx, intersection_second.point, coord_t(SCALED_EPSILON));
+            // Route between the entry and the exit point through the visibility graph, walk around the border if no route was found.
+            Points route;
+            if (router.shortest_path(result.back().point, exit_point, route)) {
+                for (const Point &pt : route)
+                    result.push_back({pt, int(intersection_first.border_idx)});
+            } else if (get_shortest_direction(boundary, intersection_first, intersection_second,
+                                              boundary.boundaries_params[intersection_first.border_idx].back()) == Direction::Forward)
                 for (int line_idx = int(intersection_first.line_idx); line_idx != int(intersection_second.line_idx);
                     line_idx      = line_idx + 1 < int(boundaries[intersection_first.border_idx].size()) ? line_idx + 1 : 0)
                     result.push_back({get_polygon_vertex_offset(boundaries[intersection_first.border_idx],
@@ -588,9 +728,7 @@ static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &bo
                     result.push_back({get_polygon_vertex_offset(boundaries[intersection_second.border_idx], line_idx + 0, coord_t(SCALED_EPSILON)), int(intersection_first.border_idx)});
 
             // Append the farthest intersection into the path
-            left_idx  = intersection_second.line_idx;
-            right_idx = (intersection_second.line_idx >= (boundaries[intersection_second.border_idx].points.size() - 1)) ? 0 : (intersection_second.line_idx + 1);
-            result.push_back({get_middle_point_offset(boundaries[intersection_second.border_idx], left_idx, right_idx, intersection_second.point, coord_t(SCALED_EPSILON)), int(intersection_second.border_idx)});
+            result.push_back({exit_point, int(intersection_second.border_idx)});
             // Skip intersections in between
             it_first = it_second;
         }
@@ -622,6 +760,7 @@ static size_t avoid_perimeters_inner(const AvoidCrossingPerimeters::Boundary &bo
 
 // Called by AvoidCrossingPerimeters::travel_to()
 static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary &boundary,
+                               AvoidCrossingPerimeters::TravelRouter   &router,
                                const Point                             &start,
                                const Point                             &end,
                                const Layer                             &layer,
@@ -629,7 +768,7 @@ static size_t avoid_perimeters(const AvoidCrossingPerimeters::Boundary &boundary
 {
     // Travel line is completely or partially inside the bounding box.
     std::vector<TravelPoint> path;
-    size_t num_intersections = avoid_perimeters_inner(boundary, start, end, layer, path);
+    size_t num_intersections = avoid_perimeters_inner(boundary, router, start, end, layer, path);
     result_out = to_polyline(path);
 
 #ifdef AVOID_CROSSING_PERIMETERS_DEBUG_OUTPUT
@@ -1081,18 +1220,36 @@ static void init_boundary_distances(AvoidCrossingPerimeters::Boundary *boundary)
         precompute_polygon_distances(boundary->boundaries[poly_idx], boundary->boundaries_params[poly_idx]);
 }
 
-static void init_boundary(AvoidCrossingPerimeters::Boundary *boundary, Polygons &&boundary_polygons)
+// Collect vertices, at which the free space to the left of the boundaries is not convex. Only these vertices
+// may be inner vertices of the shortest path between two points of the free space.
+static void init_boundary_reflex_vertices(AvoidCrossingPerimeters::Boundary *boundary)
 {
-    boundary->clear();
-    boundary->boundaries = std::move(boundary_polygons);
+    for (const Polygon &polygon : boundary->boundaries) {
+        if (polygon.size() < 3)
+            continue;
+        for (size_t point_idx = 0; point_idx < polygon.size(); ++ point_idx) {
+            const Point &middle = polygon.points[point_idx];
+            const Point &left   = find_first_different_vertex<false>(polygon, prev_idx_modulo(point_idx, polygon.points), middle);
+            const Point &right  = find_first_different_vertex<true>(polygon, next_idx_modulo(point_idx, polygon.points), middle);
+            if (left != middle && right != middle && cross2((middle - left).cast<double>(), (right - middle).cast<double>()) < 0.)
+                boundary->reflex_vertices.emplace_back(get_polygon_vertex_offset(polygon, point_idx, coord_t(SCALED_EPSILON)));
+        }
+    }
+}
+
+void AvoidCrossingPerimeters::Boundary::init(Polygons &&boundary_polygons)
+{
+    this->clear();
+    this->boundaries = std::move(boundary_polygons);
 
-    BoundingBox bbox(get_extents(boundary->boundaries));
+    BoundingBox bbox(get_extents(this->boundaries));
     bbox.offset(SCALED_EPSILON);
-    boundary->bbox = BoundingBoxf(bbox.min.cast<double>(), bbox.max.cast<double>());
-    boundary->grid.set_bbox(bbox);
+    this->bbox = BoundingBoxf(bbox.min.cast<double>(), bbox.max.cast<double>());
+    this->grid.set_bbox(bbox);
     // FIXME 1mm grid?
-    boundary->grid.create(boundary->boundaries, coord_t(scale_(1.)));
-    init_boundary_distances(boundary);
+    this->grid.create(this->boundaries, coord_t(scale_(1.)));
+    init_boundary_distances(this);
+    init_boundary_reflex_vertices(this);
 }
 
 // Plan travel, which avoids perimeter crossings by following the boundaries of the layer.
@@ -1114,25 +1271,43 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     const ExPolygons               &lslices          = gcodegen.layer()->lslices;
     const std::vector<BoundingBox> &lslices_bboxes   = gcodegen.layer()->lslices_bboxes;
     bool                            is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, m_grid_lslice, travel)))) {
+    if (!use_external && (is_support_layer || (!lslices.empty() && !any_expolygon_contains(lslices, lslices_bboxes, m_lslice->grid_lslice, travel)))) {
         // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+        if (! m_internal || m_internal->internal.boundaries.empty()) {
+            if (auto it = m_precomputed.find(gcodegen.layer()); it != m_precomputed.end())
+                m_internal = it->second;
+            else {
+                auto boundaries = std::make_shared<LayerBoundaries>();
+                boundaries->internal.init(to_polygons(get_boundary(*gcodegen.layer())));
+                m_internal = std::move(boundaries);
+            }
+            m_internal_router.init(m_internal, m_internal->internal);
+        }
+        const Boundary &internal = m_internal->internal;
 
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
+            travel_intersection_count = avoid_perimeters(internal, m_internal_router, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
     } else if(use_external) {
         // Initialize m_external only when exist any external travel for the current layer.
-        if (m_external.boundaries.empty())
-            init_boundary(&m_external, get_boundary_external(*gcodegen.layer()));
+        if (! m_external || m_external->external.boundaries.empty()) {
+            if (auto it = m_precomputed.find(gcodegen.layer()); it != m_precomputed.end())
+                m_external = it->second;
+            else {
+                auto boundaries = std::make_shared<LayerBoundaries>();
+                boundaries->external.init(get_boundary_external(*gcodegen.layer()));
+                m_external = std::move(boundaries);
+            }
+            m_external_router.init(m_external, m_external->external);
+        }
+        const Boundary &external = m_external->external;
 
         // Trim the travel line by the bounding box.
-        if (!m_external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_external.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_external, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!external.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, external.bbox)) {
+            travel_intersection_count = avoid_perimeters(external, m_external_router, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1164,24 +1339,60 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_grid_lslice, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslice->grid_lslice, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static void init_grid_lslice(EdgeGrid::Grid &grid, const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslice.set_bbox(bbox_slice);
+    grid.set_bbox(bbox_slice);
     //FIXME 1mm grid?
-    m_grid_lslice.create(layer.lslices, coord_t(scale_(1.)));
+    grid.create(layer.lslices, coord_t(scale_(1.)));
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    // The routers are kept, they are reset by travel_to() once the boundaries change.
+    // Thus the instances of an object layer with precomputed boundaries share the routes.
+    m_internal.reset();
+    m_external.reset();
+
+    if (auto it = m_precomputed.find(&layer); it != m_precomputed.end())
+        m_lslice = it->second;
+    else {
+        auto boundaries = std::make_shared<LayerBoundaries>();
+        init_grid_lslice(boundaries->grid_lslice, layer);
+        m_lslice = std::move(boundaries);
+    }
+}
+
+void AvoidCrossingPerimeters::init_layers(const std::vector<const Layer*> &layers)
+{
+    m_precomputed.clear();
+
+    // Boundaries of all layers are calculated in parallel, travel_to() is then called for them serially.
+    // Both the internal and the external boundaries are calculated, though travel_to() may not need them.
+    std::vector<std::shared_ptr<LayerBoundaries>> boundaries(layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()), [&layers, &boundaries](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer &layer = *layers[layer_idx];
+            auto         out   = std::make_shared<LayerBoundaries>();
+            init_grid_lslice(out->grid_lslice, layer);
+            out->internal.init(to_polygons(get_boundary(layer)));
+            out->external.init(get_boundary_external(layer));
+            boundaries[layer_idx] = std::move(out);
+        }
+    });
+
+    m_precomputed.reserve(layers.size());
+    for (size_t layer_idx = 0; layer_idx < layers.size(); ++ layer_idx)
+        m_precomputed.emplace(layers[layer_idx], std::move(boundaries[layer_idx]));
 }
 
 #if 0
@@ -5,6 +5,10 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -24,6 +28,10 @@ public:
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
     void        init_layer(const Layer &layer);
+    // Precompute boundaries of the passed layers in parallel, so that init_layer() and travel_to() only look them up.
+    // Boundaries precomputed by the previous call are released.
+    void        init_layers(const std::vector<const Layer*> &layers);
+    void        clear_layers() { m_precomputed.clear(); }
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -42,12 +50,62 @@ public:
         std::vector<std::vector<float>> boundaries_params;
         // Used for detection of intersection between line and any polygon from boundaries
         EdgeGrid::Grid                  grid;
+        // Reflex vertices of boundaries moved slightly into the free space, nodes of the visibility graph used by TravelRouter.
+        Points                          reflex_vertices;
 
         void clear()
         {
             boundaries.clear();
             boundaries_params.clear();
+            reflex_vertices.clear();
         }
+
+        // Initialize from boundary polygons, the free space is to the left of them.
+        void init(Polygons &&boundary_polygons);
+    };
+
+    struct LayerBoundaries;
+
+    // Searches the shortest path between two points inside the free space of a Boundary by A* over the visibility graph
+    // of the Boundary's reflex vertices. Visibility between the vertices is evaluated lazily and cached, as well as
+    // the last few found paths, as travels between the same islands repeat for all instances of an object.
+    class TravelRouter
+    {
+    public:
+        // The cached visibility and paths are kept if the boundary did not change, for example when travelling
+        // over another instance of the same object layer. The router holds the layer boundaries the boundary belongs to.
+        void        init(std::shared_ptr<const LayerBoundaries> layer_boundaries, const Boundary &boundary);
+        void        reset();
+        // Returns false if the path was not found within the search limits, then path_out is not modified.
+        // Otherwise path_out receives the inner vertices of the path, it is empty if end is visible from start.
+        bool        shortest_path(const Point &start, const Point &end, Points &path_out);
+
+    private:
+        bool        visible(const Point &a, const Point &b) const;
+        bool        visible(size_t vertex_a, size_t vertex_b);
+
+        struct CachedPath {
+            Point  start;
+            Point  end;
+            Points path;
+        };
+
+        std::shared_ptr<const LayerBoundaries> m_layer_boundaries;
+        const Boundary         *m_boundary { nullptr };
+        // Visibility between pairs of reflex vertices: 0 - not evaluated yet, 1 - visible, 2 - hidden.
+        std::vector<uint8_t>    m_visibility;
+        // Most recently used path first.
+        std::vector<CachedPath> m_cache;
+    };
+
+    // Boundaries of a single layer, immutable once created.
+    struct LayerBoundaries {
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid                  grid_lslice;
+        // Store all needed data for travels inside object
+        Boundary                        internal;
+        // Store all needed data for travels outside object
+        Boundary                        external;
     };
 
 private:
@@ -58,12 +116,16 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid m_grid_lslice;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
-    // Store all needed data for travels outside object
-    Boundary m_external;
+    // Boundaries of the current layer. Shared with m_precomputed if the layer was precomputed,
+    // thus they stay valid even after the precomputed boundaries were released.
+    std::shared_ptr<const LayerBoundaries> m_lslice;
+    std::shared_ptr<const LayerBoundaries> m_internal;
+    std::shared_ptr<const LayerBoundaries> m_external;
+    // Routers over the internal and the external boundary of the current layer.
+    TravelRouter   m_internal_router;
+    TravelRouter   m_external_router;
+    // Boundaries precomputed by init_layers().
+    std::unordered_map<const Layer*, std::shared_ptr<const LayerBoundaries>> m_precomputed;
 };
 
 } // namespace Slic3r
@@ -286,29 +286,43 @@ finished:
 	return new_feedrate;
 }
 
-std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
+std::string CoolingBuffer::process_layer(std::string &&gcode, ExtrusionBlocks &&blocks, size_t layer_id, bool flush)
 {
     // Cache the input G-code.
-    if (m_gcode.empty())
-        m_gcode = std::move(gcode);
-    else
+    if (m_gcode.empty()) {
+        m_gcode  = std::move(gcode);
+        m_blocks = std::move(blocks);
+    } else {
+        // Shift the extrusion blocks of the new layer behind the cached G-code.
+        const size_t offset = m_gcode.size();
         m_gcode += gcode;
+        m_blocks.reserve(m_blocks.size() + blocks.size());
+        for (ExtrusionBlock block : blocks) {
+            block.set_speed_start += offset;
+            block.set_speed_end   += offset;
+            block.moves_end       += offset;
+            block.end             += offset;
+            m_blocks.emplace_back(block);
+        }
+    }
 
     std::string out;
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
+        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_blocks, m_current_pos);
         float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
         out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
         m_gcode.clear();
+        m_blocks.clear();
     }
     return out;
 }
 
 // Parse the layer G-code for the moves, which could be adjusted.
+// The extrusion blocks emitted by GCode::_extrude() are not parsed, their CoolingLines are created from the block descriptors.
 // Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, const ExtrusionBlocks &blocks, std::vector<float> &current_pos) const
 {
     std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
     std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
@@ -330,9 +344,59 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
     // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
     // for a sequence of extrusion moves.
     size_t            active_speed_modifier = size_t(-1);
+    // Next extrusion block to be reached.
+    auto              it_block = blocks.begin();
 
     for (; *line_start != 0; line_start = line_end) 
     {
+        const size_t line_offset = line_start - gcode.c_str();
+        // Skip blocks, which were not reached at a start of a line. This should not happen.
+        for (; it_block != blocks.end() && it_block->set_speed_start < line_offset; ++ it_block) ;
+        if (it_block != blocks.end() && it_block->set_speed_start == line_offset) {
+            const ExtrusionBlock &block = *it_block ++;
+            // Only use the block if the G-code was not modified after it was emitted and if the block is not to be merged
+            // with a preceding feedrate modifier, which is not expected to happen. Otherwise parse the block as any other G-code.
+            if (active_speed_modifier == size_t(-1) && block.end <= gcode.size() && block.feedrate > 0.f &&
+                gcode.compare(block.set_speed_start, 4, "G1 F") == 0 && gcode[block.set_speed_end - 1] == '\n') {
+                // The "G1 F" line does not move the print head. With relative extrusion distances it is accounted for
+                // as an extruder move of the preceding line to match the parsing of the "G1 F" line below.
+                const float set_speed_length = m_config.use_relative_e_distances.value ? std::abs(current_pos[3]) : 0.f;
+                // The block extrusion moves are either accumulated into the "G1 F" line if the block is adjustable,
+                // or they are stored as a single line, which is never modified.
+                CoolingLine set_speed(CoolingLine::TYPE_G1 | CoolingLine::TYPE_HAS_F, block.set_speed_start, block.set_speed_end);
+                set_speed.feedrate = block.feedrate;
+                if (block.external_perimeter)
+                    set_speed.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
+                const float time = block.length / block.feedrate;
+                if (block.adjustable) {
+                    set_speed.type    |= CoolingLine::TYPE_ADJUSTABLE;
+                    set_speed.length   = set_speed_length + block.length;
+                    set_speed.time     = set_speed.length / block.feedrate;
+                    set_speed.time_max = (adjustment->min_print_speed == 0.f) ? FLT_MAX : std::max(set_speed.time, set_speed.length / adjustment->min_print_speed);
+                    adjustment->lines.emplace_back(std::move(set_speed));
+                } else {
+                    set_speed.length   = set_speed_length;
+                    set_speed.time     = set_speed.time_max = set_speed_length / block.feedrate;
+                    adjustment->lines.emplace_back(std::move(set_speed));
+                    if (block.moves_end > block.set_speed_end) {
+                        CoolingLine moves(CoolingLine::TYPE_G1, block.set_speed_end, block.moves_end);
+                        moves.length   = block.length;
+                        moves.feedrate = block.feedrate;
+                        moves.time     = time;
+                        moves.time_max = time;
+                        adjustment->lines.emplace_back(std::move(moves));
+                    }
+                }
+                if (block.end > block.moves_end)
+                    adjustment->lines.emplace_back(block.bridge ? CoolingLine::TYPE_BRIDGE_FAN_END : CoolingLine::TYPE_EXTRUDE_END, block.moves_end, block.end);
+                current_pos[0] = block.x;
+                current_pos[1] = block.y;
+                current_pos[3] = block.e;
+                current_pos[4] = block.feedrate;
+                line_end = gcode.c_str() + block.end;
+                continue;
+            }
+        }
         while (*line_end != '\n' && *line_end != 0)
             ++ line_end;
         // sline will not contain the trailing '\n'.
@@ -735,7 +799,7 @@ std::string CoolingBuffer::apply_layer_cooldown(
         }
         if (fan_speed_new != m_fan_speed) {
             m_fan_speed = fan_speed_new;
-            new_gcode  += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, m_fan_speed);
+            GCodeWriter::set_fan(new_gcode, m_config.gcode_flavor, m_config.gcode_comments, m_fan_speed);
         }
     };
 
@@ -756,10 +820,10 @@ std::string CoolingBuffer::apply_layer_cooldown(
             new_gcode.append(line_start, line_end - line_start);
         } else if (line->type & CoolingLine::TYPE_BRIDGE_FAN_START) {
             if (bridge_fan_control)
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, bridge_fan_speed);
+                GCodeWriter::set_fan(new_gcode, m_config.gcode_flavor, m_config.gcode_comments, bridge_fan_speed);
         } else if (line->type & CoolingLine::TYPE_BRIDGE_FAN_END) {
             if (bridge_fan_control)
-                new_gcode += GCodeWriter::set_fan(m_config.gcode_flavor, m_config.gcode_comments, m_fan_speed);
+                GCodeWriter::set_fan(new_gcode, m_config.gcode_flavor, m_config.gcode_comments, m_fan_speed);
         } else if (line->type & CoolingLine::TYPE_EXTRUDE_END) {
             // Just remove this comment.
         } else if (line->type & (CoolingLine::TYPE_ADJUSTABLE | CoolingLine::TYPE_EXTERNAL_PERIMETER | CoolingLine::TYPE_WIPE | CoolingLine::TYPE_HAS_F)) {
@@ -4,6 +4,7 @@
 #include "../libslic3r.h"
 #include <map>
 #include <string>
+#include <vector>
 
 namespace Slic3r {
 
@@ -22,14 +23,44 @@ struct PerExtruderAdjustments;
 //
 class CoolingBuffer {
 public:
+    // Block of extrusion moves with a constant feedrate emitted by GCode::_extrude(), passed to the CoolingBuffer
+    // together with the G-code of a layer, so that the CoolingBuffer does not need to parse these moves back from the G-code.
+    // The block starts with a "G1 F" line, followed by the extrusion moves and optionally by an ";_EXTRUDE_END"
+    // or ";_BRIDGE_FAN_END" marker. All offsets are in bytes, relative to the start of the layer G-code.
+    struct ExtrusionBlock {
+        // Start and end of the "G1 F" line setting the feedrate of the block.
+        size_t          set_speed_start;
+        size_t          set_speed_end;
+        // End of the last extrusion move.
+        size_t          moves_end;
+        // End of the block including the end marker.
+        size_t          end;
+        // Feedrate of the extrusion moves in mm/sec.
+        float           feedrate;
+        // Total XY length of the extrusion moves.
+        float           length;
+        // Position of the print head at the end of the block: X, Y, E.
+        float           x, y, e;
+        // The feedrate line is marked with ";_EXTRUDE_SET_SPEED", thus the block may be slowed down.
+        bool            adjustable;
+        // The feedrate line is marked with ";_EXTERNAL_PERIMETER".
+        bool            external_perimeter;
+        // The block is terminated by ";_BRIDGE_FAN_END" instead of ";_EXTRUDE_END".
+        bool            bridge;
+    };
+    using ExtrusionBlocks = std::vector<ExtrusionBlock>;
+
     CoolingBuffer(GCode &gcodegen);
     void        reset(const Vec3d &position);
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
-    std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
+    std::string process_layer(std::string &&gcode, size_t layer_id, bool flush)
+        { return this->process_layer(std::move(gcode), ExtrusionBlocks(), layer_id, flush); }
+    // Process the layer G-code together with the extrusion blocks emitted into it. Only the G-code outside of the blocks is parsed.
+    std::string process_layer(std::string &&gcode, ExtrusionBlocks &&blocks, size_t layer_id, bool flush);
 
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const;
+    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, const ExtrusionBlocks &blocks, std::vector<float> &current_pos) const;
     float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
@@ -37,6 +68,8 @@ private:
 
     // G-code snippet cached for the support layers preceding an object layer.
     std::string                 m_gcode;
+    // Extrusion blocks of m_gcode.
+    ExtrusionBlocks             m_blocks;
     // Internal data.
     // X,Y,Z,E,F
     std::vector<char>           m_axis;
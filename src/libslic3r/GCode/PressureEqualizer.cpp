@@ -2,6 +2,10 @@
 #include <string.h>
 #include <float.h>
 
+#include <algorithm>
+
+#include <boost/log/trivial.hpp>
+
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
 #include "../LocalesUtils.hpp"
@@ -27,9 +31,9 @@ void PressureEqualizer::reset()
     circular_buffer_items   = 0;
     circular_buffer.assign(circular_buffer_size, GCodeLine());
 
-    // Preallocate some data, so that output_buffer.data() will return an empty string.
-    output_buffer.assign(32, 0);
-    output_buffer_length    = 0;
+    m_text.clear();
+    m_text_released         = 0;
+    m_output.clear();
 
     m_current_extruder = 0;
     // Zero the position of the XYZE axes + the current feed
@@ -50,10 +54,13 @@ void PressureEqualizer::reset()
     // Volumetric rate of a 0.45mm x 0.2mm extrusion at 60mm/s XY movement: 0.45*0.2*60*60=5.4*60 = 324 mm^3/min
     // Volumetric rate of a 0.45mm x 0.2mm extrusion at 20mm/s XY movement: 0.45*0.2*20*60=1.8*60 = 108 mm^3/min
     // Slope of the volumetric rate, changing from 20mm/s to 60mm/s over 2 seconds: (5.4-1.8)*60*60/2=60*60*1.8 = 6480 mm^3/min^2 = 1.8 mm^3/s^2
-    m_max_volumetric_extrusion_rate_slope_positive = (m_config == NULL) ? 6480.f :
-        m_config->max_volumetric_extrusion_rate_slope_positive.value * 60.f * 60.f;
-    m_max_volumetric_extrusion_rate_slope_negative = (m_config == NULL) ? 6480.f :
-        m_config->max_volumetric_extrusion_rate_slope_negative.value * 60.f * 60.f;
+    // The slope options are only defined with HAS_PRESSURE_EQUALIZER, thus they are looked up by name.
+    auto max_volumetric_extrusion_rate_slope = [this](const char *opt_key) {
+        const ConfigOptionFloat *opt = (m_config == NULL) ? nullptr : m_config->option<ConfigOptionFloat>(opt_key);
+        return (opt == nullptr) ? 6480.f : float(opt->value) * 60.f * 60.f;
+    };
+    m_max_volumetric_extrusion_rate_slope_positive = max_volumetric_extrusion_rate_slope("max_volumetric_extrusion_rate_slope_positive");
+    m_max_volumetric_extrusion_rate_slope_negative = max_volumetric_extrusion_rate_slope("max_volumetric_extrusion_rate_slope_negative");
 
     for (size_t i = 0; i < numExtrusionRoles; ++ i) {
         m_max_volumetric_extrusion_rate_slopes[i].negative = m_max_volumetric_extrusion_rate_slope_negative;
@@ -71,36 +78,35 @@ void PressureEqualizer::reset()
     line_idx = 0;
 }
 
-const char* PressureEqualizer::process(const char *szGCode, bool flush)
+std::string PressureEqualizer::process_layer(std::string &&gcode, bool flush)
 {
-    // Reset length of the output_buffer.
-    output_buffer_length = 0;
-
-    if (szGCode != 0) {
-        const char *p = szGCode;
-        while (*p != 0) {
-            // Find end of the line.
-            const char *endl = p;
-            // Slic3r always generates end of lines in a Unix style.
-            for (; *endl != 0 && *endl != '\n'; ++ endl) ;
-            if (circular_buffer_items == circular_buffer_size)
-                // Buffer is full. Push out the oldest line.
-                output_gcode_line(circular_buffer[circular_buffer_pos]);
-            else
-                ++ circular_buffer_items;
-            // Process a G-code line, store it into the provided GCodeLine object.
-            size_t idx_tail = circular_buffer_pos;
-            circular_buffer_pos = circular_buffer_idx_next(circular_buffer_pos);
-            if (! process_line(p, endl - p, circular_buffer[idx_tail])) {
-                // The line has to be forgotten. It contains comment marks, which shall be
-                // filtered out of the target g-code.
-                circular_buffer_pos = idx_tail;
-                -- circular_buffer_items;
-            }
-            p = endl;
-            if (*p == '\n') 
-                ++ p;
+    // Drop the text of the lines pushed out of the circular buffer by the previous layer.
+    release_text();
+    m_output.reserve(gcode.size() + 64);
+
+    const char *p = gcode.c_str();
+    while (*p != 0) {
+        // Find end of the line.
+        const char *endl = p;
+        // Slic3r always generates end of lines in a Unix style.
+        for (; *endl != 0 && *endl != '\n'; ++ endl) ;
+        if (circular_buffer_items == circular_buffer_size)
+            // Buffer is full. Push out the oldest line.
+            output_gcode_line(circular_buffer[circular_buffer_pos]);
+        else
+            ++ circular_buffer_items;
+        // Process a G-code line, store it into the provided GCodeLine object.
+        size_t idx_tail = circular_buffer_pos;
+        circular_buffer_pos = circular_buffer_idx_next(circular_buffer_pos);
+        if (! process_line(p, endl - p, circular_buffer[idx_tail])) {
+            // The line has to be forgotten. It contains comment marks, which shall be
+            // filtered out of the target g-code.
+            circular_buffer_pos = idx_tail;
+            -- circular_buffer_items;
         }
+        p = endl;
+        if (*p == '\n') 
+            ++ p;
     }
 
     if (flush) {
@@ -113,19 +119,29 @@ const char* PressureEqualizer::process(const char *szGCode, bool flush)
         // Reset the index pointer.
         assert(circular_buffer_items == 0);
         circular_buffer_pos = 0;
+        release_text();
 
-#if 1 
-        printf("Statistics: \n"); 
-        printf("Minimum volumetric extrusion rate: %f\n", m_stat.volumetric_extrusion_rate_min);
-        printf("Maximum volumetric extrusion rate: %f\n", m_stat.volumetric_extrusion_rate_max);
         if (m_stat.extrusion_length > 0)
             m_stat.volumetric_extrusion_rate_avg /= m_stat.extrusion_length;
-        printf("Average volumetric extrusion rate: %f\n", m_stat.volumetric_extrusion_rate_avg);
+        BOOST_LOG_TRIVIAL(debug) << "PressureEqualizer statistics: minimum volumetric extrusion rate: " << m_stat.volumetric_extrusion_rate_min
+            << ", maximum volumetric extrusion rate: " << m_stat.volumetric_extrusion_rate_max
+            << ", average volumetric extrusion rate: " << m_stat.volumetric_extrusion_rate_avg;
         m_stat.reset();
-#endif
     } 
 
-    return output_buffer.data();
+    std::string out;
+    out.swap(m_output);
+    return out;
+}
+
+void PressureEqualizer::release_text()
+{
+    // The lines are pushed out of the circular buffer in the order they were pushed in,
+    // thus all the text in front of the oldest line still in the buffer may be released.
+    size_t raw_begin = circular_buffer_items == 0 ? m_text_released + m_text.size() : circular_buffer[circular_buffer_idx_head()].raw_begin;
+    assert(raw_begin >= m_text_released && raw_begin <= m_text_released + m_text.size());
+    m_text.erase(0, raw_begin - m_text_released);
+    m_text_released = raw_begin;
 }
 
 // Is a white space?
@@ -158,11 +174,15 @@ static inline int parse_int(const char *&line)
 // If succeeded, the line pointer is advanced.
 static inline float parse_float(const char *&line)
 {
-    char *endptr = NULL;
-    float result = string_to_double_decimal_point(line, &endptr);
-    if (endptr == NULL || !is_ws_or_eol(*endptr))
+    // Limit the parsed string to the current token, the line may be followed by the rest of the layer G-code.
+    const char *end = line;
+    while (! is_ws_or_eol(*end))
+        ++ end;
+    size_t pos = 0;
+    float result = float(string_to_double_decimal_point(std::string_view(line, end - line), &pos));
+    if (pos == 0 || line + pos != end)
         throw Slic3r::RuntimeError("PressureEqualizer: Error parsing a float");
-    line = endptr;
+    line = end;
     return result;
 };
 
@@ -178,15 +198,14 @@ bool PressureEqualizer::process_line(const char *line, const size_t len, GCodeLi
         return false;
     }
 
-    // Set the type, copy the line to the buffer.
+    // Set the type, copy the line to the text buffer.
     buf.type = GCODELINETYPE_OTHER;
     buf.modified = false;
-    if (buf.raw.size() < len + 1)
-        buf.raw.assign(line, line + len + 1);
-    else
-        memcpy(buf.raw.data(), line, len);
-    buf.raw[len] = 0;
+    buf.extruding = false;
+    buf.time = 0.f;
+    buf.raw_begin = m_text_released + m_text.size();
     buf.raw_length = len;
+    m_text.append(line, len);
 
     memcpy(buf.pos_start, m_current_pos, sizeof(float)*5);
     memcpy(buf.pos_end, m_current_pos, sizeof(float)*5);
@@ -264,14 +283,11 @@ bool PressureEqualizer::process_line(const char *line, const size_t len, GCodeLi
                     buf.volumetric_extrusion_rate_start = rate;
                     buf.volumetric_extrusion_rate_end   = rate;
                     m_stat.update(rate, sqrt(len2));
-                    if (rate < 40.f) {
-                    	printf("Extremely low flow rate: %f. Line %d, Length: %f, extrusion: %f Old position: (%f, %f, %f), new position: (%f, %f, %f)\n", 
-                            rate, 
-                            int(line_idx),
-                            sqrt(len2), sqrt((diff[3]*diff[3])/len2),
-                            m_current_pos[0], m_current_pos[1], m_current_pos[2],
-                            new_pos[0], new_pos[1], new_pos[2]);
-                    }
+                    if (rate < 40.f)
+                        BOOST_LOG_TRIVIAL(trace) << "PressureEqualizer: Extremely low flow rate: " << rate << ". Line " << line_idx
+                            << ", Length: " << sqrt(len2) << ", extrusion: " << sqrt((diff[3]*diff[3])/len2)
+                            << " Old position: (" << m_current_pos[0] << ", " << m_current_pos[1] << ", " << m_current_pos[2]
+                            << "), new position: (" << new_pos[0] << ", " << new_pos[1] << ", " << new_pos[2] << ")";
                 }
             } else if (changed[0] || changed[1] || changed[2]) {
                 // Moving without extrusion.
@@ -352,6 +368,10 @@ bool PressureEqualizer::process_line(const char *line, const size_t len, GCodeLi
 
     buf.extruder_id = m_current_extruder;
     memcpy(buf.pos_end, m_current_pos, sizeof(float)*5);
+    // The positions of a line stay intact while it is in the circular buffer, cache the values needed by adjust_volumetric_rate().
+    buf.extruding = buf.moving_xy() && buf.pos_end[3] > buf.pos_start[3];
+    if (buf.extruding)
+        buf.time = buf.dist_xyz() / buf.feedrate();
 
     adjust_volumetric_rate();
     ++ line_idx;
@@ -360,16 +380,19 @@ bool PressureEqualizer::process_line(const char *line, const size_t len, GCodeLi
 
 void PressureEqualizer::output_gcode_line(GCodeLine &line)
 {
+    assert(line.raw_begin >= m_text_released && line.raw_begin + line.raw_length <= m_text_released + m_text.size());
+    const char *raw = m_text.data() + (line.raw_begin - m_text_released);
     if (! line.modified) {
-        push_to_output(line.raw.data(), line.raw_length, true);
+        push_to_output(raw, line.raw_length, true);
         return;
     }
 
     // The line was modified.
     // Find the comment.
-    const char *comment = line.raw.data();
-    while (*comment != ';' && *comment != 0) ++comment;
-    if (*comment != ';')
+    const char *raw_end = raw + line.raw_length;
+    const char *comment = std::find(raw, raw_end, ';');
+    size_t      comment_len = raw_end - comment;
+    if (comment == raw_end)
         comment = NULL;
     
     // Emit the line with lowered extrusion rates.
@@ -378,7 +401,7 @@ void PressureEqualizer::output_gcode_line(GCodeLine &line)
     size_t nSegments = size_t(ceil(l / m_max_segment_length));
     if (nSegments == 1) {
         // Just update this segment.
-        push_line_to_output(line, line.feedrate() * line.volumetric_correction_avg(), comment);
+        push_line_to_output(line, line.feedrate() * line.volumetric_correction_avg(), comment, comment_len);
     } else {
         bool accelerating = line.volumetric_extrusion_rate_start < line.volumetric_extrusion_rate_end;
         // Update the initial and final feed rate values.
@@ -428,8 +451,9 @@ void PressureEqualizer::output_gcode_line(GCodeLine &line)
                     line.pos_end[i] = pos_start[i] + (pos_end[i] - pos_start[i]) * t;
                     line.pos_provided[i] = true;
                 }
-                push_line_to_output(line, pos_start[4], comment);
+                push_line_to_output(line, pos_start[4], comment, comment_len);
                 comment = NULL;
+                comment_len = 0;
                 memcpy(line.pos_start, line.pos_end, sizeof(float)*5);
                 memcpy(pos_start, line.pos_end, sizeof(float)*5);
             }
@@ -442,8 +466,9 @@ void PressureEqualizer::output_gcode_line(GCodeLine &line)
                 line.pos_provided[j] = true;
             } 
             // Interpolate the feed rate at the center of the segment.
-            push_line_to_output(line, pos_start[4] + (pos_end[4] - pos_start[4]) * (float(i) - 0.5f) / float(nSegments), comment);
+            push_line_to_output(line, pos_start[4] + (pos_end[4] - pos_start[4]) * (float(i) - 0.5f) / float(nSegments), comment, comment_len);
             comment = NULL;
+            comment_len = 0;
             memcpy(line.pos_start, line.pos_end, sizeof(float)*5);
         }
 		if (l_steady > 0.f && accelerating) {
@@ -451,7 +476,7 @@ void PressureEqualizer::output_gcode_line(GCodeLine &line)
                 line.pos_end[i] = pos_end2[i];
                 line.pos_provided[i] = true;
             }
-            push_line_to_output(line, pos_end[4], comment);
+            push_line_to_output(line, pos_end[4], comment, comment_len);
         }
     }
 }
@@ -465,27 +490,44 @@ void PressureEqualizer::adjust_volumetric_rate()
     const size_t idx_head = circular_buffer_idx_head();
     const size_t idx_tail = circular_buffer_idx_prev(circular_buffer_idx_tail());
     size_t idx = idx_tail;
-    if (idx == idx_head || ! circular_buffer[idx].extruding())
+    if (idx == idx_head || ! circular_buffer[idx].extruding)
         // Nothing to do, the last move is not extruding.
         return;
 
-    float feedrate_per_extrusion_role[numExtrusionRoles];
-    for (size_t i = 0; i < numExtrusionRoles; ++ i)
-        feedrate_per_extrusion_role[i] = FLT_MAX;
-    feedrate_per_extrusion_role[circular_buffer[idx].extrusion_role] = circular_buffer[idx].volumetric_extrusion_rate_start;
+    // The limits are only propagated for the extrusion roles, for which feedrate_per_extrusion_role[] was set already.
+    // All the other roles are unlimited (FLT_MAX), thus they would be skipped anyway. Bit mask of the limited roles,
+    // the roles are processed in ascending order as the limit of one role influences the time of the segment used by the next role.
+    static_assert(numExtrusionRoles <= 32, "Extrusion roles do not fit a 32bit mask");
+    auto role_mask = [](ExtrusionRole role) -> uint32_t { return size_t(role) < numExtrusionRoles ? (uint32_t(1) << role) : 0; };
+    float    feedrate_per_extrusion_role[numExtrusionRoles];
+    uint32_t roles_limited;
+    auto     init_role_limits = [&feedrate_per_extrusion_role, &roles_limited](const GCodeLine &line, float rate) {
+        for (size_t i = 0; i < numExtrusionRoles; ++ i)
+            feedrate_per_extrusion_role[i] = FLT_MAX;
+        roles_limited = 0;
+        if (size_t(line.extrusion_role) < numExtrusionRoles) {
+            feedrate_per_extrusion_role[line.extrusion_role] = rate;
+            roles_limited = uint32_t(1) << line.extrusion_role;
+        }
+    };
+    init_role_limits(circular_buffer[idx], circular_buffer[idx].volumetric_extrusion_rate_start);
 
     bool modified = true;
     while (modified && idx != idx_head) {
         size_t idx_prev = circular_buffer_idx_prev(idx);
-        for (; ! circular_buffer[idx_prev].extruding() && idx_prev != idx_head; idx_prev = circular_buffer_idx_prev(idx_prev)) ;
-        if (! circular_buffer[idx_prev].extruding())
+        for (; ! circular_buffer[idx_prev].extruding && idx_prev != idx_head; idx_prev = circular_buffer_idx_prev(idx_prev)) ;
+        if (! circular_buffer[idx_prev].extruding)
         	break;
         // Volumetric extrusion rate at the start of the succeding segment.
         float rate_succ = circular_buffer[idx].volumetric_extrusion_rate_start;
         // What is the gradient of the extrusion rate between idx_prev and idx?
         idx = idx_prev;
         GCodeLine &line = circular_buffer[idx];
-        for (size_t iRole = 1; iRole < numExtrusionRoles; ++ iRole) {
+        const uint32_t roles = roles_limited | role_mask(line.extrusion_role);
+        for (size_t iRole = 1; (roles >> iRole) != 0; ++ iRole) {
+            if (((roles >> iRole) & 1) == 0)
+                // The rate for ExtrusionRole iRole is unlimited.
+                continue;
             float rate_slope = m_max_volumetric_extrusion_rate_slopes[iRole].negative;
             if (rate_slope == 0)
                 // The negative rate is unlimited.
@@ -516,25 +558,28 @@ void PressureEqualizer::adjust_volumetric_rate()
 //              modified = true;
             }
             feedrate_per_extrusion_role[iRole] = (iRole == line.extrusion_role) ? line.volumetric_extrusion_rate_start : rate_start;
+            roles_limited |= uint32_t(1) << iRole;
         }
     }
 
     // Go forward and adjust the feedrate to decrease the slope of the extrusion rate changes.
-    for (size_t i = 0; i < numExtrusionRoles; ++ i)
-        feedrate_per_extrusion_role[i] = FLT_MAX;
-    feedrate_per_extrusion_role[circular_buffer[idx].extrusion_role] = circular_buffer[idx].volumetric_extrusion_rate_end;
+    init_role_limits(circular_buffer[idx], circular_buffer[idx].volumetric_extrusion_rate_end);
 
-    assert(circular_buffer[idx].extruding());
+    assert(circular_buffer[idx].extruding);
     while (idx != idx_tail) {
         size_t idx_next = circular_buffer_idx_next(idx);
-        for (; ! circular_buffer[idx_next].extruding() && idx_next != idx_tail; idx_next = circular_buffer_idx_next(idx_next)) ;
-        if (! circular_buffer[idx_next].extruding())
+        for (; ! circular_buffer[idx_next].extruding && idx_next != idx_tail; idx_next = circular_buffer_idx_next(idx_next)) ;
+        if (! circular_buffer[idx_next].extruding)
         	break;
         float rate_prec = circular_buffer[idx].volumetric_extrusion_rate_end;
         // What is the gradient of the extrusion rate between idx_prev and idx?
         idx = idx_next;
         GCodeLine &line = circular_buffer[idx];
-        for (size_t iRole = 1; iRole < numExtrusionRoles; ++ iRole) {
+        const uint32_t roles = roles_limited | role_mask(line.extrusion_role);
+        for (size_t iRole = 1; (roles >> iRole) != 0; ++ iRole) {
+            if (((roles >> iRole) & 1) == 0)
+                // The rate for ExtrusionRole iRole is unlimited.
+                continue;
             float rate_slope = m_max_volumetric_extrusion_rate_slopes[iRole].positive;
             if (rate_slope == 0)
                 // The positive rate is unlimited.
@@ -562,6 +607,7 @@ void PressureEqualizer::adjust_volumetric_rate()
                 line.modified = true;
             }
             feedrate_per_extrusion_role[iRole] = (iRole == line.extrusion_role) ? line.volumetric_extrusion_rate_end : rate_end;
+            roles_limited |= uint32_t(1) << iRole;
         }
     }
 }
@@ -577,37 +623,13 @@ void PressureEqualizer::push_axis_to_output(const char axis, const float value,
 
 void PressureEqualizer::push_to_output(const char *text, const size_t len, bool add_eol)
 {
-    // New length of the output buffer content.
-    size_t len_new = output_buffer_length + len + 1;
-    if (add_eol)
-        ++ len_new;
-
-    // Resize the output buffer to a power of 2 higher than the required memory.
-    if (output_buffer.size() < len_new) {
-        size_t v = len_new;
-        // Compute the next highest power of 2 of 32-bit v
-        // http://graphics.stanford.edu/~seander/bithacks.html
-        v--;
-        v |= v >> 1;
-        v |= v >> 2;
-        v |= v >> 4;
-        v |= v >> 8;
-        v |= v >> 16;
-        v++;
-        output_buffer.resize(v);
-    }
-
     // Copy the text to the output.
-    if (len != 0) {
-        memcpy(output_buffer.data() + output_buffer_length, text, len);
-        output_buffer_length += len;
-    }
+    m_output.append(text, len);
     if (add_eol)
-        output_buffer[output_buffer_length ++] = '\n';
-    output_buffer[output_buffer_length] = 0;
+        m_output += '\n';
 }
 
-void PressureEqualizer::push_line_to_output(const GCodeLine &line, const float new_feedrate, const char *comment)
+void PressureEqualizer::push_line_to_output(const GCodeLine &line, const float new_feedrate, const char *comment, size_t comment_len)
 {
     push_to_output("G1", 2, false);
     for (char i = 0; i < 3; ++ i)
@@ -617,7 +639,7 @@ void PressureEqualizer::push_line_to_output(const GCodeLine &line, const float n
 //    if (line.pos_provided[4] || fabs(line.feedrate() - new_feedrate) > 1e-5)
         push_axis_to_output('F', new_feedrate);
     // output comment and EOL
-    push_to_output(comment, (comment == NULL) ? 0 : strlen(comment), true);
+    push_to_output(comment, (comment == NULL) ? 0 : comment_len, true);
 } 
 
 } // namespace Slic3r
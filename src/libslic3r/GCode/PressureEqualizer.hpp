@@ -17,10 +17,10 @@ public:
 
     void reset();
 
-    // Process a next batch of G-code lines. Flush the internal buffers if asked for.
-    const char* process(const char *szGCode, bool flush);
-
-    size_t get_output_buffer_length() const { return output_buffer_length; }
+    // Process G-code of a next layer and return the processed G-code. The last lines are kept in the internal
+    // ring buffer to adjust their extrusion rates by the lines to come, thus the output lags behind the input.
+    // Flush the internal buffers if asked for.
+    std::string process_layer(std::string &&gcode, bool flush);
 
 private:
     struct Statistics
@@ -84,12 +84,16 @@ private:
         GCODELINETYPE_EXTRUDE,
     };
 
+    // Numeric record of a single G-code line. The text of the line is kept in m_text.
     struct GCodeLine
     {
         GCodeLine() : 
             type(GCODELINETYPE_INVALID),
-            raw_length(0),
             modified(false),
+            extruding(false),
+            raw_begin(0),
+            raw_length(0),
+            time(0.f),
             extruder_id(0), 
             volumetric_extrusion_rate(0.f), 
             volumetric_extrusion_rate_start(0.f), 
@@ -98,7 +102,6 @@ private:
 
         bool        moving_xy()     const { return fabs(pos_end[0] - pos_start[0]) > 0.f || fabs(pos_end[1] - pos_start[1]) > 0.f; }
         bool        moving_z ()     const { return fabs(pos_end[2] - pos_start[2]) > 0.f; }
-        bool        extruding()     const { return moving_xy() && pos_end[3] > pos_start[3]; }
         bool        retracting()    const { return pos_end[3] < pos_start[3]; }
         bool        deretracting()  const { return ! moving_xy() && pos_end[3] > pos_start[3]; }
 
@@ -109,32 +112,32 @@ private:
         float       dist_e()        const { return fabs(pos_end[3] - pos_start[3]); }
 
         float       feedrate()      const { return pos_end[4]; }
-        float       time()          const { return dist_xyz() / feedrate(); }
-        float       time_inv()      const { return feedrate() / dist_xyz(); }
         float       volumetric_correction_avg() const { 
             float avg_correction = 0.5f * (volumetric_extrusion_rate_start + volumetric_extrusion_rate_end) / volumetric_extrusion_rate; 
             assert(avg_correction > 0.f);
             assert(avg_correction <= 1.00000001f);
             return avg_correction;
         }
-        float       time_corrected()  const { return time() * volumetric_correction_avg(); }
+        float       time_corrected()  const { return time * volumetric_correction_avg(); }
 
         GCodeLineType type;
-
-        // We try to keep the string buffer once it has been allocated, so it will not be reallocated over and over.
-        std::vector<char>   raw;
-        size_t              raw_length;
         // If modified, the raw text has to be adapted by the new extrusion rate,
         // or maybe the line needs to be split into multiple lines.
-        bool                modified;
+        bool        modified;
+        // Moving in XY while extruding. Cached, as the positions do not change until the line is emitted.
+        bool        extruding;
+        // Was the axis found on the G-code line? X,Y,Z,F
+        bool        pos_provided[5];
+
+        // Position of the text of this line in the stream of all lines passed through m_text, without the end of line.
+        size_t      raw_begin;
+        size_t      raw_length;
 
-        // float       timeStart;
-        // float       timeEnd;
         // X,Y,Z,E,F. Storing the state of the currently active extruder only.
         float       pos_start[5];
         float       pos_end[5];
-        // Was the axis found on the G-code line? X,Y,Z,F
-        bool        pos_provided[5];
+        // Duration of an extruding move, dist_xyz() / feedrate(). Cached for the same reason as extruding.
+        float       time;
 
         // Index of the active extruder.
         size_t      extruder_id;
@@ -163,26 +166,32 @@ private:
     // Number of valid lines in the circular buffer. Lower or equal to circular_buffer_size.
     size_t                          circular_buffer_items;
 
-    // Output buffer will only grow. It will not be reallocated over and over.
-    std::vector<char>               output_buffer;
-    size_t                          output_buffer_length;
+    // Text of the lines in the ring buffer, appended to the end and released from the front.
+    std::string                     m_text;
+    // Number of characters released from the front of m_text so far, (GCodeLine::raw_begin - m_text_released) indexes m_text.
+    size_t                          m_text_released;
+
+    // Output of the current process_layer() call.
+    std::string                     m_output;
 
     // For debugging purposes. Index of the G-code line processed.
     size_t                          line_idx;
 
     bool process_line(const char *line, const size_t len, GCodeLine &buf);
     void output_gcode_line(GCodeLine &buf);
+    // Release the text of the lines, which were already pushed out of the circular buffer.
+    void release_text();
 
     // Go back from the current circular_buffer_pos and lower the feedtrate to decrease the slope of the extrusion rate changes.
     // Then go forward and adjust the feedrate to decrease the slope of the extrusion rate changes.
     void adjust_volumetric_rate();
 
-    // Push the text to the end of the output_buffer.
+    // Push the text to the end of the output.
     void push_to_output(const char *text, const size_t len, bool add_eol = true);
     // Push an axis assignment to the end of the output buffer.
     void push_axis_to_output(const char axis, const float value, bool add_eol = false);
     // Push a G-code line to the output, 
-    void push_line_to_output(const GCodeLine &line, const float new_feedrate, const char *comment);
+    void push_line_to_output(const GCodeLine &line, const float new_feedrate, const char *comment, size_t comment_len);
 
     size_t circular_buffer_idx_head() const {
         size_t idx = circular_buffer_pos + circular_buffer_size - circular_buffer_items;
@@ -8,6 +8,8 @@
 #include "libslic3r/SVG.hpp"
 #include "libslic3r/Layer.hpp"
 
+#include <tbb/parallel_for.h>
+
 namespace Slic3r {
 
 // This penalty is added to all points inside custom blockers (subtracted from pts inside enforcers).
@@ -49,6 +51,50 @@ plot(p2.subs(r,0.2).subs(z,1.), (x, -1, 3), adaptive=False, nb_of_points=400)
 
 
 
+// Penalty of a point of an external perimeter, which is not supported by the layer below.
+static float overhang_penalty(const Point& pt, coordf_t nozzle_dmr, const EdgeGrid::Grid& lower_layer_edge_grid)
+{
+    const float penaltyOverhangHalf = 10.f;
+    // Use the edge grid distance field structure over the lower layer to calculate overhangs.
+    coord_t nozzle_r = coord_t(std::floor(scale_(0.5 * nozzle_dmr) + 0.5));
+    coord_t search_r = coord_t(std::floor(scale_(0.8 * nozzle_dmr) + 0.5));
+    coordf_t dist;
+    // Signed distance is positive outside the object, negative inside the object.
+    // The point is considered at an overhang, if it is more than nozzle radius
+    // outside of the lower layer contour.
+    [[maybe_unused]] bool found = lower_layer_edge_grid.signed_distance(pt, search_r, dist);
+    // If the approximate Signed Distance Field was initialized over lower_layer_edge_grid,
+    // then the signed distnace shall always be known.
+    assert(found);
+    return extrudate_overlap_penalty(float(nozzle_r), penaltyOverhangHalf, float(dist));
+}
+
+
+
+static std::unique_ptr<EdgeGrid::Grid> calculate_layer_edge_grid(const Layer& layer)
+{
+    auto out = std::make_unique<EdgeGrid::Grid>();
+
+    // Create the distance field for a layer below.
+    const coord_t distance_field_resolution = coord_t(scale_(1.) + 0.5);
+    out->create(layer.lslices, distance_field_resolution);
+    out->calculate_sdf();
+#if 0
+        {
+            static int iRun = 0;
+            BoundingBox bbox = (*lower_layer_edge_grid)->bbox();
+            bbox.min(0) -= scale_(5.f);
+            bbox.min(1) -= scale_(5.f);
+            bbox.max(0) += scale_(5.f);
+            bbox.max(1) += scale_(5.f);
+            EdgeGrid::save_png(*(*lower_layer_edge_grid), bbox, scale_(0.1f), debug_out_path("GCode_extrude_loop_edge_grid-%d.png", iRun++));
+        }
+#endif
+    return out;
+}
+
+
+
 // Return a value in <0, 1> of a cubic B-spline kernel centered around zero.
 // The B-spline is re-scaled so it has value 1 at zero.
 static inline float bspline_kernel(float x)
@@ -194,6 +240,7 @@ void SeamPlacer::init(const Print& print)
     m_blockers.clear();
     m_seam_history.clear();
     m_po_list.clear();
+    this->clear_precomputed();
 
     const std::vector<double>& nozzle_dmrs = print.config().nozzle_diameter.values;
     float max_nozzle_dmr = *std::max_element(nozzle_dmrs.begin(), nozzle_dmrs.end());
@@ -292,6 +339,74 @@ void SeamPlacer::init(const Print& print)
 
 
 
+void SeamPlacer::precompute_layers(const Print& print, const std::vector<const Layer*>& layers)
+{
+    this->clear_precomputed();
+
+    // Distance fields of the layers below, each calculated once.
+    std::vector<const Layer*> lower_layers;
+    for (const Layer* layer : layers)
+        if (layer->lower_layer != nullptr && dynamic_cast<const SupportLayer*>(layer) == nullptr)
+            lower_layers.emplace_back(layer->lower_layer);
+    sort_remove_duplicates(lower_layers);
+    std::vector<std::shared_ptr<const EdgeGrid::Grid>> grids(lower_layers.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, lower_layers.size()), [&lower_layers, &grids](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            grids[i] = calculate_layer_edge_grid(*lower_layers[i]);
+    });
+    for (size_t i = 0; i < lower_layers.size(); ++ i)
+        m_precomputed_grids.emplace(lower_layers[i], std::move(grids[i]));
+
+    // External perimeters of all layers, the same loops plan_perimeters() calculates the seams for.
+    std::vector<std::pair<const ExtrusionLoop*, const LayerRegion*>> loops;
+    for (const Layer* layer : layers)
+        if (dynamic_cast<const SupportLayer*>(layer) == nullptr)
+            for (const LayerRegion* layerm : layer->regions())
+                for (const ExtrusionEntity* island : layerm->perimeters.entities)
+                    for (const ExtrusionEntity* ee : static_cast<const ExtrusionEntityCollection*>(island)->entities)
+                        if (ee->role() == erExternalPerimeter && ee->is_loop())
+                            loops.emplace_back(static_cast<const ExtrusionLoop*>(ee), layerm);
+
+    std::vector<PrecomputedLoop> precomputed(loops.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, loops.size()), [this, &print, &loops, &precomputed](const tbb::blocked_range<size_t>& range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const ExtrusionLoop& loop   = *loops[i].first;
+            const LayerRegion&   layerm = *loops[i].second;
+            const Layer&         layer  = *layerm.layer();
+            const PrintObject*   po     = layer.object();
+            PrecomputedLoop&     out    = precomputed[i];
+            out.polygon       = loop.polygon();
+            out.was_clockwise = out.polygon.make_counter_clockwise();
+            out.bbox          = out.polygon.bounding_box();
+            size_t po_idx     = std::find(m_po_list.begin(), m_po_list.end(), po) - m_po_list.begin();
+            size_t layer_idx  = layer.id() - po->layers().front()->id();
+            if (po_idx < m_po_list.size() && this->is_custom_seam_on_layer(layer_idx, po_idx))
+                out.polygon.densify(MINIMAL_POLYGON_SIDE);
+            if (auto it = m_precomputed_grids.find(layer.lower_layer); it != m_precomputed_grids.end() && po->config().seam_position != spRandom) {
+                out.nozzle_dmr = print.config().nozzle_diameter.get_at(layerm.region().config().perimeter_extruder - 1);
+                out.overhang_penalties.reserve(out.polygon.points.size());
+                for (const Point& pt : out.polygon.points)
+                    out.overhang_penalties.emplace_back(overhang_penalty(pt, out.nozzle_dmr, *it->second));
+            }
+        }
+    });
+    m_precomputed_loops.reserve(loops.size());
+    for (size_t i = 0; i < loops.size(); ++ i)
+        m_precomputed_loops.emplace(loops[i].first, std::move(precomputed[i]));
+}
+
+
+
+std::shared_ptr<const EdgeGrid::Grid> SeamPlacer::lower_layer_edge_grid(const Layer& layer) const
+{
+    assert(layer.lower_layer != nullptr);
+    if (auto it = m_precomputed_grids.find(layer.lower_layer); it != m_precomputed_grids.end())
+        return it->second;
+    return calculate_layer_edge_grid(*layer.lower_layer);
+}
+
+
+
 void SeamPlacer::plan_perimeters(const std::vector<const ExtrusionEntity*> perimeters,
                             const Layer& layer, SeamPosition seam_position,
                             Point last_pos, coordf_t nozzle_dmr, const PrintObject* po,
@@ -449,9 +564,14 @@ Point SeamPlacer::calculate_seam(const Layer& layer, const SeamPosition seam_pos
                const EdgeGrid::Grid* lower_layer_edge_grid, Point last_pos)
 {
     assert(loop.role() == erExternalPerimeter);
-    Polygon polygon = loop.polygon();
-    bool was_clockwise = polygon.make_counter_clockwise();
-    BoundingBox polygon_bb = polygon.bounding_box();
+    // Use the loop prepared by precompute_layers() if it was calculated for the same nozzle and the same layer below.
+    const PrecomputedLoop* precomputed = nullptr;
+    if (auto it = m_precomputed_loops.find(&loop); it != m_precomputed_loops.end() &&
+        (lower_layer_edge_grid == nullptr || (! it->second.overhang_penalties.empty() && it->second.nozzle_dmr == nozzle_dmr)))
+        precomputed = &it->second;
+    Polygon polygon = precomputed ? precomputed->polygon : loop.polygon();
+    bool was_clockwise = precomputed ? precomputed->was_clockwise : polygon.make_counter_clockwise();
+    BoundingBox polygon_bb = precomputed ? precomputed->bbox : polygon.bounding_box();
     const coord_t  nozzle_r   = coord_t(scale_(0.5 * nozzle_dmr) + 0.5);
 
     size_t po_idx = std::find(m_po_list.begin(), m_po_list.end(), po) - m_po_list.begin();
@@ -475,7 +595,7 @@ Point SeamPlacer::calculate_seam(const Layer& layer, const SeamPosition seam_pos
 
     assert(layer_idx < po->layer_count());
 
-    if (this->is_custom_seam_on_layer(layer_idx, po_idx)) {
+    if (! precomputed && this->is_custom_seam_on_layer(layer_idx, po_idx)) {
         // Seam enf/blockers can begin and end in between the original vertices.
         // Let add extra points in between and update the leghths.
         polygon.densify(MINIMAL_POLYGON_SIDE);
@@ -506,9 +626,12 @@ Point SeamPlacer::calculate_seam(const Layer& layer, const SeamPosition seam_pos
 
         // Insert a projection of last_pos into the polygon.
         size_t last_pos_proj_idx;
+        bool   last_pos_proj_inserted;
         {
+            size_t num_points = polygon.points.size();
             auto it = project_point_to_polygon_and_insert(polygon, last_pos, 0.1 * nozzle_r);
             last_pos_proj_idx = it - polygon.points.begin();
+            last_pos_proj_inserted = polygon.points.size() != num_points;
         }
 
         // Parametrize the polygon by its length.
@@ -520,7 +643,6 @@ Point SeamPlacer::calculate_seam(const Layer& layer, const SeamPosition seam_pos
         // No penalty for reflex points, slight penalty for convex points, high penalty for flat surfaces.
         const float penaltyConvexVertex = 1.f;
         const float penaltyFlatSurface  = 5.f;
-        const float penaltyOverhangHalf = 10.f;
         // Penalty for visible seams.
        for (size_t i = 0; i < polygon.points.size(); ++ i) {
             float ccwAngle = penalties[i];
@@ -552,20 +674,12 @@ Point SeamPlacer::calculate_seam(const Layer& layer, const SeamPosition seam_pos
 
         // Penalty for overhangs.
         if (lower_layer_edge_grid) {
-            // Use the edge grid distance field structure over the lower layer to calculate overhangs.
-            coord_t nozzle_r = coord_t(std::floor(scale_(0.5 * nozzle_dmr) + 0.5));
-            coord_t search_r = coord_t(std::floor(scale_(0.8 * nozzle_dmr) + 0.5));
             for (size_t i = 0; i < polygon.points.size(); ++ i) {
-                const Point &p = polygon.points[i];
-                coordf_t dist;
-                // Signed distance is positive outside the object, negative inside the object.
-                // The point is considered at an overhang, if it is more than nozzle radius
-                // outside of the lower layer contour.
-                [[maybe_unused]] bool found = lower_layer_edge_grid->signed_distance(p, search_r, dist);
-                // If the approximate Signed Distance Field was initialized over lower_layer_edge_grid,
-                // then the signed distnace shall always be known.
-                assert(found);
-                penalties[i] += extrudate_overlap_penalty(float(nozzle_r), penaltyOverhangHalf, float(dist));
+                if (! precomputed || (last_pos_proj_inserted && i == last_pos_proj_idx))
+                    penalties[i] += overhang_penalty(polygon.points[i], nozzle_dmr, *lower_layer_edge_grid);
+                else
+                    // Penalties of the points following the inserted projection of last_pos are shifted by one.
+                    penalties[i] += precomputed->overhang_penalties[(last_pos_proj_inserted && i > last_pos_proj_idx) ? i - 1 : i];
             }
         }
 
@@ -1,7 +1,9 @@
 #ifndef libslic3r_SeamPlacer_hpp_
 #define libslic3r_SeamPlacer_hpp_
 
+#include <memory>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "libslic3r/ExtrusionEntity.hpp"
@@ -55,7 +57,18 @@ public:
 
     void place_seam(ExtrusionLoop& loop, const Point& last_pos, bool external_first, double nozzle_diameter,
                     const EdgeGrid::Grid* lower_layer_edge_grid);
-    
+
+    // Precompute the distance fields of the layers below the passed layers and the parts of the seam penalties
+    // of their external perimeters, which do not depend on the nozzle position or on the seams of the layer below.
+    // The layers are processed in parallel, the seams are then placed serially by plan_perimeters() / place_seam().
+    // Data precomputed by the previous call are released.
+    void precompute_layers(const Print& print, const std::vector<const Layer*>& layers);
+    void clear_precomputed() { m_precomputed_grids.clear(); m_precomputed_loops.clear(); }
+
+    // Distance field of the layer below the passed layer, used for the overhang penalties.
+    // Returns the precomputed one if available, otherwise calculates it.
+    std::shared_ptr<const EdgeGrid::Grid> lower_layer_edge_grid(const Layer& layer) const;
+
 
     using TreeType = AABBTreeIndirect::Tree<2, coord_t>;
     using AlignedBoxType = Eigen::AlignedBox<TreeType::CoordType, TreeType::NumDimensions>;
@@ -72,6 +85,18 @@ private:
         TreeType tree;
     };
 
+    // External perimeter loop as seen by calculate_seam() before the nozzle position is projected onto it.
+    struct PrecomputedLoop {
+        // Counter clockwise polygon of the loop, densified if there are custom seams on the layer.
+        Polygon polygon;
+        bool was_clockwise = false;
+        BoundingBox bbox;
+        // Nozzle diameter the overhang penalties were calculated for.
+        coordf_t nozzle_dmr = 0.;
+        // Overhang penalty of each point of the polygon, empty if there is no layer below.
+        std::vector<float> overhang_penalties;
+    };
+
     // Just a cache to save some lookups.
     const Layer* m_last_layer_po = nullptr;
     coordf_t m_last_print_z = -1.;
@@ -95,6 +120,10 @@ private:
     //std::map<const PrintObject*, Point>  m_last_seam_position;
     SeamHistory  m_seam_history;
 
+    // Filled in by precompute_layers(), keyed by the layer below / by the original loop.
+    std::unordered_map<const Layer*, std::shared_ptr<const EdgeGrid::Grid>> m_precomputed_grids;
+    std::unordered_map<const ExtrusionLoop*, PrecomputedLoop>               m_precomputed_loops;
+
     // Get indices of points inside enforcers and blockers.
     void get_enforcers_and_blockers(size_t layer_id,
                                     const Polygon& polygon,
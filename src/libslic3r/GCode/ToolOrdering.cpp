@@ -14,6 +14,10 @@
 #include <cassert>
 #include <limits>
 
+#include <boost/log/trivial.hpp>
+
+#include <tbb/parallel_for.h>
+
 #include <libslic3r.h>
 
 
@@ -84,6 +88,20 @@ static double calc_max_layer_height(const PrintConfig &config, double max_object
     return std::max(max_layer_height, max_object_layer_height);
 }
 
+// Use the extruder switches from Model::custom_gcode_per_print_z to override the extruder to print the object.
+// Do it only if all the objects were configured to be printed with a single extruder.
+static std::vector<std::pair<double, unsigned int>> per_layer_extruder_switches(const Print &print)
+{
+	if (auto num_extruders = unsigned(print.config().nozzle_diameter.size());
+		num_extruders > 1 && print.object_extruders().size() == 1 && // the current Print's configuration is CustomGCode::MultiAsSingle
+		print.model().custom_gcode_per_print_z.mode == CustomGCode::MultiAsSingle) {
+		// Printing a single extruder platter on a printer with more than 1 extruder (or single-extruder multi-material).
+		// There may be custom per-layer tool changes available at the model.
+		return custom_tool_changes(print.model().custom_gcode_per_print_z, num_extruders);
+	}
+	return {};
+}
+
 // For the use case when each object is printed separately
 // (print.config().complete_objects is true).
 ToolOrdering::ToolOrdering(const PrintObject &object, unsigned int first_extruder, bool prime_multi_material)
@@ -147,20 +165,11 @@ ToolOrdering::ToolOrdering(const Print &print, unsigned int first_extruder, bool
     }
     max_layer_height = calc_max_layer_height(print.config(), max_layer_height);
 
-	// Use the extruder switches from Model::custom_gcode_per_print_z to override the extruder to print the object.
-	// Do it only if all the objects were configured to be printed with a single extruder.
-	std::vector<std::pair<double, unsigned int>> per_layer_extruder_switches;
-	if (auto num_extruders = unsigned(print.config().nozzle_diameter.size());
-		num_extruders > 1 && print.object_extruders().size() == 1 && // the current Print's configuration is CustomGCode::MultiAsSingle
-		print.model().custom_gcode_per_print_z.mode == CustomGCode::MultiAsSingle) {
-		// Printing a single extruder platter on a printer with more than 1 extruder (or single-extruder multi-material).
-		// There may be custom per-layer tool changes available at the model.
-		per_layer_extruder_switches = custom_tool_changes(print.model().custom_gcode_per_print_z, num_extruders);
-	}
+	std::vector<std::pair<double, unsigned int>> extruder_switches = per_layer_extruder_switches(print);
 
     // Collect extruders reuqired to print the layers.
     for (auto object : print.objects())
-        this->collect_extruders(*object, per_layer_extruder_switches);
+        this->collect_extruders(*object, extruder_switches);
 
     // Reorder the extruders to minimize tool switches.
     this->reorder_extruders(first_extruder);
@@ -206,73 +215,74 @@ void ToolOrdering::collect_extruders(const PrintObject &object, const std::vecto
             layer_tools.has_support = true;
     }
 
-    // Extruder overrides are ordered by print_z.
-    std::vector<std::pair<double, unsigned int>>::const_iterator it_per_layer_extruder_override;
-	it_per_layer_extruder_override = per_layer_extruder_switches.begin();
-    unsigned int extruder_override = 0;
-
     // Collect the object extruders.
-    for (auto layer : object.layers()) {
-        LayerTools &layer_tools = this->tools_for_layer(layer->print_z);
-
-        // Override extruder with the next 
-    	for (; it_per_layer_extruder_override != per_layer_extruder_switches.end() && it_per_layer_extruder_override->first < layer->print_z + EPSILON; ++ it_per_layer_extruder_override)
-    		extruder_override = (int)it_per_layer_extruder_override->second;
-
-        // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
-        layer_tools.extruder_override = extruder_override;
-
-        // What extruders are required to print this object layer?
-        for (const LayerRegion *layerm : layer->regions()) {
-            const PrintRegion &region = layerm->region();
-
-            if (! layerm->perimeters.entities.empty()) {
-                bool something_nonoverriddable = true;
+    // Layers of a single object are assigned distinct LayerTools, thus the object layers are processed in parallel.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, object.layers().size()),
+        [this, &object, &per_layer_extruder_switches](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                const Layer *layer       = object.layers()[layer_idx];
+                LayerTools  &layer_tools = this->tools_for_layer(layer->print_z);
+
+                // Extruder overrides are ordered by print_z. Override extruder with the last one starting below this layer.
+                auto it_per_layer_extruder_override = std::lower_bound(per_layer_extruder_switches.begin(), per_layer_extruder_switches.end(), layer->print_z + EPSILON,
+                    [](const std::pair<double, unsigned int> &extruder_switch, double print_z) { return extruder_switch.first < print_z; });
+                unsigned int extruder_override = it_per_layer_extruder_override == per_layer_extruder_switches.begin() ? 0 : std::prev(it_per_layer_extruder_override)->second;
+
+                // Store the current extruder override (set to zero if no overriden), so that layer_tools.wiping_extrusions().is_overridable_and_mark() will use it.
+                layer_tools.extruder_override = extruder_override;
+
+                // What extruders are required to print this object layer?
+                for (const LayerRegion *layerm : layer->regions()) {
+                    const PrintRegion &region = layerm->region();
+
+                    if (! layerm->perimeters.entities.empty()) {
+                        bool something_nonoverriddable = true;
+
+                        if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
+                            something_nonoverriddable = false;
+                            for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
+                                if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
+                                    something_nonoverriddable = true;
+                        }
 
-                if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
-                    something_nonoverriddable = false;
-                    for (const auto& eec : layerm->perimeters.entities) // let's check if there are nonoverriddable entities
-                        if (!layer_tools.wiping_extrusions().is_overriddable_and_mark(dynamic_cast<const ExtrusionEntityCollection&>(*eec), *m_print_config_ptr, object, region))
-                            something_nonoverriddable = true;
-                }
+                        if (something_nonoverriddable)
+                       		layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().perimeter_extruder.value : extruder_override);
 
-                if (something_nonoverriddable)
-               		layer_tools.extruders.emplace_back((extruder_override == 0) ? region.config().perimeter_extruder.value : extruder_override);
+                        layer_tools.has_object = true;
+                    }
 
-                layer_tools.has_object = true;
-            }
+                    bool has_infill       = false;
+                    bool has_solid_infill = false;
+                    bool something_nonoverriddable = false;
+                    for (const ExtrusionEntity *ee : layerm->fills.entities) {
+                        // fill represents infill extrusions of a single island.
+                        const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                        ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
+                        if (is_solid_infill(role))
+                            has_solid_infill = true;
+                        else if (role != erNone)
+                            has_infill = true;
+
+                        if (m_print_config_ptr) {
+                            if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
+                                something_nonoverriddable = true;
+                        }
+                    }
 
-            bool has_infill       = false;
-            bool has_solid_infill = false;
-            bool something_nonoverriddable = false;
-            for (const ExtrusionEntity *ee : layerm->fills.entities) {
-                // fill represents infill extrusions of a single island.
-                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                ExtrusionRole role = fill->entities.empty() ? erNone : fill->entities.front()->role();
-                if (is_solid_infill(role))
-                    has_solid_infill = true;
-                else if (role != erNone)
-                    has_infill = true;
-
-                if (m_print_config_ptr) {
-                    if (! layer_tools.wiping_extrusions().is_overriddable_and_mark(*fill, *m_print_config_ptr, object, region))
-                        something_nonoverriddable = true;
+                    if (something_nonoverriddable || !m_print_config_ptr) {
+                    	if (extruder_override == 0) {
+        	                if (has_solid_infill)
+        	                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
+        	                if (has_infill)
+        	                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
+                    	} else if (has_solid_infill || has_infill)
+                    		layer_tools.extruders.emplace_back(extruder_override);
+                    }
+                    if (has_solid_infill || has_infill)
+                        layer_tools.has_object = true;
                 }
             }
-
-            if (something_nonoverriddable || !m_print_config_ptr) {
-            	if (extruder_override == 0) {
-	                if (has_solid_infill)
-	                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
-	                if (has_infill)
-	                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
-            	} else if (has_solid_infill || has_infill)
-            		layer_tools.extruders.emplace_back(extruder_override);
-            }
-            if (has_solid_infill || has_infill)
-                layer_tools.has_object = true;
-        }
-    }
+        });
 
     for (auto& layer : m_layer_tools) {
         // Sort and remove duplicates
@@ -579,6 +589,44 @@ void ToolOrdering::assign_custom_gcodes(const Print &print)
 	}
 }
 
+const ToolOrdering& ToolOrderingCache::tool_ordering(const Print &print, unsigned int first_extruder, bool prime_multi_material)
+{
+    std::string key = make_key(print, first_extruder, prime_multi_material);
+    if (key != m_key || m_tool_ordering.empty()) {
+        m_tool_ordering = ToolOrdering(print, first_extruder, prime_multi_material);
+        m_key = std::move(key);
+    } else
+        BOOST_LOG_TRIVIAL(debug) << "Reusing the cached tool ordering";
+    return m_tool_ordering;
+}
+
+std::string ToolOrderingCache::make_key(const Print &print, unsigned int first_extruder, bool prime_multi_material)
+{
+    std::string key = std::to_string(first_extruder) + (prime_multi_material ? "P" : "-");
+    for (const char *opt_key : { "nozzle_diameter", "max_layer_height", "filament_soluble", "wipe_tower", "complete_objects" })
+        (key += ';') += print.config().opt_serialize(opt_key);
+    for (const std::pair<double, unsigned int> &extruder_switch : per_layer_extruder_switches(print)) {
+        // Compare the print_z of the switch exactly.
+        (key += ';').append(reinterpret_cast<const char*>(&extruder_switch.first), sizeof(double));
+        key += ":" + std::to_string(extruder_switch.second);
+    }
+    for (const PrintObject *object : print.objects()) {
+        // The layers and their extrusions are only modified by the PrintObject steps, each finished step is assigned a new unique timestamp.
+        // The wipe tower may insert empty support layers, thus the layer counts are compared as well.
+        key += "|" + std::to_string(uintptr_t(object)) + ":" + std::to_string(object->layers().size()) + ":" + std::to_string(object->support_layers().size());
+        for (int step = 0; step < int(posCount); ++ step) {
+            PrintStateBase::StateWithTimeStamp state = object->step_state_with_timestamp(PrintObjectStep(step));
+            key += ":" + std::to_string(int(state.state)) + "@" + std::to_string(state.timestamp);
+        }
+        for (const char *opt_key : { "layer_height", "support_material_extruder", "support_material_interface_extruder", "wipe_into_objects" })
+            (key += ';') += object->config().opt_serialize(opt_key);
+        for (size_t region_id = 0; region_id < object->num_printing_regions(); ++ region_id)
+            for (const char *opt_key : { "perimeter_extruder", "infill_extruder", "solid_infill_extruder", "wipe_into_infill" })
+                (key += ';') += object->printing_region(region_id).config().opt_serialize(opt_key);
+    }
+    return key;
+}
+
 const LayerTools& ToolOrdering::tools_for_layer(coordf_t print_z) const
 {
     auto it_layer_tools = std::lower_bound(m_layer_tools.begin(), m_layer_tools.end(), LayerTools(print_z - EPSILON));
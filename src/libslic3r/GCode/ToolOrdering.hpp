@@ -180,6 +180,25 @@ private:
     const PrintConfig*         m_print_config_ptr = nullptr;
 };
 
+// Keeps the last ToolOrdering calculated for a Print with all objects printed at once (print.config().complete_objects is false).
+// psWipeTower is invalidated by many parameters, which do not influence the tool ordering (for example the temperatures),
+// thus the cached ToolOrdering is reused as long as the object layers and the parameters the ordering is calculated from do not change.
+// The ToolOrdering is cached before the wipe tower marks the wiping extrusions.
+class ToolOrderingCache
+{
+public:
+    // Returns the cached ToolOrdering if still valid, otherwise calculates a new one and caches it.
+    const ToolOrdering& tool_ordering(const Print &print, unsigned int first_extruder, bool prime_multi_material);
+    void                clear() { m_key.clear(); m_tool_ordering.clear(); }
+
+private:
+    // Serialize all the inputs of ToolOrdering(const Print&, ...) into a string to be compared.
+    static std::string  make_key(const Print &print, unsigned int first_extruder, bool prime_multi_material);
+
+    std::string                m_key;
+    ToolOrdering               m_tool_ordering;
+};
+
 } // namespace SLic3r
 
 #endif /* slic3r_ToolOrdering_hpp_ */
@@ -7,6 +7,8 @@
 #include <sstream>
 #include <iomanip>
 
+#include <tbb/parallel_for.h>
+
 #include "GCodeProcessor.hpp"
 #include "BoundingBox.hpp"
 #include "LocalesUtils.hpp"
@@ -18,7 +20,9 @@ namespace Slic3r
 class WipeTowerWriter
 {
 public:
-	WipeTowerWriter(float layer_height, float line_width, GCodeFlavor flavor, const std::vector<WipeTower::FilamentParameters>& filament_parameters) :
+	// If emit_gcode is false, only the geometry of the moves, extrusions and the consumed filament are tracked,
+	// no G-code is generated. This is used to lay out the tower and to replay the state of the tower generator.
+	WipeTowerWriter(float layer_height, float line_width, GCodeFlavor flavor, const std::vector<WipeTower::FilamentParameters>& filament_parameters, bool emit_gcode = true) :
 		m_current_pos(std::numeric_limits<float>::max(), std::numeric_limits<float>::max()),
 		m_current_z(0.f),
 		m_current_feedrate(0.f),
@@ -30,8 +34,11 @@ public:
         m_default_analyzer_line_width(line_width),
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
         m_gcode_flavor(flavor),
-        m_filpar(filament_parameters)
+        m_filpar(filament_parameters),
+        m_emit_gcode(emit_gcode)
         {
+            if (! m_emit_gcode)
+                return;
             // adds tag for analyzer:
             std::ostringstream str;
             str << ";" << GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Height) << m_layer_height << "\n"; // don't rely on GCodeAnalyzer knowing the layer height - it knows nothing at priming
@@ -41,6 +48,8 @@ public:
     }
 
     WipeTowerWriter& change_analyzer_line_width(float line_width) {
+        if (! m_emit_gcode)
+            return *this;
         // adds tag for analyzer:
         std::stringstream str;
         str << ";" << GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Width) << line_width << "\n";
@@ -50,6 +59,8 @@ public:
 
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     WipeTowerWriter& change_analyzer_mm3_per_mm(float len, float e) {
+        if (! m_emit_gcode)
+            return *this;
         static const float area = float(M_PI) * 1.75f * 1.75f / 4.f;
         float mm3_per_mm = (len == 0.f ? 0.f : area * e / len);
         // adds tag for processor:
@@ -84,7 +95,8 @@ public:
     }
 
     WipeTowerWriter&            disable_linear_advance() {
-        m_gcode += (m_gcode_flavor == gcfRepRapSprinter || m_gcode_flavor == gcfRepRapFirmware
+        if (m_emit_gcode)
+            m_gcode += (m_gcode_flavor == gcfRepRapSprinter || m_gcode_flavor == gcfRepRapFirmware
                         ? (std::string("M572 D") + std::to_string(m_current_tool) + " S0\n")
                         : std::string("M900 K0\n"));
         return *this;
@@ -104,7 +116,8 @@ public:
 	WipeTowerWriter& 			 feedrate(float f)
 	{
         if (f != m_current_feedrate) {
-			m_gcode += "G1" + set_format_F(f) + "\n";
+            if (m_emit_gcode)
+                m_gcode += "G1" + set_format_F(f) + "\n";
             m_current_feedrate = f;
         }
 		return *this;
@@ -151,23 +164,25 @@ public:
 			m_extrusions.emplace_back(WipeTower::Extrusion(rot, width, m_current_tool));
 		}
 
-		m_gcode += "G1";
-        if (std::abs(rot.x() - rotated_current_pos.x()) > (float)EPSILON)
-			m_gcode += set_format_X(rot.x());
+		if (m_emit_gcode) {
+			m_gcode += "G1";
+			if (std::abs(rot.x() - rotated_current_pos.x()) > (float)EPSILON)
+				m_gcode += set_format_X(rot.x());
 
-        if (std::abs(rot.y() - rotated_current_pos.y()) > (float)EPSILON)
-			m_gcode += set_format_Y(rot.y());
+			if (std::abs(rot.y() - rotated_current_pos.y()) > (float)EPSILON)
+				m_gcode += set_format_Y(rot.y());
 
 
-		if (e != 0.f)
-			m_gcode += set_format_E(e);
+			if (e != 0.f)
+				m_gcode += set_format_E(e);
+		}
 
 		if (f != 0.f && f != m_current_feedrate) {
             if (limit_volumetric_flow) {
                 float e_speed = e / (((len == 0.f) ? std::abs(e) : len) / f * 60.f);
                 f /= std::max(1.f, e_speed / m_filpar[m_current_tool].max_e_speed);
             }
-			m_gcode += set_format_F(f);
+			this->format_F(f);
         }
 
         m_current_pos.x() = x;
@@ -175,7 +190,8 @@ public:
 
 		// Update the elapsed time with a rough estimate.
         m_elapsed_time += ((len == 0.f) ? std::abs(e) : len) / m_current_feedrate * 60.f;
-		m_gcode += "\n";
+		if (m_emit_gcode)
+			m_gcode += "\n";
 		return *this;
 	}
 
@@ -237,12 +253,15 @@ public:
 	{
 		if (e == 0.f && (f == 0.f || f == m_current_feedrate))
 			return *this;
-		m_gcode += "G1";
-		if (e != 0.f)
-			m_gcode += set_format_E(e);
+		if (m_emit_gcode) {
+			m_gcode += "G1";
+			if (e != 0.f)
+				m_gcode += set_format_E(e);
+		}
 		if (f != 0.f && f != m_current_feedrate)
-			m_gcode += set_format_F(f);
-		m_gcode += "\n";
+			this->format_F(f);
+		if (m_emit_gcode)
+			m_gcode += "\n";
 		return *this;
 	}
 
@@ -269,10 +288,12 @@ public:
 	// Elevate the extruder head above the current print_z position.
 	WipeTowerWriter& z_hop(float hop, float f = 0.f)
 	{ 
-		m_gcode += std::string("G1") + set_format_Z(m_current_z + hop);
+		if (m_emit_gcode)
+			m_gcode += std::string("G1") + set_format_Z(m_current_z + hop);
 		if (f != 0 && f != m_current_feedrate)
-			m_gcode += set_format_F(f);
-		m_gcode += "\n";
+			this->format_F(f);
+		if (m_emit_gcode)
+			m_gcode += "\n";
 		return *this;
 	}
 
@@ -308,14 +329,15 @@ public:
 	// Set extruder temperature, don't wait by default.
 	WipeTowerWriter& set_extruder_temp(int temperature, bool wait = false)
 	{
-        m_gcode += "M" + std::to_string(wait ? 109 : 104) + " S" + std::to_string(temperature) + "\n";
+        if (m_emit_gcode)
+            m_gcode += "M" + std::to_string(wait ? 109 : 104) + " S" + std::to_string(temperature) + "\n";
         return *this;
     }
 
     // Wait for a period of time (seconds).
 	WipeTowerWriter& wait(float time)
 	{
-        if (time==0.f)
+        if (time==0.f || ! m_emit_gcode)
             return *this;
         m_gcode += "G4 S" + Slic3r::float_to_string_decimal_point(time, 3) + "\n";
 		return *this;
@@ -324,7 +346,8 @@ public:
 	// Set speed factor override percentage.
 	WipeTowerWriter& speed_override(int speed)
 	{
-        m_gcode += "M220 S" + std::to_string(speed) + "\n";
+        if (m_emit_gcode)
+            m_gcode += "M220 S" + std::to_string(speed) + "\n";
 		return *this;
     }
 
@@ -332,7 +355,7 @@ public:
 	WipeTowerWriter& speed_override_backup()
     {
         // This is only supported by Prusa at this point (https://github.com/prusa3d/PrusaSlicer/issues/3114)
-        if (m_gcode_flavor == gcfMarlinLegacy || m_gcode_flavor == gcfMarlinFirmware)
+        if (m_emit_gcode && (m_gcode_flavor == gcfMarlinLegacy || m_gcode_flavor == gcfMarlinFirmware))
             m_gcode += "M220 B\n";
 		return *this;
     }
@@ -340,7 +363,7 @@ public:
 	// Let the firmware restore the active speed override value.
 	WipeTowerWriter& speed_override_restore()
 	{
-        if (m_gcode_flavor == gcfMarlinLegacy || m_gcode_flavor == gcfMarlinFirmware)
+        if (m_emit_gcode && (m_gcode_flavor == gcfMarlinLegacy || m_gcode_flavor == gcfMarlinFirmware))
             m_gcode += "M220 R\n";
 		return *this;
     }
@@ -348,6 +371,8 @@ public:
 	// Set digital trimpot motor
 	WipeTowerWriter& set_extruder_trimpot(int current)
 	{
+        if (! m_emit_gcode)
+            return *this;
         if (m_gcode_flavor == gcfRepRapSprinter || m_gcode_flavor == gcfRepRapFirmware)
             m_gcode += "M906 E";
         else
@@ -358,20 +383,23 @@ public:
 
 	WipeTowerWriter& flush_planner_queue()
 	{ 
-		m_gcode += "G4 S0\n"; 
+		if (m_emit_gcode)
+			m_gcode += "G4 S0\n"; 
 		return *this;
 	}
 
 	// Reset internal extruder counter.
 	WipeTowerWriter& reset_extruder()
 	{ 
-		m_gcode += "G92 E0\n";
+		if (m_emit_gcode)
+			m_gcode += "G92 E0\n";
 		return *this;
 	}
 
 	WipeTowerWriter& comment_with_value(const char *comment, int value)
     {
-        m_gcode += std::string(";") + comment + std::to_string(value) + "\n";
+        if (m_emit_gcode)
+            m_gcode += std::string(";") + comment + std::to_string(value) + "\n";
 		return *this;
     }
 
@@ -380,15 +408,17 @@ public:
 	{
 		if (speed == m_last_fan_speed)
 			return *this;
-		if (speed == 0)
-			m_gcode += "M107\n";
-        else
-            m_gcode += "M106 S" + std::to_string(unsigned(255.0 * speed / 100.0)) + "\n";
+		if (m_emit_gcode) {
+			if (speed == 0)
+				m_gcode += "M107\n";
+			else
+				m_gcode += "M106 S" + std::to_string(unsigned(255.0 * speed / 100.0)) + "\n";
+		}
 		m_last_fan_speed = speed;
 		return *this;
 	}
 
-	WipeTowerWriter& append(const std::string& text) { m_gcode += text; return *this; }
+	WipeTowerWriter& append(const std::string& text) { if (m_emit_gcode) m_gcode += text; return *this; }
 
     const std::vector<Vec2f>& wipe_path() const
     {
@@ -431,6 +461,7 @@ private:
     float         m_used_filament_length = 0.f;
     GCodeFlavor   m_gcode_flavor;
     const std::vector<WipeTower::FilamentParameters>& m_filpar;
+    const bool    m_emit_gcode;
 
 	std::string   set_format_X(float x)
     {
@@ -458,6 +489,14 @@ private:
         return buf;
 	}
 
+	// Emit the feedrate if G-code is being generated, always update the current feedrate.
+	void          format_F(float f) {
+		if (m_emit_gcode)
+			m_gcode += set_format_F(f);
+		else
+			m_current_feedrate = f;
+	}
+
 	WipeTowerWriter& operator=(const WipeTowerWriter &rhs);
 
 	// Rotate the point around center of the wipe tower about given angle (in degrees)
@@ -635,7 +674,7 @@ std::vector<WipeTower::ToolChangeResult> WipeTower::prime(
     for (size_t idx_tool = 0; idx_tool < tools.size(); ++ idx_tool) {
         size_t old_tool = m_current_tool;
 
-        WipeTowerWriter writer(m_layer_height, m_perimeter_width, m_gcode_flavor, m_filpar);
+        WipeTowerWriter writer(m_layer_height, m_perimeter_width, m_gcode_flavor, m_filpar, m_emit_gcode);
         writer.set_extrusion_flow(m_extrusion_flow)
               .set_z(m_z_pos)
               .set_initial_tool(m_current_tool);
@@ -730,7 +769,7 @@ WipeTower::ToolChangeResult WipeTower::tool_change(size_t tool)
         (tool != (unsigned int)(-1) ? wipe_area+m_depth_traversed-0.5f*m_perimeter_width
                                     : m_wipe_tower_depth-m_perimeter_width));
 
-	WipeTowerWriter writer(m_layer_height, m_perimeter_width, m_gcode_flavor, m_filpar);
+	WipeTowerWriter writer(m_layer_height, m_perimeter_width, m_gcode_flavor, m_filpar, m_emit_gcode);
 	writer.set_extrusion_flow(m_extrusion_flow)
 		.set_z(m_z_pos)
 		.set_initial_tool(m_current_tool)
@@ -1061,7 +1100,7 @@ WipeTower::ToolChangeResult WipeTower::finish_layer()
 
     size_t old_tool = m_current_tool;
 
-	WipeTowerWriter writer(m_layer_height, m_perimeter_width, m_gcode_flavor, m_filpar);
+	WipeTowerWriter writer(m_layer_height, m_perimeter_width, m_gcode_flavor, m_filpar, m_emit_gcode);
 	writer.set_extrusion_flow(m_extrusion_flow)
 		.set_z(m_z_pos)
 		.set_initial_tool(m_current_tool)
@@ -1306,19 +1345,159 @@ static WipeTower::ToolChangeResult merge_tcr(WipeTower::ToolChangeResult& first,
 }
 
 
+WipeTower::LayerState WipeTower::layer_state() const
+{
+    LayerState state;
+    state.current_shape     = m_current_shape;
+    state.num_layer_changes = m_num_layer_changes;
+    state.num_tool_changes  = m_num_tool_changes;
+    state.current_tool      = m_current_tool;
+    state.old_temperature   = m_old_temperature;
+    state.left_to_right     = m_left_to_right;
+    state.y_shift           = m_y_shift;
+    state.internal_rotation = m_internal_rotation;
+    return state;
+}
+
+void WipeTower::set_layer_state(const LayerState &state)
+{
+    m_current_shape     = state.current_shape;
+    m_num_layer_changes = state.num_layer_changes;
+    m_num_tool_changes  = state.num_tool_changes;
+    m_current_tool      = state.current_tool;
+    m_old_temperature   = state.old_temperature;
+    m_left_to_right     = state.left_to_right;
+    m_y_shift           = state.y_shift;
+    m_internal_rotation = state.internal_rotation;
+}
+
+std::string WipeTower::layout_key() const
+{
+    std::string key;
+    auto append = [&key](auto value) { key.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    // Parameters affecting the geometry of the tower.
+    append(m_semm);
+    append(m_wipe_tower_width);
+    append(m_wipe_tower_brim_width);
+    append(m_perimeter_width);
+    append(m_bridging);
+    append(m_no_sparse_layers);
+    append(m_adhesion);
+    append(m_first_layer_idx);
+    append(m_extra_spacing);
+    for (const FilamentParameters &filpar : m_filpar) {
+        append(filpar.is_soluble);
+        append(filpar.filament_area);
+        append(filpar.ramming_line_width_multiplicator);
+        append(filpar.ramming_step_multiplicator);
+        append(filpar.ramming_speed.size());
+        for (float speed : filpar.ramming_speed)
+            append(speed);
+    }
+
+    // State of the generator the layout is calculated from.
+    append(m_current_shape);
+    append(m_num_layer_changes);
+    append(m_num_tool_changes);
+    append(m_current_tool);
+    append(m_old_temperature);
+    append(m_left_to_right);
+    append(m_y_shift);
+    append(m_internal_rotation);
+
+    // The planned tool changes.
+    for (const WipeTowerInfo &layer : m_plan) {
+        append(layer.z);
+        append(layer.height);
+        append(layer.depth);
+        append(layer.extra_spacing);
+        append(layer.tool_changes.size());
+        for (const WipeTowerInfo::ToolChange &tch : layer.tool_changes) {
+            append(tch.old_tool);
+            append(tch.new_tool);
+            append(tch.required_depth);
+            append(tch.ramming_depth);
+            append(tch.first_wipe_line);
+            append(tch.wipe_volume);
+        }
+    }
+    return key;
+}
+
+std::vector<WipeTower::ToolChangeResult> WipeTower::generate_layer(const WipeTowerInfo &layer)
+{
+    std::vector<WipeTower::ToolChangeResult> layer_result;
+
+    set_layer(layer.z, layer.height, 0, false/*layer.z == m_plan.front().z*/, layer.z == m_plan.back().z);
+    m_internal_rotation += 180.f;
+
+    if (m_layer_info->depth < m_wipe_tower_depth - m_perimeter_width)
+        m_y_shift = (m_wipe_tower_depth-m_layer_info->depth-m_perimeter_width)/2.f;
+
+    int idx = first_toolchange_to_nonsoluble(layer.tool_changes);
+    ToolChangeResult finish_layer_tcr;
+
+    if (idx == -1) {
+        // if there is no toolchange switching to non-soluble, finish layer
+        // will be called at the very beginning. That's the last possibility
+        // where a nonsoluble tool can be.
+        finish_layer_tcr = finish_layer();
+    }
+
+    for (int i=0; i<int(layer.tool_changes.size()); ++i) {
+        layer_result.emplace_back(tool_change(layer.tool_changes[i].new_tool));
+        if (i == idx) // finish_layer will be called after this toolchange
+            finish_layer_tcr = finish_layer();
+    }
+
+    if (layer_result.empty()) {
+        // there is nothing to merge finish_layer with
+        layer_result.emplace_back(std::move(finish_layer_tcr));
+    }
+    else {
+        if (idx == -1)
+            layer_result[0] = merge_tcr(finish_layer_tcr, layer_result[0]);
+        else
+            layer_result[idx] = merge_tcr(layer_result[idx], finish_layer_tcr);
+    }
+
+    return layer_result;
+}
+
 // Processes vector m_plan and calls respective functions to generate G-code for the wipe tower
 // Resulting ToolChangeResults are appended into vector "result"
-void WipeTower::generate(std::vector<std::vector<WipeTower::ToolChangeResult>> &result)
+void WipeTower::generate(std::vector<std::vector<WipeTower::ToolChangeResult>> &result, LayoutCache *layout_cache, bool parallel)
 {
 	if (m_plan.empty())
         return;
 
     m_extra_spacing = 1.f;
 
-	plan_tower();
-    for (int i=0;i<5;++i) {
-        save_on_last_wipe();
+    // The layout passes and the replay below only need the geometry of the tool changes, not their G-code.
+    m_emit_gcode = false;
+
+    std::string layout_key = layout_cache ? this->layout_key() : std::string();
+    if (layout_cache && ! layout_cache->m_key.empty() && layout_cache->m_key == layout_key) {
+        // None of the parameters affecting the geometry of the tower changed, reuse the layout.
+        m_plan                       = layout_cache->m_plan;
+        m_wipe_tower_depth           = layout_cache->m_wipe_tower_depth;
+        m_wipe_tower_brim_width_real = layout_cache->m_wipe_tower_brim_width_real;
+        this->set_layer_state(layout_cache->m_state);
+    } else {
         plan_tower();
+        for (int i=0;i<5;++i) {
+            save_on_last_wipe();
+            plan_tower();
+        }
+        if (layout_cache) {
+            layout_cache->m_key                        = std::move(layout_key);
+            layout_cache->m_plan                       = m_plan;
+            layout_cache->m_wipe_tower_depth           = m_wipe_tower_depth;
+            layout_cache->m_wipe_tower_brim_width_real = m_wipe_tower_brim_width_real;
+            layout_cache->m_state                      = this->layer_state();
+            ++ layout_cache->m_num_layouts;
+        }
     }
 
     m_layer_info = m_plan.begin();
@@ -1336,44 +1515,36 @@ void WipeTower::generate(std::vector<std::vector<WipeTower::ToolChangeResult>> &
 
     m_old_temperature = -1; // reset last temperature written in the gcode
 
-    std::vector<WipeTower::ToolChangeResult> layer_result;
-	for (auto layer : m_plan)
-	{
-        set_layer(layer.z, layer.height, 0, false/*layer.z == m_plan.front().z*/, layer.z == m_plan.back().z);
-        m_internal_rotation += 180.f;
-
-        if (m_layer_info->depth < m_wipe_tower_depth - m_perimeter_width)
-			m_y_shift = (m_wipe_tower_depth-m_layer_info->depth-m_perimeter_width)/2.f;
-
-        int idx = first_toolchange_to_nonsoluble(layer.tool_changes);
-        ToolChangeResult finish_layer_tcr;
-
-        if (idx == -1) {
-            // if there is no toolchange switching to non-soluble, finish layer
-            // will be called at the very beginning. That's the last possibility
-            // where a nonsoluble tool can be.
-            finish_layer_tcr = finish_layer();
-        }
-
-        for (int i=0; i<int(layer.tool_changes.size()); ++i) {
-            layer_result.emplace_back(tool_change(layer.tool_changes[i].new_tool));
-            if (i == idx) // finish_layer will be called after this toolchange
-                finish_layer_tcr = finish_layer();
-        }
-
-        if (layer_result.empty()) {
-            // there is nothing to merge finish_layer with
-            layer_result.emplace_back(std::move(finish_layer_tcr));
-        }
-        else {
-            if (idx == -1)
-                layer_result[0] = merge_tcr(finish_layer_tcr, layer_result[0]);
-            else
-                layer_result[idx] = merge_tcr(layer_result[idx], finish_layer_tcr);
-        }
+    if (! parallel) {
+        m_emit_gcode = true;
+        for (const WipeTowerInfo &layer : m_plan)
+            result.emplace_back(this->generate_layer(layer));
+        return;
+    }
 
-		result.emplace_back(std::move(layer_result));
-	}
+    // The layers depend on each other only through a handful of state variables. Replay the layers
+    // without generating G-code to record the state at the start of each layer, which also leaves this
+    // generator in its final state including the used filament statistics.
+    std::vector<LayerState> layer_states;
+    layer_states.reserve(m_plan.size());
+    for (const WipeTowerInfo &layer : m_plan) {
+        layer_states.emplace_back(this->layer_state());
+        this->generate_layer(layer);
+    }
+    m_emit_gcode = true;
+
+    // Generate the G-code of the layers in parallel, each thread working on its own copy of the generator.
+    size_t first_layer_result = result.size();
+    result.resize(first_layer_result + m_plan.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_plan.size()),
+        [this, &layer_states, &result, first_layer_result](const tbb::blocked_range<size_t> &range) {
+            WipeTower wipe_tower(*this);
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                wipe_tower.m_layer_info = wipe_tower.m_plan.begin() + idx;
+                wipe_tower.set_layer_state(layer_states[idx]);
+                result[first_layer_result + idx] = wipe_tower.generate_layer(wipe_tower.m_plan[idx]);
+            }
+        });
 }
 
 } // namespace Slic3r
@@ -21,6 +21,8 @@ enum GCodeFlavor : unsigned char;
 class WipeTower
 {
 public:
+    class LayoutCache;
+
     static const std::string never_skip_tag() { return "_GCODE_WIPE_TOWER_NEVER_SKIP_TAG"; }
 
     struct Extrusion
@@ -135,8 +137,11 @@ public:
 	// to be used before building begins. The entries must be added ordered in z.
     void plan_toolchange(float z_par, float layer_height_par, unsigned int old_tool, unsigned int new_tool, float wipe_volume = 0.f);
 
-	// Iterates through prepared m_plan, generates ToolChangeResults and appends them to "result"
-	void generate(std::vector<std::vector<ToolChangeResult>> &result);
+	// Iterates through prepared m_plan, generates ToolChangeResults and appends them to "result".
+	// If layout_cache is provided, the layout of the tower is reused from a previous call if none
+	// of the parameters affecting the geometry of the tower changed, and the layout is stored there otherwise.
+	// If parallel is false, the layers are generated one after the other by this generator.
+	void generate(std::vector<std::vector<ToolChangeResult>> &result, LayoutCache *layout_cache = nullptr, bool parallel = true);
 
     float get_depth() const { return m_wipe_tower_depth; }
     float get_brim_width() const { return m_wipe_tower_brim_width_real; }
@@ -303,6 +308,22 @@ private:
     bool            m_current_layer_finished = false;
 	bool 			m_left_to_right   = true;
 	float			m_extra_spacing   = 1.f;
+	// If false, the WipeTowerWriter only tracks the geometry and no G-code is generated.
+	bool            m_emit_gcode      = true;
+
+	// State of the wipe tower generator carried over from one layer to the next one.
+	struct LayerState {
+		wipe_shape   current_shape;
+		unsigned int num_layer_changes;
+		unsigned int num_tool_changes;
+		size_t       current_tool;
+		int          old_temperature;
+		bool         left_to_right;
+		float        y_shift;
+		float        internal_rotation;
+	};
+	LayerState layer_state() const;
+	void       set_layer_state(const LayerState &state);
 
     bool is_first_layer() const { return size_t(m_layer_info - m_plan.begin()) == m_first_layer_idx; }
 
@@ -359,6 +380,9 @@ private:
     // Stores information about used filament length per extruder:
     std::vector<float> m_used_filament_length;
 
+    // Generates the tool changes and the sparse infill of a single layer of m_plan.
+    std::vector<ToolChangeResult> generate_layer(const WipeTowerInfo &layer);
+
     // Return index of first toolchange that switches to non-soluble extruder
     // ot -1 if there is no such toolchange.
     int first_toolchange_to_nonsoluble(
@@ -383,6 +407,31 @@ private:
 		WipeTowerWriter &writer,
 		const box_coordinates  &cleaning_box,
 		float wipe_volume);
+
+    // Serializes m_plan and all the parameters and state influencing the layout of the tower calculated by generate().
+    std::string layout_key() const;
+
+public:
+    // Layout of the tower calculated by generate() from the planned tool changes: the depths of the layers
+    // and of the tool changes. The layout does not depend on the temperatures, speeds or on the cooling
+    // and loading moves, thus it does not need to be recalculated if only these parameters change.
+    class LayoutCache
+    {
+    public:
+        void clear() { m_key.clear(); m_plan.clear(); }
+        // Number of layouts calculated and stored by generate().
+        size_t num_layouts() const { return m_num_layouts; }
+
+    private:
+        friend class WipeTower;
+        std::string                 m_key;
+        size_t                      m_num_layouts = 0;
+        std::vector<WipeTowerInfo>  m_plan;
+        float                       m_wipe_tower_depth = 0.f;
+        float                       m_wipe_tower_brim_width_real = 0.f;
+        // State of the generator after the layout was calculated.
+        LayerState                  m_state {};
+    };
 };
 
 
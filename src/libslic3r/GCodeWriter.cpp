@@ -1,5 +1,6 @@
 #include "GCodeWriter.hpp"
 #include "CustomGCode.hpp"
+#include "LocalesUtils.hpp"
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
@@ -152,63 +153,57 @@ std::string GCodeWriter::set_bed_temperature(unsigned int temperature, bool wait
     return gcode.str();
 }
 
-std::string GCodeWriter::set_acceleration(unsigned int acceleration)
+void GCodeWriter::set_acceleration(std::string &out, unsigned int acceleration)
 {
     // Clamp the acceleration to the allowed maximum.
     if (m_max_acceleration > 0 && acceleration > m_max_acceleration)
         acceleration = m_max_acceleration;
 
     if (acceleration == 0 || acceleration == m_last_acceleration)
-        return std::string();
+        return;
     
     m_last_acceleration = acceleration;
     
-    std::ostringstream gcode;
+    const std::string acc = std::to_string(acceleration);
     if (FLAVOR_IS(gcfRepetier)) {
         // M201: Set max printing acceleration
-        gcode << "M201 X" << acceleration << " Y" << acceleration;
-        if (this->config.gcode_comments) gcode << " ; adjust acceleration";
-        gcode << "\n";
+        out += "M201 X"; out += acc; out += " Y"; out += acc;
+        if (this->config.gcode_comments) out += " ; adjust acceleration";
+        out += "\n";
         // M202: Set max travel acceleration
-        gcode << "M202 X" << acceleration << " Y" << acceleration;
+        out += "M202 X"; out += acc; out += " Y"; out += acc;
     } else if (FLAVOR_IS(gcfRepRapFirmware)) {
         // M204: Set default acceleration
-        gcode << "M204 P" << acceleration;
+        out += "M204 P"; out += acc;
     } else if (FLAVOR_IS(gcfMarlinFirmware)) {
         // This is new MarlinFirmware with separated print/retraction/travel acceleration.
         // Use M204 P, we don't want to override travel acc by M204 S (which is deprecated anyway).
-        gcode << "M204 P" << acceleration;
+        out += "M204 P"; out += acc;
     } else {
         // M204: Set default acceleration
-        gcode << "M204 S" << acceleration;
+        out += "M204 S"; out += acc;
     }
-    if (this->config.gcode_comments) gcode << " ; adjust acceleration";
-    gcode << "\n";
-    
-    return gcode.str();
+    if (this->config.gcode_comments) out += " ; adjust acceleration";
+    out += "\n";
 }
 
-std::string GCodeWriter::reset_e(bool force)
+void GCodeWriter::reset_e(std::string &out, bool force)
 {
     if (FLAVOR_IS(gcfMach3)
         || FLAVOR_IS(gcfMakerWare)
         || FLAVOR_IS(gcfSailfish))
-        return "";
+        return;
     
     if (m_extruder != nullptr) {
         if (m_extruder->E() == 0. && ! force)
-            return "";
+            return;
         m_extruder->reset_E();
     }
 
     if (! m_extrusion_axis.empty() && ! this->config.use_relative_e_distances) {
-        std::ostringstream gcode;
-        gcode << "G92 " << m_extrusion_axis << "0";
-        if (this->config.gcode_comments) gcode << " ; reset extrusion distance";
-        gcode << "\n";
-        return gcode.str();
-    } else {
-        return "";
+        out += "G92 "; out += m_extrusion_axis; out += "0";
+        if (this->config.gcode_comments) out += " ; reset extrusion distance";
+        out += "\n";
     }
 }
 
@@ -220,11 +215,10 @@ std::string GCodeWriter::update_progress(unsigned int num, unsigned int tot, boo
     unsigned int percent = (unsigned int)floor(100.0 * num / tot + 0.5);
     if (!allow_100) percent = std::min(percent, (unsigned int)99);
     
-    std::ostringstream gcode;
-    gcode << "M73 P" << percent;
-    if (this->config.gcode_comments) gcode << " ; update progress";
-    gcode << "\n";
-    return gcode.str();
+    std::string gcode = "M73 P" + std::to_string(percent);
+    if (this->config.gcode_comments) gcode += " ; update progress";
+    gcode += "\n";
+    return gcode;
 }
 
 std::string GCodeWriter::toolchange_prefix() const
@@ -233,7 +227,7 @@ std::string GCodeWriter::toolchange_prefix() const
            FLAVOR_IS(gcfSailfish)  ? "M108 T" : "T";
 }
 
-std::string GCodeWriter::toolchange(unsigned int extruder_id)
+void GCodeWriter::toolchange(std::string &out, unsigned int extruder_id)
 {
     // set the new extruder
 	auto it_extruder = Slic3r::lower_bound_by_predicate(m_extruders.begin(), m_extruders.end(), [extruder_id](const Extruder &e) { return e.id() < extruder_id; });
@@ -242,18 +236,17 @@ std::string GCodeWriter::toolchange(unsigned int extruder_id)
 
     // return the toolchange command
     // if we are running a single-extruder setup, just set the extruder and return nothing
-    std::ostringstream gcode;
     if (this->multiple_extruders) {
-        gcode << this->toolchange_prefix() << extruder_id;
+        out += this->toolchange_prefix();
+        out += std::to_string(extruder_id);
         if (this->config.gcode_comments)
-            gcode << " ; change extruder";
-        gcode << "\n";
-        gcode << this->reset_e(true);
+            out += " ; change extruder";
+        out += "\n";
+        this->reset_e(out, true);
     }
-    return gcode.str();
 }
 
-std::string GCodeWriter::set_speed(double F, const std::string &comment, const std::string &cooling_marker) const
+void GCodeWriter::set_speed(std::string &out, double F, const std::string &comment, const std::string &cooling_marker) const
 {
     assert(F > 0.);
     assert(F < 100000.);
@@ -262,10 +255,10 @@ std::string GCodeWriter::set_speed(double F, const std::string &comment, const s
     w.emit_f(F);
     w.emit_comment(this->config.gcode_comments, comment);
     w.emit_string(cooling_marker);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &comment)
+void GCodeWriter::travel_to_xy(std::string &out, const Vec2d &point, const std::string &comment)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -274,7 +267,7 @@ std::string GCodeWriter::travel_to_xy(const Vec2d &point, const std::string &com
     w.emit_xy(point);
     w.emit_f(this->config.travel_speed.value * 60.0);
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &comment)
@@ -310,7 +303,7 @@ std::string GCodeWriter::travel_to_xyz(const Vec3d &point, const std::string &co
     return w.string();
 }
 
-std::string GCodeWriter::travel_to_z(double z, const std::string &comment)
+void GCodeWriter::travel_to_z(std::string &out, double z, const std::string &comment)
 {
     /*  If target Z is lower than current Z but higher than nominal Z
         we don't perform the move but we only adjust the nominal Z by
@@ -320,16 +313,16 @@ std::string GCodeWriter::travel_to_z(double z, const std::string &comment)
         m_lifted -= (z - nominal_z);
         if (std::abs(m_lifted) < EPSILON)
             m_lifted = 0.;
-        return "";
+        return;
     }
     
     /*  In all the other cases, we perform an actual Z move and cancel
         the lift. */
     m_lifted = 0;
-    return this->_travel_to_z(z, comment);
+    this->_travel_to_z(out, z, comment);
 }
 
-std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
+void GCodeWriter::_travel_to_z(std::string &out, double z, const std::string &comment)
 {
     m_pos(2) = z;
 
@@ -341,7 +334,7 @@ std::string GCodeWriter::_travel_to_z(double z, const std::string &comment)
     w.emit_z(z);
     w.emit_f(speed * 60.0);
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
 bool GCodeWriter::will_move_z(double z) const
@@ -356,7 +349,7 @@ bool GCodeWriter::will_move_z(double z) const
     return true;
 }
 
-std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std::string &comment)
+void GCodeWriter::extrude_to_xy(std::string &out, const Vec2d &point, double dE, const std::string &comment)
 {
     m_pos(0) = point(0);
     m_pos(1) = point(1);
@@ -366,10 +359,10 @@ std::string GCodeWriter::extrude_to_xy(const Vec2d &point, double dE, const std:
     w.emit_xy(point);
     w.emit_e(m_extrusion_axis, m_extruder->E());
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment)
+void GCodeWriter::extrude_to_xyz(std::string &out, const Vec3d &point, double dE, const std::string &comment)
 {
     m_pos = point;
     m_lifted = 0;
@@ -379,32 +372,32 @@ std::string GCodeWriter::extrude_to_xyz(const Vec3d &point, double dE, const std
     w.emit_xyz(point);
     w.emit_e(m_extrusion_axis, m_extruder->E());
     w.emit_comment(this->config.gcode_comments, comment);
-    return w.string();
+    w.append_to(out);
 }
 
-std::string GCodeWriter::retract(bool before_wipe)
+void GCodeWriter::retract(std::string &out, bool before_wipe)
 {
     double factor = before_wipe ? m_extruder->retract_before_wipe() : 1.;
     assert(factor >= 0. && factor <= 1. + EPSILON);
-    return this->_retract(
+    this->_retract(out,
         factor * m_extruder->retract_length(),
         factor * m_extruder->retract_restart_extra(),
         "retract"
     );
 }
 
-std::string GCodeWriter::retract_for_toolchange(bool before_wipe)
+void GCodeWriter::retract_for_toolchange(std::string &out, bool before_wipe)
 {
     double factor = before_wipe ? m_extruder->retract_before_wipe() : 1.;
     assert(factor >= 0. && factor <= 1. + EPSILON);
-    return this->_retract(
+    this->_retract(out,
         factor * m_extruder->retract_length_toolchange(),
         factor * m_extruder->retract_restart_extra_toolchange(),
         "retract for toolchange"
     );
 }
 
-std::string GCodeWriter::_retract(double length, double restart_extra, const std::string &comment)
+void GCodeWriter::_retract(std::string &out, double length, double restart_extra, const std::string &comment)
 {
     /*  If firmware retraction is enabled, we use a fake value of 1
         since we ignore the actual configured retract_length which 
@@ -420,54 +413,46 @@ std::string GCodeWriter::_retract(double length, double restart_extra, const std
         restart_extra = restart_extra * area;
     }
     
-
-    std::string gcode;
     if (double dE = m_extruder->retract(length, restart_extra);  dE != 0) {
         if (this->config.use_firmware_retraction) {
-            gcode = FLAVOR_IS(gcfMachinekit) ? "G22 ; retract\n" : "G10 ; retract\n";
+            out += FLAVOR_IS(gcfMachinekit) ? "G22 ; retract\n" : "G10 ; retract\n";
         } else if (! m_extrusion_axis.empty()) {
             GCodeG1Formatter w;
             w.emit_e(m_extrusion_axis, m_extruder->E());
             w.emit_f(m_extruder->retract_speed() * 60.);
             w.emit_comment(this->config.gcode_comments, comment);
-            gcode = w.string();
+            w.append_to(out);
         }
     }
     
     if (FLAVOR_IS(gcfMakerWare))
-        gcode += "M103 ; extruder off\n";
-
-    return gcode;
+        out += "M103 ; extruder off\n";
 }
 
-std::string GCodeWriter::unretract()
+void GCodeWriter::unretract(std::string &out)
 {
-    std::string gcode;
-    
     if (FLAVOR_IS(gcfMakerWare))
-        gcode = "M101 ; extruder on\n";
+        out += "M101 ; extruder on\n";
     
     if (double dE = m_extruder->unretract(); dE != 0) {
         if (this->config.use_firmware_retraction) {
-            gcode += FLAVOR_IS(gcfMachinekit) ? "G23 ; unretract\n" : "G11 ; unretract\n";
-            gcode += this->reset_e();
+            out += FLAVOR_IS(gcfMachinekit) ? "G23 ; unretract\n" : "G11 ; unretract\n";
+            this->reset_e(out);
         } else if (! m_extrusion_axis.empty()) {
             // use G1 instead of G0 because G0 will blend the restart with the previous travel move
             GCodeG1Formatter w;
             w.emit_e(m_extrusion_axis, m_extruder->E());
             w.emit_f(m_extruder->deretract_speed() * 60.);
             w.emit_comment(this->config.gcode_comments, " ; unretract");
-            gcode += w.string();
+            w.append_to(out);
         }
     }
-    
-    return gcode;
 }
 
 /*  If this method is called more than once before calling unlift(),
     it will not perform subsequent lifts, even if Z was raised manually
     (i.e. with travel_to_z()) and thus _lifted was reduced. */
-std::string GCodeWriter::lift()
+void GCodeWriter::lift(std::string &out)
 {
     // check whether the above/below conditions are met
     double target_lift = 0;
@@ -479,53 +464,52 @@ std::string GCodeWriter::lift()
     }
     if (m_lifted == 0 && target_lift > 0) {
         m_lifted = target_lift;
-        return this->_travel_to_z(m_pos(2) + target_lift, "lift Z");
+        this->_travel_to_z(out, m_pos(2) + target_lift, "lift Z");
     }
-    return "";
 }
 
-std::string GCodeWriter::unlift()
+void GCodeWriter::unlift(std::string &out)
 {
-    std::string gcode;
     if (m_lifted > 0) {
-        gcode += this->_travel_to_z(m_pos(2) - m_lifted, "restore layer Z");
+        this->_travel_to_z(out, m_pos(2) - m_lifted, "restore layer Z");
         m_lifted = 0;
     }
-    return gcode;
 }
 
-std::string GCodeWriter::set_fan(const GCodeFlavor gcode_flavor, bool gcode_comments, unsigned int speed)
+void GCodeWriter::set_fan(std::string &out, const GCodeFlavor gcode_flavor, bool gcode_comments, unsigned int speed)
 {
-    std::ostringstream gcode;
     if (speed == 0) {
         switch (gcode_flavor) {
         case gcfTeacup:
-            gcode << "M106 S0"; break;
+            out += "M106 S0"; break;
         case gcfMakerWare:
         case gcfSailfish:
-            gcode << "M127";    break;
+            out += "M127";    break;
         default:
-            gcode << "M107";    break;
+            out += "M107";    break;
         }
         if (gcode_comments)
-            gcode << " ; disable fan";
-        gcode << "\n";
+            out += " ; disable fan";
+        out += "\n";
     } else {
+        // Same formatting as the default formatting of std::ostream.
+        char buf[32];
+        assert(is_decimal_separator_point());
+        sprintf(buf, "%g", 255.0 * speed / 100.0);
         switch (gcode_flavor) {
         case gcfMakerWare:
         case gcfSailfish:
-            gcode << "M126";    break;
+            out += "M126";    break;
         case gcfMach3:
         case gcfMachinekit:
-            gcode << "M106 P" << 255.0 * speed / 100.0; break;
+            out += "M106 P"; out += buf; break;
         default:
-            gcode << "M106 S" << 255.0 * speed / 100.0; break;
+            out += "M106 S"; out += buf; break;
         }
         if (gcode_comments) 
-            gcode << " ; enable fan";
-        gcode << "\n";
+            out += " ; enable fan";
+        out += "\n";
     }
-    return gcode.str();
 }
 
 std::string GCodeWriter::set_fan(unsigned int speed) const
@@ -43,8 +43,10 @@ public:
     std::string postamble() const;
     std::string set_temperature(unsigned int temperature, bool wait = false, int tool = -1) const;
     std::string set_bed_temperature(unsigned int temperature, bool wait = false);
-    std::string set_acceleration(unsigned int acceleration);
-    std::string reset_e(bool force = false);
+    std::string set_acceleration(unsigned int acceleration)
+        { std::string out; this->set_acceleration(out, acceleration); return out; }
+    std::string reset_e(bool force = false)
+        { std::string out; this->reset_e(out, force); return out; }
     std::string update_progress(unsigned int num, unsigned int tot, bool allow_100 = false) const;
     // return false if this extruder was already selected
     bool        need_toolchange(unsigned int extruder_id) const 
@@ -54,23 +56,53 @@ public:
     // Prefix of the toolchange G-code line, to be used by the CoolingBuffer to separate sections of the G-code
     // printed with the same extruder.
     std::string toolchange_prefix() const;
-    std::string toolchange(unsigned int extruder_id);
-    std::string set_speed(double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string()) const;
-    std::string travel_to_xy(const Vec2d &point, const std::string &comment = std::string());
+    std::string toolchange(unsigned int extruder_id)
+        { std::string out; this->toolchange(out, extruder_id); return out; }
+    std::string set_speed(double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string()) const
+        { std::string out; this->set_speed(out, F, comment, cooling_marker); return out; }
+    std::string travel_to_xy(const Vec2d &point, const std::string &comment = std::string())
+        { std::string out; this->travel_to_xy(out, point, comment); return out; }
     std::string travel_to_xyz(const Vec3d &point, const std::string &comment = std::string());
-    std::string travel_to_z(double z, const std::string &comment = std::string());
+    std::string travel_to_z(double z, const std::string &comment = std::string())
+        { std::string out; this->travel_to_z(out, z, comment); return out; }
     bool        will_move_z(double z) const;
-    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string());
-    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string());
-    std::string retract(bool before_wipe = false);
-    std::string retract_for_toolchange(bool before_wipe = false);
-    std::string unretract();
-    std::string lift();
-    std::string unlift();
+    std::string extrude_to_xy(const Vec2d &point, double dE, const std::string &comment = std::string())
+        { std::string out; this->extrude_to_xy(out, point, dE, comment); return out; }
+    std::string extrude_to_xyz(const Vec3d &point, double dE, const std::string &comment = std::string())
+        { std::string out; this->extrude_to_xyz(out, point, dE, comment); return out; }
+    std::string retract(bool before_wipe = false)
+        { std::string out; this->retract(out, before_wipe); return out; }
+    std::string retract_for_toolchange(bool before_wipe = false)
+        { std::string out; this->retract_for_toolchange(out, before_wipe); return out; }
+    std::string unretract()
+        { std::string out; this->unretract(out); return out; }
+    std::string lift()
+        { std::string out; this->lift(out); return out; }
+    std::string unlift()
+        { std::string out; this->unlift(out); return out; }
+
+    // Append-style variants of the methods above. The G-code is formatted on stack and appended to a caller owned buffer,
+    // so that no temporary string is allocated per emitted line. These are to be used on the G-code export hot path,
+    // where the caller keeps appending into a single buffer for the whole layer.
+    void        set_acceleration(std::string &out, unsigned int acceleration);
+    void        reset_e(std::string &out, bool force = false);
+    void        toolchange(std::string &out, unsigned int extruder_id);
+    void        set_speed(std::string &out, double F, const std::string &comment = std::string(), const std::string &cooling_marker = std::string()) const;
+    void        travel_to_xy(std::string &out, const Vec2d &point, const std::string &comment = std::string());
+    void        travel_to_z(std::string &out, double z, const std::string &comment = std::string());
+    void        extrude_to_xy(std::string &out, const Vec2d &point, double dE, const std::string &comment = std::string());
+    void        extrude_to_xyz(std::string &out, const Vec3d &point, double dE, const std::string &comment = std::string());
+    void        retract(std::string &out, bool before_wipe = false);
+    void        retract_for_toolchange(std::string &out, bool before_wipe = false);
+    void        unretract(std::string &out);
+    void        lift(std::string &out);
+    void        unlift(std::string &out);
     Vec3d       get_position() const { return m_pos; }
 
     // To be called by the CoolingBuffer from another thread.
-    static std::string set_fan(const GCodeFlavor gcode_flavor, bool gcode_comments, unsigned int speed);
+    static std::string set_fan(const GCodeFlavor gcode_flavor, bool gcode_comments, unsigned int speed)
+        { std::string out; GCodeWriter::set_fan(out, gcode_flavor, gcode_comments, speed); return out; }
+    static void        set_fan(std::string &out, const GCodeFlavor gcode_flavor, bool gcode_comments, unsigned int speed);
     // To be called by the main thread. It always emits the G-code, it does not remember the previous state.
     // Keeping the state is left to the CoolingBuffer, which runs asynchronously on another thread.
     std::string set_fan(unsigned int speed) const;
@@ -90,8 +122,8 @@ private:
     double          m_lifted;
     Vec3d           m_pos = Vec3d::Zero();
 
-    std::string _travel_to_z(double z, const std::string &comment);
-    std::string _retract(double length, double restart_extra, const std::string &comment);
+    void        _travel_to_z(std::string &out, double z, const std::string &comment);
+    void        _retract(std::string &out, double length, double restart_extra, const std::string &comment);
 };
 
 class GCodeFormatter {
@@ -166,6 +198,12 @@ public:
         return std::string(this->buf, ptr_err.ptr - buf);
     }
 
+    // Terminate the line and append it to a caller owned buffer.
+    void append_to(std::string &out) {
+        *ptr_err.ptr ++ = '\n';
+        out.append(this->buf, ptr_err.ptr - buf);
+    }
+
 protected:
     static constexpr const size_t   buflen = 256;
     char                            buf[buflen];
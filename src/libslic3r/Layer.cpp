@@ -259,6 +259,93 @@ void Layer::export_region_fill_surfaces_to_svg_debug(const char *name) const
     this->export_region_fill_surfaces_to_svg(debug_out_path("Layer-fill_surfaces-%s-%d.svg", name, idx ++).c_str());
 }
 
+template<typename T>
+static inline size_t vector_memsize(const std::vector<T> &v) { return v.capacity() * sizeof(T); }
+
+static size_t memsize(const ExPolygon &expoly)
+{
+    size_t out = vector_memsize(expoly.contour.points) + vector_memsize(expoly.holes);
+    for (const Polygon &hole : expoly.holes)
+        out += vector_memsize(hole.points);
+    return out;
+}
+
+static size_t memsize(const ExPolygons &expolys)
+{
+    size_t out = vector_memsize(expolys);
+    for (const ExPolygon &expoly : expolys)
+        out += memsize(expoly);
+    return out;
+}
+
+static size_t memsize(const Polylines &polylines)
+{
+    size_t out = vector_memsize(polylines);
+    for (const Polyline &polyline : polylines)
+        out += vector_memsize(polyline.points);
+    return out;
+}
+
+static size_t memsize(const SurfaceCollection &surfaces)
+{
+    size_t out = vector_memsize(surfaces.surfaces);
+    for (const Surface &surface : surfaces.surfaces)
+        out += memsize(surface.expolygon);
+    return out;
+}
+
+static size_t memsize(const ExtrusionPaths &paths)
+{
+    size_t out = vector_memsize(paths);
+    for (const ExtrusionPath &path : paths)
+        out += vector_memsize(path.polyline.points);
+    return out;
+}
+
+// Heap memory held by the content of the extrusion entity, not counting the entity object itself.
+static size_t memsize(const ExtrusionEntity &entity)
+{
+    if (const auto *path = dynamic_cast<const ExtrusionPath*>(&entity))
+        return vector_memsize(path->polyline.points);
+    if (const auto *multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity))
+        return memsize(multipath->paths);
+    if (const auto *loop = dynamic_cast<const ExtrusionLoop*>(&entity))
+        return memsize(loop->paths);
+    if (const auto *collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+        size_t out = vector_memsize(collection->entities);
+        for (const ExtrusionEntity *ee : collection->entities)
+            out += sizeof(ExtrusionPath) + memsize(*ee);
+        return out;
+    }
+    return 0;
+}
+
+LayerMemsize LayerRegion::memsize() const
+{
+    LayerMemsize out;
+    out.slices        = Slic3r::memsize(this->slices) + Slic3r::memsize(this->raw_slices);
+    out.perimeters    = Slic3r::memsize(this->perimeters) + Slic3r::memsize(this->thin_fills) + Slic3r::memsize(this->fill_expolygons);
+    out.fill_surfaces = Slic3r::memsize(this->fill_surfaces) + Slic3r::memsize(this->unsupported_bridge_edges);
+    out.infill        = Slic3r::memsize(this->fills);
+    return out;
+}
+
+LayerMemsize Layer::memsize() const
+{
+    LayerMemsize out;
+    for (const LayerRegion *layerm : m_regions)
+        out += layerm->memsize();
+    out.slices += Slic3r::memsize(this->lslices) + vector_memsize(this->lslices_bboxes);
+    return out;
+}
+
+LayerMemsize SupportLayer::memsize() const
+{
+    LayerMemsize out = Layer::memsize();
+    out.support_material += Slic3r::memsize(this->support_islands.expolygons) + Slic3r::memsize(this->support_fills);
+    return out;
+}
+
 BoundingBox get_extents(const LayerRegion &layer_region)
 {
     BoundingBox bbox;
@@ -20,6 +20,29 @@ namespace FillAdaptive {
     struct Octree;
 };
 
+// Heap memory held by the layer data, in bytes, grouped by the PrintObject step producing the data.
+struct LayerMemsize
+{
+    // posSlice: region slices, raw slices and the merged lslices.
+    size_t slices           { 0 };
+    // posPerimeters: perimeter extrusions, gap fills and the fill_expolygons.
+    size_t perimeters       { 0 };
+    // posPrepareInfill: fill_surfaces and the unsupported bridge edges.
+    size_t fill_surfaces    { 0 };
+    // posInfill, posIroning: infill and ironing extrusions.
+    size_t infill           { 0 };
+    // posSupportMaterial: support islands and support extrusions.
+    size_t support_material { 0 };
+
+    size_t total() const { return slices + perimeters + fill_surfaces + infill + support_material; }
+
+    LayerMemsize& operator+=(const LayerMemsize &rhs) {
+        slices += rhs.slices; perimeters += rhs.perimeters; fill_surfaces += rhs.fill_surfaces;
+        infill += rhs.infill; support_material += rhs.support_material;
+        return *this;
+    }
+};
+
 class LayerRegion
 {
 public:
@@ -84,6 +107,8 @@ public:
 
     // Is there any valid extrusion assigned to this LayerRegion?
     bool    has_extrusions() const { return ! this->perimeters.entities.empty() || ! this->fills.entities.empty(); }
+    // Heap memory held by this LayerRegion.
+    LayerMemsize memsize() const;
 
 protected:
     friend class Layer;
@@ -161,6 +186,8 @@ public:
 
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool            has_extrusions() const { for (auto layerm : m_regions) if (layerm->has_extrusions()) return true; return false; }
+    // Heap memory held by this layer and its regions.
+    virtual LayerMemsize    memsize() const;
 
 protected:
     friend class PrintObject;
@@ -192,6 +219,7 @@ public:
 
     // Is there any valid extrusion assigned to this LayerRegion?
     virtual bool                has_extrusions() const { return ! support_fills.empty(); }
+    LayerMemsize                memsize() const override;
 
     // Zero based index of an interface layer, used for alternating direction of interface / contact layers.
     size_t                      interface_id() const { return m_interface_id; }
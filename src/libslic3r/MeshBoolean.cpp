@@ -4,6 +4,9 @@
 #include "libslic3r/TryCatchSignal.hpp"
 #undef PI
 
+#include <algorithm>
+#include <numeric>
+
 // Include igl first. It defines "L" macro which then clashes with our localization
 #include <igl/copyleft/cgal/mesh_boolean.h>
 #undef L
@@ -232,6 +235,186 @@ void plus(CGALMesh &A, CGALMesh &B) { _cgal_do(_cgal_union, A, B); }
 void intersect(CGALMesh &A, CGALMesh &B) { _cgal_do(_cgal_intersection, A, B); }
 bool does_self_intersect(const CGALMesh &mesh) { return CGALProc::does_self_intersect(mesh.m); }
 
+// /////////////////////////////////////////////////////////////////////////////
+// Boolean operations on partitioned meshes
+// /////////////////////////////////////////////////////////////////////////////
+
+struct PartitionedMesh::Part
+{
+    BoundingBoxf3                               bbox;
+    // Valid if cgal is not set.
+    indexed_triangle_set                        its;
+    std::unique_ptr<CGALMesh, CGALMeshDeleter>  cgal;
+
+    CGALMesh& cgal_mesh() {
+        if (! cgal) {
+            cgal = triangle_mesh_to_cgal(its);
+            its  = {};
+        }
+        return *cgal;
+    }
+    // Bounding box after a boolean operation modified the CGAL mesh.
+    void update_bbox() {
+        bbox = BoundingBoxf3();
+        for (auto v : cgal->m.vertices()) {
+            const auto &p = cgal->m.point(v);
+            bbox.merge(Vec3d(p.x(), p.y(), p.z()));
+        }
+    }
+    // Bounding boxes touching each other shall overlap, the corefinement shall see touching meshes.
+    bool overlaps(const Part &other) const { return bbox.inflated(EPSILON).intersects(other.bbox); }
+};
+
+PartitionedMesh::PartitionedMesh() = default;
+PartitionedMesh::PartitionedMesh(PartitionedMesh &&rhs) = default;
+PartitionedMesh& PartitionedMesh::operator=(PartitionedMesh &&rhs) = default;
+PartitionedMesh::~PartitionedMesh() = default;
+
+bool PartitionedMesh::empty() const { return m_parts.empty(); }
+size_t PartitionedMesh::num_parts() const { return m_parts.size(); }
+
+PartitionedMesh::PartitionedMesh(const indexed_triangle_set &its)
+{
+    std::vector<indexed_triangle_set> components = its_split(its);
+    std::vector<BoundingBoxf3>        bboxes;
+    bboxes.reserve(components.size());
+    for (const indexed_triangle_set &component : components)
+        bboxes.emplace_back(bounding_box(component));
+
+    // Group the components with overlapping bounding boxes by a sweep along X.
+    std::vector<size_t> group(components.size());
+    std::iota(group.begin(), group.end(), 0);
+    auto root = [&group](size_t i) {
+        while (group[i] != i)
+            i = group[i] = group[group[i]];
+        return i;
+    };
+    std::vector<size_t> order(components.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&bboxes](size_t i, size_t j) { return bboxes[i].min.x() < bboxes[j].min.x(); });
+    for (size_t i = 0; i < order.size(); ++ i) {
+        auto bbox = bboxes[order[i]].inflated(EPSILON);
+        for (size_t j = i + 1; j < order.size() && bboxes[order[j]].min.x() < bbox.max.x(); ++ j)
+            if (bbox.intersects(bboxes[order[j]]))
+                group[root(order[j])] = root(order[i]);
+    }
+
+    std::vector<size_t> part_of_group(components.size(), std::numeric_limits<size_t>::max());
+    for (size_t i = 0; i < components.size(); ++ i) {
+        size_t &part_idx = part_of_group[root(i)];
+        if (part_idx == std::numeric_limits<size_t>::max()) {
+            part_idx = m_parts.size();
+            m_parts.emplace_back();
+        }
+        Part &part = m_parts[part_idx];
+        its_merge(part.its, components[i]);
+        part.bbox.merge(bboxes[i]);
+    }
+}
+
+void PartitionedMesh::minus(PartitionedMesh &other)
+{
+    for (Part &part : m_parts) {
+        // Union of the other parts overlapping this part, so that this part is corefined just once.
+        // The other parts do not overlap each other. A single overlapping part is subtracted without a copy.
+        CGALMesh                                   *subtrahend = nullptr;
+        std::unique_ptr<CGALMesh, CGALMeshDeleter>  overlapping;
+        for (Part &other_part : other.m_parts)
+            if (part.overlaps(other_part)) {
+                if (subtrahend == nullptr)
+                    subtrahend = &other_part.cgal_mesh();
+                else {
+                    if (! overlapping) {
+                        overlapping.reset(new CGALMesh(*subtrahend));
+                        subtrahend = overlapping.get();
+                    }
+                    cgal::plus(*overlapping, other_part.cgal_mesh());
+                }
+            }
+        if (subtrahend != nullptr && ! cgal::empty(part.cgal_mesh())) {
+            cgal::minus(part.cgal_mesh(), *subtrahend);
+            part.update_bbox();
+        }
+    }
+    m_parts.erase(std::remove_if(m_parts.begin(), m_parts.end(), [](const Part &part) { return part.cgal && cgal::empty(*part.cgal); }), m_parts.end());
+}
+
+void PartitionedMesh::plus(PartitionedMesh &other)
+{
+    for (Part &other_part : other.m_parts) {
+        // Merge all parts overlapping the other part into the first of them.
+        Part *merged = nullptr;
+        for (Part &part : m_parts)
+            if (part.overlaps(other_part)) {
+                if (merged == nullptr)
+                    merged = &part;
+                else {
+                    cgal::plus(merged->cgal_mesh(), part.cgal_mesh());
+                    merged->bbox.merge(part.bbox);
+                    part.cgal.reset();
+                    part.its = {};
+                }
+            }
+        if (merged == nullptr) {
+            // No overlap, just take a copy of the other part.
+            m_parts.emplace_back();
+            Part &part = m_parts.back();
+            part.bbox  = other_part.bbox;
+            if (other_part.cgal)
+                part.cgal.reset(new CGALMesh(*other_part.cgal));
+            else
+                part.its = other_part.its;
+        } else {
+            cgal::plus(merged->cgal_mesh(), other_part.cgal_mesh());
+            merged->update_bbox();
+            m_parts.erase(std::remove_if(m_parts.begin(), m_parts.end(), [](const Part &part) { return ! part.cgal && part.its.empty(); }), m_parts.end());
+        }
+    }
+}
+
+void PartitionedMesh::intersect(PartitionedMesh &other)
+{
+    for (Part &part : m_parts) {
+        // Union of the other parts overlapping this part. The other parts do not overlap each other.
+        std::unique_ptr<CGALMesh, CGALMeshDeleter> overlapping;
+        for (Part &other_part : other.m_parts)
+            if (part.overlaps(other_part)) {
+                if (overlapping)
+                    cgal::plus(*overlapping, other_part.cgal_mesh());
+                else
+                    overlapping.reset(new CGALMesh(other_part.cgal_mesh()));
+            }
+        if (overlapping) {
+            cgal::intersect(part.cgal_mesh(), *overlapping);
+            part.update_bbox();
+        } else {
+            part.cgal.reset();
+            part.its = {};
+        }
+    }
+    m_parts.erase(std::remove_if(m_parts.begin(), m_parts.end(), 
+        [](const Part &part) { return part.cgal ? cgal::empty(*part.cgal) : part.its.empty(); }), m_parts.end());
+}
+
+bool PartitionedMesh::does_self_intersect()
+{
+    return std::any_of(m_parts.begin(), m_parts.end(), [](Part &part) { return cgal::does_self_intersect(part.cgal_mesh()); });
+}
+
+bool PartitionedMesh::does_bound_a_volume()
+{
+    // An empty mesh does not bound a volume.
+    return ! m_parts.empty() && std::all_of(m_parts.begin(), m_parts.end(), [](Part &part) { return cgal::does_bound_a_volume(part.cgal_mesh()); });
+}
+
+indexed_triangle_set PartitionedMesh::to_its() const
+{
+    indexed_triangle_set out;
+    for (const Part &part : m_parts)
+        its_merge(out, part.cgal ? cgal_to_triangle_mesh(*part.cgal).its : part.its);
+    return out;
+}
+
 // /////////////////////////////////////////////////////////////////////////////
 // Now the public functions for TriangleMesh input:
 // /////////////////////////////////////////////////////////////////////////////
@@ -57,6 +57,39 @@ bool does_self_intersect(const CGALMesh &mesh);
 bool does_bound_a_volume(const CGALMesh &mesh);
 bool empty(const CGALMesh &mesh);
 
+// Mesh split into parts for repeated boolean operations, e.g. drilling one hole after another.
+// A part is a group of connected components with overlapping bounding boxes, thus nested shells of a hollowed
+// mesh stay together, while parts are disjoint. Corefinement only runs on the parts overlapping the bounding box
+// of the other operand, the remaining parts are passed through untouched. Parts are converted to CGAL on demand
+// and kept converted, so that a sequence of operations does not convert the whole mesh again and again.
+class PartitionedMesh
+{
+public:
+    PartitionedMesh();
+    explicit PartitionedMesh(const indexed_triangle_set &its);
+    PartitionedMesh(PartitionedMesh &&rhs);
+    PartitionedMesh& operator=(PartitionedMesh &&rhs);
+    ~PartitionedMesh();
+
+    // The other mesh is corefined in place as with the CGALMesh operations above, its geometry is not modified.
+    // Throws Slic3r::RuntimeError or Slic3r::HardCrash as the CGALMesh operations do.
+    void minus(PartitionedMesh &other);
+    void plus(PartitionedMesh &other);
+    void intersect(PartitionedMesh &other);
+
+    bool empty() const;
+    size_t num_parts() const;
+    // Parts do not overlap, thus the following are evaluated part by part.
+    bool does_self_intersect();
+    bool does_bound_a_volume();
+
+    indexed_triangle_set to_its() const;
+
+private:
+    struct Part;
+    std::vector<Part> m_parts;
+};
+
 }
 
 } // namespace MeshBoolean
@@ -10,6 +10,7 @@
 #include "TriangleSelector.hpp"
 
 #include "Format/AMF.hpp"
+#include "Format/MeshCache.hpp"
 #include "Format/OBJ.hpp"
 #include "Format/STL.hpp"
 #include "Format/3mf.hpp"
@@ -110,7 +111,9 @@ Model Model::read_from_file(const std::string& input_file, DynamicPrintConfig* c
         config_substitutions = &temp_config_substitutions_context;
 
     bool result = false;
-    if (boost::algorithm::iends_with(input_file, ".stl"))
+    if ((options & LoadAttribute::UseMeshCache) && (boost::algorithm::iends_with(input_file, ".stl") || boost::algorithm::iends_with(input_file, ".obj")))
+        result = load_mesh_cached(input_file.c_str(), &model);
+    else if (boost::algorithm::iends_with(input_file, ".stl"))
         result = load_stl(input_file.c_str(), &model);
     else if (boost::algorithm::iends_with(input_file, ".obj"))
         result = load_obj(input_file.c_str(), &model);
@@ -217,6 +220,21 @@ ModelObject* Model::add_object(const char *name, const char *path, TriangleMesh
     return new_object;
 }
 
+ModelObject* Model::add_object(const char *name, const char *path, TriangleMesh &&mesh, TriangleMesh &&convex_hull)
+{
+    ModelObject* new_object = new ModelObject(this);
+    this->objects.push_back(new_object);
+    new_object->name = name;
+    new_object->input_file = path;
+    ModelVolume *new_volume = new_object->add_volume(std::move(mesh), std::move(convex_hull));
+    new_volume->name = name;
+    new_volume->source.input_file = path;
+    new_volume->source.object_idx = (int)this->objects.size() - 1;
+    new_volume->source.volume_idx = (int)new_object->volumes.size() - 1;
+    new_object->invalidate_bounding_box();
+    return new_object;
+}
+
 ModelObject* Model::add_object(const ModelObject &other)
 {
 	ModelObject* new_object = ModelObject::new_clone(other);
@@ -707,6 +725,15 @@ ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, ModelVolumeType type /
     return v;
 }
 
+ModelVolume* ModelObject::add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull)
+{
+    ModelVolume* v = new ModelVolume(this, std::move(mesh), std::move(convex_hull));
+    this->volumes.push_back(v);
+    v->center_geometry_after_creation();
+    this->invalidate_bounding_box();
+    return v;
+}
+
 ModelVolume* ModelObject::add_volume(const ModelVolume &other, ModelVolumeType type /*= ModelVolumeType::INVALID*/)
 {
     ModelVolume* v = new ModelVolume(this, other);
@@ -973,8 +1000,21 @@ Polygon ModelObject::convex_hull_2d(const Transform3d& trafo_instance) const
 {
     Points pts;
     for (const ModelVolume* v : volumes) {
-        if (v->is_model_part())
-            append(pts, its_convex_hull_2d_above(v->mesh().its, (trafo_instance * v->get_matrix()).cast<float>(), 0.0f).points);
+        if (v->is_model_part()) {
+            const Transform3f trafo = (trafo_instance * v->get_matrix()).cast<float>();
+            // The projection of the mesh has the same 2D convex hull as the projection of the vertices of its cached 3D convex hull,
+            // which are usually much fewer. Only a volume sinking below the bed needs its mesh to be clipped at the bed.
+            const TriangleMesh *hull = v->get_convex_hull_shared_ptr().get();
+            if (hull != nullptr && ! hull->empty() &&
+                std::all_of(hull->its.vertices.begin(), hull->its.vertices.end(), [&trafo](const stl_vertex &p) { return (trafo * p).z() >= 0.f; })) {
+                pts.reserve(pts.size() + hull->its.vertices.size());
+                for (const stl_vertex &p : hull->its.vertices) {
+                    Vec3f pt = trafo * p;
+                    pts.emplace_back(scaled<coord_t>(pt.x()), scaled<coord_t>(pt.y()));
+                }
+            } else
+                append(pts, its_convex_hull_2d_above(v->mesh().its, trafo, 0.0f).points);
+        }
     }
     return Geometry::convex_hull(std::move(pts));
 }
@@ -280,6 +280,8 @@ public:
 
     ModelVolume*            add_volume(const TriangleMesh &mesh);
     ModelVolume*            add_volume(TriangleMesh &&mesh, ModelVolumeType type = ModelVolumeType::MODEL_PART);
+    // Add a volume with its convex hull already calculated.
+    ModelVolume*            add_volume(TriangleMesh &&mesh, TriangleMesh &&convex_hull);
     ModelVolume*            add_volume(const ModelVolume &volume, ModelVolumeType type = ModelVolumeType::INVALID);
     ModelVolume*            add_volume(const ModelVolume &volume, TriangleMesh &&mesh);
     void                    delete_volume(size_t idx);
@@ -1072,7 +1074,9 @@ public:
 
     enum class LoadAttribute : int {
         AddDefaultInstances,
-        CheckVersion
+        CheckVersion,
+        // Load STL and OBJ files through the mesh cache, see Format/MeshCache.hpp
+        UseMeshCache
     };
     using LoadAttributes = enum_bitmask<LoadAttribute>;
 
@@ -1089,6 +1093,7 @@ public:
     ModelObject* add_object();
     ModelObject* add_object(const char *name, const char *path, const TriangleMesh &mesh);
     ModelObject* add_object(const char *name, const char *path, TriangleMesh &&mesh);
+    ModelObject* add_object(const char *name, const char *path, TriangleMesh &&mesh, TriangleMesh &&convex_hull);
     ModelObject* add_object(const ModelObject &other);
     void         delete_object(size_t idx);
     bool         delete_object(ObjectID id);
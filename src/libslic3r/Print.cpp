@@ -23,6 +23,8 @@
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 // Mark string for localization and translate.
 #define L(s) Slic3r::I18N::translate(s)
 
@@ -44,6 +46,8 @@ void Print::clear()
 	m_objects.clear();
     m_print_regions.clear();
     m_model.clear_objects();
+    m_tool_ordering_cache.clear();
+    m_wipe_tower_layout_cache.clear();
 }
 
 // Called by Print::apply().
@@ -787,15 +791,30 @@ void Print::process()
     name_tbb_thread_pool_threads_set_locale();
 
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
+    auto release_intermediate_layer_data = [this](PrintObjectStep step, const char *step_name) {
+        if (m_low_memory) {
+            LayerMemsize before, after;
+            for (PrintObject *obj : m_objects) {
+                before += obj->memsize();
+                obj->release_intermediate_layer_data(step);
+                after  += obj->memsize();
+            }
+            BOOST_LOG_TRIVIAL(info) << "Low memory mode: layer data reduced from " << format_memsize_MB(before.total()) <<
+                " to " << format_memsize_MB(after.total()) << " after " << step_name << log_memory_info();
+        }
+    };
     for (PrintObject *obj : m_objects)
         obj->make_perimeters();
+    release_intermediate_layer_data(posPerimeters, "perimeters");
     this->set_status(70, L("Infilling layers"));
     for (PrintObject *obj : m_objects)
         obj->infill();
+    release_intermediate_layer_data(posInfill, "infill");
     for (PrintObject *obj : m_objects)
         obj->ironing();
     for (PrintObject *obj : m_objects)
         obj->generate_support_material();
+    release_intermediate_layer_data(posSupportMaterial, "support material");
     if (this->set_started(psWipeTower)) {
         m_wipe_tower_data.clear();
         m_tool_ordering.clear();
@@ -804,7 +823,7 @@ void Print::process()
             this->_make_wipe_tower();
         } else if (! this->config().complete_objects.value) {
         	// Initialize the tool ordering, so it could be used by the G-code preview slider for planning tool changes and filament switches.
-        	m_tool_ordering = ToolOrdering(*this, -1, false);
+        	m_tool_ordering = m_tool_ordering_cache.tool_ordering(*this, -1, false);
             if (m_tool_ordering.empty() || m_tool_ordering.last_extruder() == unsigned(-1))
                 throw Slic3r::SlicingError("The print is empty. The model is not printable with current print settings.");
         }
@@ -1104,7 +1123,7 @@ void Print::_make_wipe_tower()
         wipe_volumes.push_back(std::vector<float>(wiping_matrix.begin()+i*number_of_extruders, wiping_matrix.begin()+(i+1)*number_of_extruders));
 
     // Let the ToolOrdering class know there will be initial priming extrusions at the start of the print.
-    m_wipe_tower_data.tool_ordering = ToolOrdering(*this, (unsigned int)-1, true);
+    m_wipe_tower_data.tool_ordering = m_tool_ordering_cache.tool_ordering(*this, (unsigned int)-1, true);
 
     if (! m_wipe_tower_data.tool_ordering.has_wipe_tower())
         // Don't generate any wipe tower.
@@ -1163,38 +1182,68 @@ void Print::_make_wipe_tower()
     // Lets go through the wipe tower layers and determine pairs of extruder changes for each
     // to pass to wipe_tower (so that it can use it for planning the layout of the tower)
     {
+        struct ToolChange {
+            unsigned int old_extruder;
+            unsigned int new_extruder;
+            float        volume_to_wipe;
+        };
+        struct WipeTowerLayer {
+            LayerTools              *layer_tools;
+            // Extruder active when the layer starts.
+            unsigned int             first_extruder;
+            std::vector<ToolChange>  tool_changes;
+        };
+        // The sequence of tool changes only depends on the extruders of the layers, collect it first.
+        std::vector<WipeTowerLayer> wipe_tower_layers;
         unsigned int current_extruder_id = m_wipe_tower_data.tool_ordering.all_extruders().back();
         for (auto &layer_tools : m_wipe_tower_data.tool_ordering.layer_tools()) { // for all layers
             if (!layer_tools.has_wipe_tower) continue;
             bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
-            wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_extruder_id, current_extruder_id, false);
+            WipeTowerLayer &layer = wipe_tower_layers.emplace_back(WipeTowerLayer{ &layer_tools, current_extruder_id, {} });
             for (const auto extruder_id : layer_tools.extruders) {
                 if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) || extruder_id != current_extruder_id) {
-                    float volume_to_wipe = wipe_volumes[current_extruder_id][extruder_id];             // total volume to wipe after this toolchange
-                    // Not all of that can be used for infill purging:
-                    volume_to_wipe -= (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
-
-                    // try to assign some infills/objects for the wiping:
-                    volume_to_wipe = layer_tools.wiping_extrusions().mark_wiping_extrusions(*this, current_extruder_id, extruder_id, volume_to_wipe);
-
-                    // add back the minimal amount toforce on the wipe tower:
-                    volume_to_wipe += (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
-
-                    // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
-                    wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height,
-                                               current_extruder_id, extruder_id, volume_to_wipe);
+                    // total volume to wipe after this toolchange
+                    layer.tool_changes.push_back({ current_extruder_id, extruder_id, wipe_volumes[current_extruder_id][extruder_id] });
                     current_extruder_id = extruder_id;
                 }
             }
-            layer_tools.wiping_extrusions().ensure_perimeters_infills_order(*this);
             if (&layer_tools == &m_wipe_tower_data.tool_ordering.back() || (&layer_tools + 1)->wipe_tower_partitions == 0)
                 break;
         }
+
+        // Marking the extrusions used for wiping only modifies the WipingExtrusions of the layer being marked,
+        // thus the layers are processed in parallel.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, wipe_tower_layers.size()),
+            [this, &wipe_tower_layers](const tbb::blocked_range<size_t> &range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    WipeTowerLayer &layer = wipe_tower_layers[layer_idx];
+                    for (ToolChange &tool_change : layer.tool_changes) {
+                        // Not all of that can be used for infill purging:
+                        float volume_to_wipe = tool_change.volume_to_wipe - (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(tool_change.new_extruder);
+
+                        // try to assign some infills/objects for the wiping:
+                        volume_to_wipe = layer.layer_tools->wiping_extrusions().mark_wiping_extrusions(*this, tool_change.old_extruder, tool_change.new_extruder, volume_to_wipe);
+
+                        // add back the minimal amount toforce on the wipe tower:
+                        tool_change.volume_to_wipe = volume_to_wipe + (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(tool_change.new_extruder);
+                    }
+                    layer.layer_tools->wiping_extrusions().ensure_perimeters_infills_order(*this);
+                }
+            });
+
+        for (const WipeTowerLayer &layer : wipe_tower_layers) {
+            const LayerTools &layer_tools = *layer.layer_tools;
+            wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, layer.first_extruder, layer.first_extruder, false);
+            for (const ToolChange &tool_change : layer.tool_changes)
+                // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
+                wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height,
+                                           tool_change.old_extruder, tool_change.new_extruder, tool_change.volume_to_wipe);
+        }
     }
 
     // Generate the wipe tower layers.
     m_wipe_tower_data.tool_changes.reserve(m_wipe_tower_data.tool_ordering.layer_tools().size());
-    wipe_tower.generate(m_wipe_tower_data.tool_changes);
+    wipe_tower.generate(m_wipe_tower_data.tool_changes, &m_wipe_tower_layout_cache);
     m_wipe_tower_data.depth = wipe_tower.get_depth();
     m_wipe_tower_data.brim_width = wipe_tower.get_brim_width();
 
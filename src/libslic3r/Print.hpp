@@ -26,6 +26,7 @@ namespace Slic3r {
 
 class GCode;
 class Layer;
+struct LayerMemsize;
 class ModelObject;
 class Print;
 class PrintObject;
@@ -370,6 +371,11 @@ private:
     void infill();
     void ironing();
     void generate_support_material();
+    // Heap memory held by the object and support layers.
+    LayerMemsize memsize() const;
+    // Low memory mode: free the layer data, which is no longer needed once the step is finished.
+    // The step and the steps it depends on cannot be recalculated afterwards.
+    void release_intermediate_layer_data(PrintObjectStep step);
 
     void slice_volumes();
     // Has any support (not counting the raft).
@@ -519,6 +525,9 @@ public:
     ApplyStatus         apply(const Model &model, DynamicPrintConfig config) override;
 
     void                process() override;
+    // Release the intermediate layer data during process() as soon as the following steps no longer need them.
+    // Lowers the peak memory of the command line slicer. The Print cannot be reprocessed after process() ran in this mode.
+    void                set_low_memory(bool low_memory) { m_low_memory = low_memory; }
     // Exports G-code into a file name based on the path_template, returns the file path of the generated G-code file.
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
@@ -629,10 +638,16 @@ private:
 
     // Following section will be consumed by the GCodeGenerator.
     ToolOrdering 							m_tool_ordering;
+    // Keeps the ToolOrdering over invalidation of psWipeTower by parameters, which do not affect the tool ordering.
+    ToolOrderingCache                       m_tool_ordering_cache;
+    // Layout of the wipe tower, reused if only parameters not affecting its geometry change.
+    WipeTower::LayoutCache                  m_wipe_tower_layout_cache;
     WipeTowerData                           m_wipe_tower_data {m_tool_ordering};
 
     // Estimated print time, filament consumed.
     PrintStatistics                         m_print_statistics;
+    // See set_low_memory().
+    bool                                    m_low_memory { false };
 
     // To allow GCode to set the Print's GCodeExport step status.
     friend class GCode;
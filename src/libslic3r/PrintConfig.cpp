@@ -2493,6 +2493,17 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionEnum<SlicingMode>(SlicingMode::Regular));
 
+    def = this->add("slicing_out_of_core_facets", coInt);
+    def->label = L("Slice out of core above");
+    def->category = L("Advanced");
+    def->tooltip = L("Objects with more triangles than this are stored into a temporary file sorted by height "
+                     "and sliced band by band, which limits the memory needed to slice very large meshes. "
+                     "Set zero to always slice in memory.");
+    def->sidetext = L("triangles");
+    def->min = 0;
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionInt(0));
+
     def = this->add("support_material", coBool);
     def->label = L("Generate support material");
     def->category = L("Support material");
@@ -3232,6 +3243,18 @@ void PrintConfigDef::init_sla_params()
     def->mode = comExpert;
     def->set_default_value(new ConfigOptionFloat(1.0));
 
+    def = this->add("rasterize_from_mesh", coBool);
+    def->label = L("Rasterize directly from mesh");
+    def->tooltip  = L("Rasterize the layers from the intersections of the meshes "
+                      "with the slicing planes instead of from the merged slice "
+                      "polygons. This is faster for high resolution displays. "
+                      "The absolute correction, the elephant foot compensation "
+                      "and the \"Close holes\" slicing mode still need the "
+                      "polygons, affected objects and layers are rasterized "
+                      "the usual way. Slice closing radius is not applied.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
 
     // SLA Material settings.
 
@@ -4435,6 +4458,12 @@ CLIMiscConfigDef::CLIMiscConfigDef()
                      "or an existing PrusaSlicer window is activated. "
                      "Overrides the \"single_instance\" configuration value from application preferences.");
 
+    def = this->add("low_memory", coBool);
+    def->label = L("Low memory mode");
+    def->tooltip = L("Release the intermediate layer data during slicing as soon as it is no longer needed "
+                     "to lower the peak memory consumption when slicing large objects.");
+    def->set_default_value(new ConfigOptionBool(false));
+
 /*
     def = this->add("autosave", coString);
     def->label = L("Autosave");
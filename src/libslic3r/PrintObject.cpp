@@ -403,6 +403,54 @@ void PrintObject::generate_support_material()
     }
 }
 
+LayerMemsize PrintObject::memsize() const
+{
+    LayerMemsize out;
+    for (const Layer *layer : m_layers)
+        out += layer->memsize();
+    for (const SupportLayer *layer : m_support_layers)
+        out += layer->memsize();
+    return out;
+}
+
+template<typename T>
+static inline void release_vector(std::vector<T> &v)
+{
+    v.clear();
+    v.shrink_to_fit();
+}
+
+void PrintObject::release_intermediate_layer_data(PrintObjectStep step)
+{
+    // Keep fill_surfaces for the avoid crossing perimeters feature of the G-code generator.
+    const bool keep_fill_surfaces = m_print->config().avoid_crossing_perimeters.value;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_layers.size()),
+        [this, step, keep_fill_surfaces](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                for (LayerRegion *layerm : m_layers[layer_idx]->regions())
+                    switch (step) {
+                    case posPerimeters:
+                        // Only needed to restart make_perimeters() over untyped slices.
+                        release_vector(layerm->raw_slices);
+                        break;
+                    case posInfill:
+                        // Gap fills were copied into fills, fill_expolygons were consumed by prepare_infill().
+                        layerm->thin_fills.clear();
+                        release_vector(layerm->thin_fills.entities);
+                        release_vector(layerm->fill_expolygons);
+                        break;
+                    case posSupportMaterial:
+                        release_vector(layerm->unsupported_bridge_edges);
+                        if (! keep_fill_surfaces)
+                            release_vector(layerm->fill_surfaces.surfaces);
+                        break;
+                    default:
+                        break;
+                    }
+        });
+}
+
 std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> PrintObject::prepare_adaptive_infill_data()
 {
     using namespace FillAdaptive;
@@ -655,6 +703,8 @@ bool PrintObject::invalidate_state_by_config_options(
             || opt_key == "wipe_into_objects") {
             invalidated |= m_print->invalidate_step(psWipeTower);
             invalidated |= m_print->invalidate_step(psGCodeExport);
+        } else if (opt_key == "slicing_out_of_core_facets") {
+            // Slicing out of core produces the same slices as slicing in memory, nothing to invalidate.
         } else {
             // for legacy, if we can't handle this option let's invalidate all steps
             this->invalidate_all_steps();
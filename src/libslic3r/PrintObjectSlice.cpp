@@ -1,3 +1,4 @@
+#include "BandedMesh.hpp"
 #include "ElephantFootCompensation.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
@@ -5,6 +6,7 @@
 #include "Print.hpp"
 #include "ClipperUtils.hpp"
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
@@ -39,24 +41,57 @@ LayerPtrs new_layers(
     return out;
 }
 
+// Slice a triangle mesh out of core: store it into a temporary BandedMesh file and slice it band by band.
+// Returns false if the temporary file could not be written.
+static bool slice_volume_out_of_core(
+    const indexed_triangle_set    &its,
+    const std::vector<float>      &zs,
+    const MeshSlicingParamsEx     &params,
+    const std::function<void()>   &throw_on_cancel_callback,
+    std::vector<ExPolygons>       &layers)
+{
+    const std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("slic3r_%%%%-%%%%-%%%%-%%%%.bmesh")).string();
+    if (! BandedMesh::create(its, params.trafo, path, 1 << 20, throw_on_cancel_callback))
+        return false;
+    try {
+        BandedMesh banded;
+        if (banded.open(path)) {
+            MeshSlicingParamsEx params_banded { params };
+            params_banded.trafo = Transform3d::Identity();
+            layers = slice_mesh_ex(banded, zs, params_banded, throw_on_cancel_callback);
+        }
+    } catch (...) {
+        boost::filesystem::remove(path);
+        throw;
+    }
+    boost::system::error_code ec;
+    boost::filesystem::remove(path, ec);
+    return ! layers.empty();
+}
+
 // Slice single triangle mesh.
+// Meshes with more than out_of_core_facets triangles are sliced out of core, zero to always slice in memory.
 static std::vector<ExPolygons> slice_volume(
     const ModelVolume             &volume,
     const std::vector<float>      &zs, 
     const MeshSlicingParamsEx     &params,
+    size_t                         out_of_core_facets,
     const std::function<void()>   &throw_on_cancel_callback)
 {
     std::vector<ExPolygons> layers;
-    if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
-            MeshSlicingParamsEx params2 { params };
-            params2.trafo = params2.trafo * volume.get_matrix();
-            if (params2.trafo.rotation().determinant() < 0.)
+    if (! zs.empty() && ! volume.mesh().its.indices.empty()) {
+        MeshSlicingParamsEx params2 { params };
+        params2.trafo = params2.trafo * volume.get_matrix();
+        const bool flip = params2.trafo.rotation().determinant() < 0.;
+        // The banded mesh refers to the volume mesh without copying it, thus it is not used if the triangles are to be flipped.
+        if (out_of_core_facets == 0 || volume.mesh().its.indices.size() <= out_of_core_facets || flip ||
+            ! slice_volume_out_of_core(volume.mesh().its, zs, params2, throw_on_cancel_callback, layers)) {
+            indexed_triangle_set its = volume.mesh().its;
+            if (flip)
                 its_flip_triangles(its);
             layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
-            throw_on_cancel_callback();
         }
+        throw_on_cancel_callback();
     }
     return layers;
 }
@@ -68,13 +103,14 @@ static std::vector<ExPolygons> slice_volume(
     const std::vector<float>                    &z,
     const std::vector<t_layer_height_range>     &ranges,
     const MeshSlicingParamsEx                   &params,
+    size_t                                       out_of_core_facets,
     const std::function<void()>                 &throw_on_cancel_callback)
 {
     std::vector<ExPolygons> out;
     if (! z.empty() && ! ranges.empty()) {
         if (ranges.size() == 1 && z.front() >= ranges.front().first && z.back() < ranges.front().second) {
             // All layers fit into a single range.
-            out = slice_volume(volume, z, params, throw_on_cancel_callback);
+            out = slice_volume(volume, z, params, out_of_core_facets, throw_on_cancel_callback);
         } else {
             std::vector<float>                     z_filtered;
             std::vector<std::pair<size_t, size_t>> n_filtered;
@@ -90,7 +126,7 @@ static std::vector<ExPolygons> slice_volume(
                     n_filtered.emplace_back(std::make_pair(first, i));
             }
             if (! n_filtered.empty()) {
-                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, out_of_core_facets, throw_on_cancel_callback);
                 out.assign(z.size(), ExPolygons());
                 i = 0;
                 for (const std::pair<size_t, size_t> &span : n_filtered)
@@ -150,6 +186,8 @@ static std::vector<VolumeSlices> slice_volumes_inner(
 
     params_base.mode_below     = params_base.mode;
 
+    const size_t out_of_core_facets = size_t(std::max(0, print_object_config.slicing_out_of_core_facets.value));
+
     const size_t num_extruders = print_config.nozzle_diameter.size();
     const bool   is_mm_painted = num_extruders > 1 && std::any_of(model_volumes.cbegin(), model_volumes.cend(), [](const ModelVolume *mv) { return mv->is_mm_painted(); });
     const auto   extra_offset  = is_mm_painted ? 0.f : std::max(0.f, float(print_object_config.xy_size_compensation.value));
@@ -174,7 +212,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                     }
                     out.push_back({
                         model_volume->id(), 
-                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, params, out_of_core_facets, throw_on_cancel_callback)
                     });
                 }
             } else {
@@ -186,7 +224,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                 if (! slicing_ranges.empty())
                     out.push_back({ 
                         model_volume->id(), 
-                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, slicing_ranges, params, out_of_core_facets, throw_on_cancel_callback)
                     });
             }
             if (! out.empty() && out.back().slices.empty())
@@ -821,9 +859,10 @@ std::vector<Polygons> PrintObject::slice_support_volumes(const ModelVolumeType m
         auto               throw_on_cancel_callback = std::function<void()>([print](){ print->throw_if_canceled(); });
         MeshSlicingParamsEx params;
         params.trafo = this->trafo_centered();
+        const size_t       out_of_core_facets = size_t(std::max(0, this->config().slicing_out_of_core_facets.value));
         for (; it_volume != it_volume_end; ++ it_volume)
             if ((*it_volume)->type() == model_volume_type) {
-                std::vector<ExPolygons> slices2 = slice_volume(*(*it_volume), zs, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> slices2 = slice_volume(*(*it_volume), zs, params, out_of_core_facets, throw_on_cancel_callback);
                 if (slices.empty()) {
                     slices.reserve(slices2.size());
                     for (ExPolygons &src : slices2)
@@ -3,6 +3,8 @@
 #include <optional>
 #include "MutablePriorityQueue.hpp"
 #include <tbb/parallel_for.h>
+#include <algorithm>
+#include <array>
 
 using namespace Slic3r;
 
@@ -135,6 +137,22 @@ namespace QuadricEdgeCollapse {
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
     void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
 
+    // Edge collapse prepared for the batched mode, valid for the state of the mesh at the start of a round.
+    struct Collapse {
+        float    value = std::numeric_limits<float>::max(); // error of the collapsed edge, max for no valid collapse
+        uint32_t ti0 = 0, ti1 = 0; // triangles to be removed
+        uint32_t vi0 = 0, vi1 = 0; // vi1 is merged into vi0
+        Vec3f    new_vertex;
+        bool     is_valid() const { return value < std::numeric_limits<float>::max(); }
+    };
+    using Collapses = std::vector<Collapse>;
+    // Select the cheapest edge of a triangle, which passes the same checks as in its_quadric_edge_collapse().
+    // Reads the mesh only, thus it may be called for many triangles in parallel.
+    Collapse find_collapse(uint32_t ti0, float maximal_error, const indexed_triangle_set &its,
+        const TriangleInfos &t_infos, const VertexInfos &v_infos, const EdgeInfos &e_infos);
+    // Remove the deleted triangles and create vertex to triangle references from scratch, vertex quadrics are kept.
+    void compact_triangles(indexed_triangle_set &its, TriangleInfos &t_infos, VertexInfos &v_infos, EdgeInfos &e_infos, Errors &errors);
+
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
                         const VertexInfos &v_infos, const EdgeInfos &e_infos);
@@ -153,6 +171,12 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+
+    // Batched mode: collapses in one round are limited to 1/batch_triangle_fraction of the actual triangle count,
+    // so that the edges are collapsed in about the same order as one by one.
+    const uint32_t batch_triangle_fraction = 16;
+    // Batched mode: how many of the cheapest triangles are considered per collapse in one round.
+    const size_t batch_pool_factor = 4;
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -346,6 +370,148 @@ void Slic3r::its_quadric_edge_collapse(
     if (max_error != nullptr) *max_error = last_collapsed_error;
 }
 
+void Slic3r::its_quadric_edge_collapse_par(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn)
+{
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    StatusFn init_status_fn = [&](int percent) {
+        float n_percent = percent * status_init_size / 100.f;
+        status_fn(static_cast<int>(std::round(n_percent)));
+    };
+
+    TriangleInfos t_infos;
+    VertexInfos   v_infos;
+    EdgeInfos     e_infos;
+    Errors        errors;
+    std::tie(t_infos, v_infos, e_infos, errors) = init(its, throw_on_cancel, init_status_fn);
+    throw_on_cancel();
+    status_fn(status_init_size);
+
+    uint32_t actual_triangle_count = its.indices.size();
+    uint32_t count_triangle_to_reduce = actual_triangle_count - triangle_count;
+    float last_collapsed_error = 0.f;
+
+    Errors                pool;
+    Collapses             candidates;
+    Collapses             collapses;
+    std::vector<uint8_t>  locked(its.vertices.size(), 0);
+    std::vector<uint32_t> locked_indices;
+    size_t                pool_factor = batch_pool_factor;
+    while (actual_triangle_count > triangle_count) {
+        throw_on_cancel();
+        uint32_t max_collapses = std::min((actual_triangle_count - triangle_count + 1) / 2,
+                                          std::max(uint32_t(1), actual_triangle_count / batch_triangle_fraction));
+
+        // The cheapest triangles are candidates for a collapse in this round.
+        pool = errors;
+        size_t pool_size = std::min(pool.size(), max_collapses * pool_factor);
+        auto less = [](const Error &e1, const Error &e2) { return e1.value < e2.value || (e1.value == e2.value && e1.triangle_index < e2.triangle_index); };
+        std::nth_element(pool.begin(), pool.begin() + (pool_size - 1), pool.end(), less);
+        pool.erase(pool.begin() + pool_size, pool.end());
+
+        // Validate the candidate edges against the mesh at the start of this round.
+        candidates.assign(pool_size, Collapse());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, pool_size), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+                if (pool[i].value < maximal_error)
+                    candidates[i] = find_collapse(pool[i].triangle_index, maximal_error, its, t_infos, v_infos, e_infos);
+        }); // END parallel for
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](const Collapse &c) { return !c.is_valid(); }), candidates.end());
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse &c1, const Collapse &c2) {
+            return c1.value < c2.value || (c1.value == c2.value && c1.ti0 < c2.ti0);
+        });
+
+        // Greedy independent set of the cheapest edges: the one-rings of the collapsed edges must not share a vertex,
+        // thus the collapses neither modify nor read the same triangles and vertices.
+        collapses.clear();
+        auto ring_free = [&](uint32_t vi) {
+            const VertexInfo &v_info = v_infos[vi];
+            for (uint32_t ei = v_info.start; ei < v_info.start + v_info.count; ++ei) {
+                const Triangle &t = its.indices[e_infos[ei].t_index];
+                if (locked[t[0]] || locked[t[1]] || locked[t[2]]) return false;
+            }
+            return true;
+        };
+        auto lock_ring = [&](uint32_t vi) {
+            const VertexInfo &v_info = v_infos[vi];
+            for (uint32_t ei = v_info.start; ei < v_info.start + v_info.count; ++ei)
+                for (int vi_ring : its.indices[e_infos[ei].t_index])
+                    if (! locked[vi_ring]) {
+                        locked[vi_ring] = 1;
+                        locked_indices.emplace_back(vi_ring);
+                    }
+        };
+        for (const Collapse &c : candidates) {
+            if (collapses.size() == max_collapses) break;
+            if (! ring_free(c.vi0) || ! ring_free(c.vi1)) continue;
+            lock_ring(c.vi0);
+            lock_ring(c.vi1);
+            collapses.emplace_back(c);
+        }
+        for (uint32_t vi : locked_indices) locked[vi] = 0;
+        locked_indices.clear();
+        if (collapses.empty()) {
+            // No edge could be collapsed, e.g. all remaining errors are too big.
+            if (pool_size == errors.size()) break;
+            // The cheapest edges could not be collapsed, try more of them.
+            pool_factor *= 4;
+            continue;
+        }
+        pool_factor = batch_pool_factor;
+
+        // Collapse the independent edges in parallel.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, collapses.size()), [&](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                const Collapse &c       = collapses[i];
+                VertexInfo     &v_info0 = v_infos[c.vi0];
+                VertexInfo     &v_info1 = v_infos[c.vi1];
+                v_info0.q += v_info1.q;
+                its.vertices[c.vi0] = c.new_vertex;
+                for (uint32_t ei = v_info1.start; ei < v_info1.start + v_info1.count; ++ei) {
+                    const EdgeInfo &e_info = e_infos[ei];
+                    if (e_info.t_index == c.ti0 || e_info.t_index == c.ti1) continue;
+                    its.indices[e_info.t_index][e_info.edge] = c.vi0; // change index
+                }
+                t_infos[c.ti0].set_deleted();
+                t_infos[c.ti1].set_deleted();
+                // fix normals and errors of the triangles around the merged vertex
+                for (const VertexInfo *v_info : { &v_info0, &v_info1 })
+                    for (uint32_t ei = v_info->start; ei < v_info->start + v_info->count; ++ei) {
+                        uint32_t ti = e_infos[ei].t_index;
+                        if (ti == c.ti0 || ti == c.ti1) continue;
+                        TriangleInfo &t_info = t_infos[ti];
+                        t_info.n   = create_normal(its.indices[ti], its.vertices).cast<float>();
+                        errors[ti] = calculate_error(ti, its.indices[ti], its.vertices, v_infos, t_info.min_index);
+                    }
+            }
+        }); // END parallel for
+
+        actual_triangle_count -= 2 * uint32_t(collapses.size());
+        last_collapsed_error = std::max(last_collapsed_error, collapses.back().value);
+        compact_triangles(its, t_infos, v_infos, e_infos, errors);
+
+        double reduced = (actual_triangle_count - triangle_count) / (double) count_triangle_to_reduce;
+        status_fn(static_cast<int>(std::round(status_init_size + (100 - status_init_size) * (1. - reduced))));
+#ifdef EXPENSIVE_DEBUG_CHECKS
+        assert(check_neighbors(its, t_infos, v_infos, e_infos));
+#endif // EXPENSIVE_DEBUG_CHECKS
+    }
+
+    // compact vertices, triangles are already compacted
+    compact(v_infos, t_infos, e_infos, its);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
                                          const Vertices &vertices)
 {
@@ -599,11 +765,12 @@ bool QuadricEdgeCollapse::is_flipped(const Vec3f &               new_vertex,
     static const float thr_neg = -thr_pos;
     static const float dot_thr = 0.2f; // Value from simplify mesh cca 80 DEG
 
-    // for each vertex triangles
-    size_t v_info_end = v_info.start + v_info.count-2;
+    // for each vertex triangles except of the collapsed ones
+    size_t v_info_end = v_info.start + v_info.count;
     for (size_t ei = v_info.start; ei < v_info_end; ++ei) {
         assert(ei < e_infos.size());
         const EdgeInfo &e_info = e_infos[ei];
+        if (e_info.t_index == ti0 || e_info.t_index == ti1) continue;
         const Triangle &t      = its.indices[e_info.t_index];
         const Vec3f &normal = t_infos[e_info.t_index].n;
         const Vec3f &vf     = its.vertices[t[(e_info.edge + 1) % 3]];
@@ -633,10 +800,11 @@ bool QuadricEdgeCollapse::degenerate(uint32_t          vi,
 {
     // check surround triangle do not contain vertex index
     // protect from creation of triangle with two same vertices inside
-    size_t v_info_end = v_info.start + v_info.count - 2;
+    size_t v_info_end = v_info.start + v_info.count;
     for (size_t ei = v_info.start; ei < v_info_end; ++ei) {
         assert(ei < e_infos.size());
         const EdgeInfo &e_info = e_infos[ei];
+        if (e_info.t_index == ti0 || e_info.t_index == ti1) continue;
         const Triangle &t = indices[e_info.t_index];
         for (size_t i = 0; i < 3; ++i)
             if (static_cast<uint32_t>(t[i]) == vi) return true;
@@ -653,10 +821,11 @@ bool QuadricEdgeCollapse::create_no_volume(
     // check that triangles around vertex0 doesn't have half edge
     // with opposit order in set of triangles around vertex1
     // protect from creation of two triangles with oposit order - no volume space
-    size_t v_info0_end = v_info0.start + v_info0.count - 2;
-    size_t v_info1_end = v_info1.start + v_info1.count - 2;
+    size_t v_info0_end = v_info0.start + v_info0.count;
+    size_t v_info1_end = v_info1.start + v_info1.count;
     for (size_t ei0 = v_info0.start; ei0 < v_info0_end; ++ei0) {
         const EdgeInfo &e_info0 = e_infos[ei0];
+        if (e_info0.t_index == ti0 || e_info0.t_index == ti1) continue;
         const Triangle &t0 = indices[e_info0.t_index];
         // edge CCW vertex indices are t0vi0, t0vi1
         size_t t0i = 0;
@@ -673,6 +842,7 @@ bool QuadricEdgeCollapse::create_no_volume(
         }
         for (size_t ei1 = v_info1.start; ei1 < v_info1_end; ++ei1) {
             const EdgeInfo &e_info1 = e_infos[ei1];
+            if (e_info1.t_index == ti0 || e_info1.t_index == ti1) continue;
             const Triangle &t1 = indices[e_info1.t_index];
             size_t t1i = 0;
             for (; t1i < 3; ++t1i) if (static_cast<uint32_t>(t1[t1i]) == t0vi1) break;            
@@ -825,6 +995,93 @@ void QuadricEdgeCollapse::change_neighbors(EdgeInfos &     e_infos,
     }
 }
 
+Collapse QuadricEdgeCollapse::find_collapse(uint32_t                    ti0,
+                                            float                       maximal_error,
+                                            const indexed_triangle_set &its,
+                                            const TriangleInfos &       t_infos,
+                                            const VertexInfos &         v_infos,
+                                            const EdgeInfos &           e_infos)
+{
+    const Triangle &t0 = its.indices[ti0];
+    Vec3d errors = calculate_3errors(t0, its.vertices, v_infos);
+    // try the triangle's edges from the cheapest one
+    std::array<unsigned char, 3> ord = { 0, 1, 2 };
+    std::sort(ord.begin(), ord.end(), [&errors](unsigned char i1, unsigned char i2) { return errors[i1] < errors[i2]; });
+    for (unsigned char min_index : ord) {
+        if (errors[min_index] >= maximal_error) break;
+        uint32_t vi0 = t0[min_index];
+        uint32_t vi1 = t0[(min_index + 1) % 3];
+        if (vi0 > vi1) std::swap(vi0, vi1);
+        const VertexInfo &v_info0 = v_infos[vi0];
+        const VertexInfo &v_info1 = v_infos[vi1];
+        auto ti1_opt = (v_info0.count < v_info1.count)?
+            find_triangle_index1(vi1, v_info0, ti0, e_infos, its.indices) :
+            find_triangle_index1(vi0, v_info1, ti0, e_infos, its.indices) ;
+        if (!ti1_opt.has_value()) continue; // edge has only one triangle
+        uint32_t ti1 = *ti1_opt;
+        SymMat q(v_info0.q);
+        q += v_info1.q;
+        Vec3f new_vertex0 = calculate_vertex(vi0, vi1, q, its.vertices);
+        if (degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
+            degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
+            create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
+            is_flipped(new_vertex0, ti0, ti1, v_info0, t_infos, e_infos, its) ||
+            is_flipped(new_vertex0, ti0, ti1, v_info1, t_infos, e_infos, its))
+            continue;
+        Collapse out;
+        out.value      = static_cast<float>(errors[min_index]);
+        out.ti0        = ti0;
+        out.ti1        = ti1;
+        out.vi0        = vi0;
+        out.vi1        = vi1;
+        out.new_vertex = new_vertex0;
+        return out;
+    }
+    return {};
+}
+
+void QuadricEdgeCollapse::compact_triangles(indexed_triangle_set &its,
+                                            TriangleInfos &       t_infos,
+                                            VertexInfos &         v_infos,
+                                            EdgeInfos &           e_infos,
+                                            Errors &              errors)
+{
+    uint32_t ti_new = 0;
+    for (uint32_t ti = 0; ti < t_infos.size(); ti++) {
+        if (t_infos[ti].is_deleted()) continue;
+        its.indices[ti_new] = its.indices[ti];
+        t_infos[ti_new]     = t_infos[ti];
+        errors[ti_new]      = errors[ti];
+        errors[ti_new].triangle_index = ti_new;
+        ++ti_new;
+    }
+    its.indices.erase(its.indices.begin() + ti_new, its.indices.end());
+    t_infos.erase(t_infos.begin() + ti_new, t_infos.end());
+    errors.erase(errors.begin() + ti_new, errors.end());
+
+    // create reference
+    for (VertexInfo &v_info : v_infos) v_info.count = 0;
+    for (const Triangle &t : its.indices)
+        for (size_t j = 0; j < 3; ++j) ++v_infos[t[j]].count;
+    uint32_t triangle_start = 0;
+    for (VertexInfo &v_info : v_infos) {
+        v_info.start = triangle_start;
+        triangle_start += v_info.count;
+        v_info.count = 0;
+    }
+    e_infos.resize(its.indices.size() * 3);
+    for (uint32_t ti = 0; ti < its.indices.size(); ti++) {
+        const Triangle &t = its.indices[ti];
+        for (unsigned char j = 0; j < 3; ++j) {
+            VertexInfo &v_info = v_infos[t[j]];
+            EdgeInfo &  e_info = e_infos[v_info.start + v_info.count];
+            e_info.t_index = ti;
+            e_info.edge    = j;
+            ++v_info.count;
+        }
+    }
+}
+
 void QuadricEdgeCollapse::compact(const VertexInfos &   v_infos,
                                   const TriangleInfos & t_infos,
                                   const EdgeInfos &     e_infos,
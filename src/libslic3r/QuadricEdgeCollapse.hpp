@@ -25,4 +25,19 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Simplify mesh by Quadric metric in rounds: a set of the cheapest edges
+/// with disjoint one-rings is collapsed in parallel, then the errors around
+/// the collapsed edges are updated before the next round.
+/// Faster than its_quadric_edge_collapse() on big meshes, the quality is about the same.
+/// Parameters are the same as of its_quadric_edge_collapse(),
+/// max_error returns the biggest error of a collapsed edge.
+/// </summary>
+void its_quadric_edge_collapse_par(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count  = 0,
+    float *                   max_error       = nullptr,
+    std::function<void(void)> throw_on_cancel = nullptr,
+    std::function<void(int)>  statusfn        = nullptr);
+
 } // namespace Slic3r
@@ -111,9 +111,25 @@ protected:
         return path;
     }
     
+    // Transform a point the same way as the paths created by to_path()
+    Vec2d to_raster_point(const Point &p)
+    {
+        Vec2d ret = m_trafo.flipXY ? Vec2d{getPy(p), getPx(p)} :
+                                     Vec2d{getPx(p), getPy(p)};
+        
+        ret.x() += m_trafo.center_x * m_pxdim_scaled.w_mm;
+        ret.y() += m_trafo.center_y * m_pxdim_scaled.h_mm;
+        
+        if(m_trafo.mirror_x) ret.x() = double(m_resolution.width_px) - ret.x();
+        if(m_trafo.mirror_y) ret.y() = double(m_resolution.height_px) - ret.y();
+        
+        return ret;
+    }
+    
     template<class P> void _draw(const P &poly)
     {
         m_rasterizer.reset();
+        m_rasterizer.filling_rule(agg::fill_non_zero);
         
         m_rasterizer.add_path(to_path(contour(poly)));
         for(auto& h : holes(poly)) m_rasterizer.add_path(to_path(h));
@@ -163,6 +179,20 @@ public:
     
     void draw(const ExPolygon &poly) override { _draw(poly); }
     
+    void draw(const Lines &segments, FillRule rule) override
+    {
+        m_rasterizer.reset();
+        m_rasterizer.filling_rule(rule == frEvenOdd ? agg::fill_even_odd :
+                                                      agg::fill_non_zero);
+        
+        for (const Line &l : segments) {
+            Vec2d a = to_raster_point(l.a), b = to_raster_point(l.b);
+            m_rasterizer.edge_d(a.x(), a.y(), b.x(), b.y());
+        }
+        
+        agg::render_scanlines(m_rasterizer, m_scanlines, m_renderer);
+    }
+    
     EncodedRaster encode(RasterEncoder encoder) const override
     {
         return encoder(m_buf.data(), m_resolution.width_px, m_resolution.height_px, 1);    
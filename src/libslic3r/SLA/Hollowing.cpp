@@ -42,11 +42,30 @@ struct Interior {
     }
 };
 
+struct InteriorGrid {
+    openvdb::FloatGrid::Ptr gridptr;
+    double voxel_scale = 1.;
+    float  out_range = 0.f; // narrow band width outwards
+    float  in_range = 0.f;  // narrow band width inwards
+
+    // Can the grid be used as a base for an interior with the given params
+    bool is_compatible(double vscale, float out_r, float in_r) const
+    {
+        return gridptr && is_approx(voxel_scale, vscale) &&
+               out_range >= out_r && in_range >= in_r;
+    }
+};
+
 void InteriorDeleter::operator()(Interior *p)
 {
     delete p;
 }
 
+void InteriorGridDeleter::operator()(InteriorGrid *p)
+{
+    delete p;
+}
+
 indexed_triangle_set &get_mesh(Interior &interior)
 {
     return interior.mesh;
@@ -57,11 +76,17 @@ const indexed_triangle_set &get_mesh(const Interior &interior)
     return interior.mesh;
 }
 
+// The inner narrow band of a cached grid is made wider than necessary by this
+// factor, so that increasing the wall thickness or closing distance a bit
+// does not invalidate the cache.
+static constexpr float CACHED_BAND_RESERVE = 1.5f;
+
 static InteriorPtr generate_interior_verbose(const TriangleMesh & mesh,
                                              const JobController &ctl,
                                              double min_thickness,
                                              double voxel_scale,
-                                             double closing_dist)
+                                             double closing_dist,
+                                             InteriorGridPtr *grid_cache = nullptr)
 {
     double offset = voxel_scale * min_thickness;
     double D = voxel_scale * closing_dist;
@@ -71,7 +96,22 @@ static InteriorPtr generate_interior_verbose(const TriangleMesh & mesh,
     if (ctl.stopcondition()) return {};
     else ctl.statuscb(0, L("Hollowing"));
 
-    auto gridptr = mesh_to_grid(mesh.its, {}, voxel_scale, out_range, in_range);
+    openvdb::FloatGrid::Ptr gridptr;
+    if (grid_cache && *grid_cache &&
+        (*grid_cache)->is_compatible(voxel_scale, out_range, in_range)) {
+        gridptr = (*grid_cache)->gridptr;
+    } else if (grid_cache) {
+        out_range *= CACHED_BAND_RESERVE;
+        in_range  *= CACHED_BAND_RESERVE;
+        gridptr = mesh_to_grid(mesh.its, {}, voxel_scale, out_range, in_range);
+
+        if (gridptr) {
+            grid_cache->reset(new InteriorGrid{gridptr, voxel_scale,
+                                               out_range, in_range});
+        }
+    } else {
+        gridptr = mesh_to_grid(mesh.its, {}, voxel_scale, out_range, in_range);
+    }
 
     assert(gridptr);
 
@@ -84,7 +124,7 @@ static InteriorPtr generate_interior_verbose(const TriangleMesh & mesh,
     else ctl.statuscb(30, L("Hollowing"));
 
     double iso_surface = D;
-    auto   narrowb = double(in_range);
+    auto   narrowb = 1.1 * (offset + D);
     gridptr = redistance_grid(*gridptr, -(offset + D), narrowb, narrowb);
 
     if (ctl.stopcondition()) return {};
@@ -108,9 +148,10 @@ static InteriorPtr generate_interior_verbose(const TriangleMesh & mesh,
     return interior;
 }
 
-InteriorPtr generate_interior(const TriangleMesh &   mesh,
-                              const HollowingConfig &hc,
-                              const JobController &  ctl)
+static InteriorPtr generate_interior_impl(const TriangleMesh &   mesh,
+                                          const HollowingConfig &hc,
+                                          const JobController &  ctl,
+                                          InteriorGridPtr *      grid_cache)
 {
     static const double MIN_OVERSAMPL = 3.5;
     static const double MAX_OVERSAMPL = 8.;
@@ -126,7 +167,7 @@ InteriorPtr generate_interior(const TriangleMesh &   mesh,
 
     InteriorPtr interior =
         generate_interior_verbose(mesh, ctl, hc.min_thickness, voxel_scale,
-                                  hc.closing_distance);
+                                  hc.closing_distance, grid_cache);
 
     if (interior && !interior->mesh.empty()) {
 
@@ -147,6 +188,21 @@ InteriorPtr generate_interior(const TriangleMesh &   mesh,
     return interior;
 }
 
+InteriorPtr generate_interior(const TriangleMesh &   mesh,
+                              const HollowingConfig &hc,
+                              const JobController &  ctl)
+{
+    return generate_interior_impl(mesh, hc, ctl, nullptr);
+}
+
+InteriorPtr generate_interior(const TriangleMesh &   mesh,
+                              const HollowingConfig &hc,
+                              const JobController &  ctl,
+                              InteriorGridPtr &      grid_cache)
+{
+    return generate_interior_impl(mesh, hc, ctl, &grid_cache);
+}
+
 indexed_triangle_set DrainHole::to_mesh() const
 {
     auto r = double(radius);
@@ -28,6 +28,15 @@ using  InteriorPtr = std::unique_ptr<Interior, InteriorDeleter>;
 indexed_triangle_set &      get_mesh(Interior &interior);
 const indexed_triangle_set &get_mesh(const Interior &interior);
 
+// The signed distance grid of the input mesh, which is the most expensive
+// intermediate result of interior generation. It can be kept between
+// subsequent generate_interior() calls to skip the mesh to grid conversion
+// when only the wall thickness or the closing distance changes. It has to be
+// dropped by the owner whenever the input mesh changes.
+struct InteriorGrid;
+struct InteriorGridDeleter { void operator()(InteriorGrid *p); };
+using  InteriorGridPtr = std::unique_ptr<InteriorGrid, InteriorGridDeleter>;
+
 struct DrainHole
 {
     Vec3f pos;
@@ -74,6 +83,14 @@ InteriorPtr generate_interior(const TriangleMesh &mesh,
                               const HollowingConfig &  = {},
                               const JobController &ctl = {});
 
+// Same as above, but the signed distance grid of the mesh is taken from
+// grid_cache if it is compatible with the requested config. Otherwise it is
+// regenerated and stored in grid_cache for the next call.
+InteriorPtr generate_interior(const TriangleMesh &   mesh,
+                              const HollowingConfig &hc,
+                              const JobController &  ctl,
+                              InteriorGridPtr &      grid_cache);
+
 // Will do the hollowing
 void hollow_mesh(TriangleMesh &mesh, const HollowingConfig &cfg, int flags = 0);
 
@@ -1,6 +1,7 @@
 #include <libslic3r/SLA/Pad.hpp>
 #include <libslic3r/SLA/SpatIndex.hpp>
 #include <libslic3r/SLA/BoostAdapter.hpp>
+#include <libslic3r/SLA/Concurrency.hpp>
 //#include <libslic3r/SLA/Contour3D.hpp>
 #include <libslic3r/TriangleMeshSlicer.hpp>
 
@@ -50,6 +51,15 @@ inline indexed_triangle_set straight_walls(const Polygon &plate,
     return walls(plate, plate, lo_z, hi_z);
 }
 
+// Triangulated horizontal plate at the given height.
+inline indexed_triangle_set plate(const ExPolygon &poly, double z, bool flip)
+{
+    indexed_triangle_set ret;
+    its_merge(ret, triangulate_expolygon_3d(poly, z, flip));
+
+    return ret;
+}
+
 // Function to cut tiny connector cavities for a given polygon. The input poly
 // will be offsetted by "padding" and small rectangle shaped cavities will be
 // inserted along the perimeter in every "stride" distance. The stick rectangles
@@ -355,10 +365,36 @@ ExPolygon offset_contour_only(const ExPolygon &poly, coord_t delta, Args...args)
     return std::move(tmp2.front());
 }
 
-bool add_cavity(indexed_triangle_set &pad,
-                ExPolygon &           top_poly,
-                const PadConfig3D &   cfg,
-                ThrowOnCancel         thr)
+// Independent pieces of the pad mesh (wall strips and plates). The pieces are
+// triangulated in parallel and merged in the order of their insertion, so the
+// output does not depend on the scheduling.
+class PadMeshJobs {
+    std::vector<std::function<indexed_triangle_set()>> m_jobs;
+
+public:
+    template<class Fn> void add(Fn &&fn)
+    {
+        m_jobs.emplace_back(std::forward<Fn>(fn));
+    }
+
+    indexed_triangle_set merge(ThrowOnCancel thr) const
+    {
+        std::vector<indexed_triangle_set> parts(m_jobs.size());
+        ccr::for_each(size_t(0), m_jobs.size(), [this, &parts, &thr](size_t i) {
+            thr();
+            parts[i] = m_jobs[i]();
+        });
+
+        indexed_triangle_set ret;
+        for (const indexed_triangle_set &p : parts) its_merge(ret, p);
+
+        return ret;
+    }
+};
+
+bool add_cavity(PadMeshJobs &        jobs,
+                ExPolygon &          top_poly,
+                const PadConfig3D &  cfg)
 {
     auto logerr = []{BOOST_LOG_TRIVIAL(error)<<"Could not create pad cavity";};
 
@@ -377,62 +413,62 @@ bool add_cavity(indexed_triangle_set &pad,
     top_poly = pdiff.front();
 
     double z_min = -cfg.wing_height, z_max = 0;
-    its_merge(pad, walls(inner_base.contour, middle_base.contour, z_min, z_max));
-    thr();
-    its_merge(pad, triangulate_expolygon_3d(inner_base, z_min, NORMALS_UP));
+    jobs.add([inner = inner_base.contour, middle = middle_base.contour, z_min, z_max] {
+        return walls(inner, middle, z_min, z_max);
+    });
+    jobs.add([inner_base, z_min] {
+        return plate(inner_base, z_min, NORMALS_UP);
+    });
 
     return true;
 }
 
-indexed_triangle_set create_outer_pad_geometry(const ExPolygons & skeleton,
-                                               const PadConfig3D &cfg,
-                                               ThrowOnCancel      thr)
+void add_outer_pad_part(PadMeshJobs &       jobs,
+                        const ExPolygon &   pad_part,
+                        const PadConfig3D & cfg)
 {
-    indexed_triangle_set ret;
+    ExPolygon top_poly{pad_part};
+    ExPolygon bottom_poly =
+        offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
 
-    for (const ExPolygon &pad_part : skeleton) {
-        ExPolygon top_poly{pad_part};
-        ExPolygon bottom_poly =
-            offset_contour_only(pad_part, -scaled(cfg.bottom_offset()));
+    if (bottom_poly.empty()) return;
 
-        if (bottom_poly.empty()) continue;
-        thr();
-        
-        double z_min = -cfg.height, z_max = 0;
-        its_merge(ret, walls(top_poly.contour, bottom_poly.contour, z_max, z_min));
+    double z_min = -cfg.height, z_max = 0;
+    jobs.add([top = top_poly.contour, bottom = bottom_poly.contour, z_min, z_max] {
+        return walls(top, bottom, z_max, z_min);
+    });
 
-        if (cfg.wing_height > 0. && add_cavity(ret, top_poly, cfg, thr))
-            z_max = -cfg.wing_height;
+    if (cfg.wing_height > 0. && add_cavity(jobs, top_poly, cfg))
+        z_max = -cfg.wing_height;
 
-        for (auto &h : bottom_poly.holes)
-            its_merge(ret, straight_walls(h, z_max, z_min));
-        
-        its_merge(ret, triangulate_expolygon_3d(bottom_poly, z_min, NORMALS_DOWN));
-        its_merge(ret, triangulate_expolygon_3d(top_poly, NORMALS_UP));
-    }
+    for (const Polygon &h : bottom_poly.holes)
+        jobs.add([h, z_min, z_max] { return straight_walls(h, z_max, z_min); });
 
-    return ret;
+    jobs.add([bottom_poly, z_min] {
+        return plate(bottom_poly, z_min, NORMALS_DOWN);
+    });
+    jobs.add([top_poly] { return plate(top_poly, 0., NORMALS_UP); });
 }
 
-indexed_triangle_set create_inner_pad_geometry(const ExPolygons & skeleton,
-                                               const PadConfig3D &cfg,
-                                               ThrowOnCancel      thr)
+void add_inner_pad_part(PadMeshJobs &       jobs,
+                        const ExPolygon &   pad_part,
+                        const PadConfig3D & cfg)
 {
-    indexed_triangle_set ret;
-
     double z_max = 0., z_min = -cfg.height;
-    for (const ExPolygon &pad_part : skeleton) {
-        thr();
-        its_merge(ret, straight_walls(pad_part.contour, z_max, z_min));
 
-        for (auto &h : pad_part.holes)
-            its_merge(ret, straight_walls(h, z_max, z_min));
-    
-        its_merge(ret, triangulate_expolygon_3d(pad_part, z_min, NORMALS_DOWN));
-        its_merge(ret, triangulate_expolygon_3d(pad_part, z_max, NORMALS_UP));
-    }
+    jobs.add([contour = pad_part.contour, z_min, z_max] {
+        return straight_walls(contour, z_max, z_min);
+    });
 
-    return ret;
+    for (const Polygon &h : pad_part.holes)
+        jobs.add([h, z_min, z_max] { return straight_walls(h, z_max, z_min); });
+
+    jobs.add([pad_part, z_min] {
+        return plate(pad_part, z_min, NORMALS_DOWN);
+    });
+    jobs.add([pad_part, z_max] {
+        return plate(pad_part, z_max, NORMALS_UP);
+    });
 }
 
 indexed_triangle_set create_pad_geometry(const PadSkeleton &skelet,
@@ -447,10 +483,17 @@ indexed_triangle_set create_pad_geometry(const PadSkeleton &skelet,
 #endif
 
     PadConfig3D cfg3d(cfg);
-    auto pg = create_outer_pad_geometry(skelet.outer, cfg3d, thr);
-    its_merge(pg, create_inner_pad_geometry(skelet.inner, cfg3d, thr));
+    PadMeshJobs jobs;
+
+    for (const ExPolygon &pad_part : skelet.outer) {
+        thr();
+        add_outer_pad_part(jobs, pad_part, cfg3d);
+    }
+
+    for (const ExPolygon &pad_part : skelet.inner)
+        add_inner_pad_part(jobs, pad_part, cfg3d);
 
-    return pg;
+    return jobs.merge(thr);
 }
 
 indexed_triangle_set create_pad_geometry(const ExPolygons &supp_bp,
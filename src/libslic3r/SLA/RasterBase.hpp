@@ -84,11 +84,18 @@ public:
         {}
     };
     
+    /// Filling rule for drawing unordered sets of oriented segments.
+    enum FillRule { frNonZero, frEvenOdd };
+    
     virtual ~RasterBase() = default;
     
     /// Draw a polygon with holes.
     virtual void draw(const ExPolygon& poly) = 0;
     
+    /// Draw the area bounded by a set of oriented segments which together
+    /// form closed contours, but do not need to be chained or ordered.
+    virtual void draw(const Lines &segments, FillRule rule) = 0;
+    
     /// Get the resolution of the raster.
     virtual Resolution resolution() const = 0;
     virtual PixelDim   pixel_dimensions() const = 0;
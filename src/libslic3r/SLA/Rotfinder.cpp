@@ -1,11 +1,12 @@
 #include <limits>
+#include <numeric>
+#include <atomic>
 
 #include <libslic3r/SLA/Rotfinder.hpp>
 
 #include <libslic3r/Execution/ExecutionTBB.hpp>
 #include <libslic3r/Execution/ExecutionSeq.hpp>
 
-#include <libslic3r/Optimize/BruteforceOptimizer.hpp>
 #include <libslic3r/Optimize/NLoptOptimizer.hpp>
 
 #include "libslic3r/SLAPrint.hpp"
@@ -73,36 +74,97 @@ struct Facestats {
     }
 };
 
+// A compact proxy of a mesh used to score rotations quickly. The faces are
+// clustered by their normals into a fixed spherical grid and each cluster only
+// keeps the area weighted mean normal and the accumulated face areas. A score
+// evaluation then costs O(bins) instead of O(faces).
+class NormalHistogram {
+public:
+    struct Bin {
+        Vec3f  normal    = Vec3f::Zero(); // area weighted mean normal
+        double area      = 0.;            // sum of face areas
+        double sqrt_area = 0.;            // sum of square roots of face areas
+    };
+
+    static constexpr size_t THETA_BINS = 64;
+    static constexpr size_t PHI_BINS   = 2 * THETA_BINS;
+
+private:
+    std::vector<Bin> m_bins;
+    size_t           m_facecount = 0;
+
+    static size_t bin_index(const Vec3f &n)
+    {
+        float theta = std::acos(std::clamp(n.z(), -1.f, 1.f));
+        float phi   = std::atan2(n.y(), n.x()) + float(PI);
+
+        auto ti = size_t(theta / float(PI) * THETA_BINS);
+        auto pi = size_t(phi / float(2 * PI) * PHI_BINS);
+
+        return std::min(ti, THETA_BINS - 1) * PHI_BINS + std::min(pi, PHI_BINS - 1);
+    }
+
+public:
+    explicit NormalHistogram(const TriangleMesh &mesh)
+        : m_facecount{mesh.its.indices.size()}
+    {
+        struct FaceBin { size_t idx; Vec3f normal; double area; };
+
+        std::vector<FaceBin> facebins(m_facecount);
+        size_t Nthreads = std::thread::hardware_concurrency();
+        execution::for_each(ex_tbb, size_t(0), m_facecount,
+            [&mesh, &facebins](size_t fi) {
+                Facestats fc{get_triangle_vertices(mesh, fi)};
+                if (fc.area > 0. && fc.normal.allFinite())
+                    facebins[fi] = {bin_index(fc.normal), fc.normal, fc.area};
+                else
+                    facebins[fi] = {size_t(-1), Vec3f::Zero(), 0.};
+            }, std::max(size_t(1), m_facecount / std::max(size_t(1), Nthreads)));
+
+        std::vector<Bin> grid(THETA_BINS * PHI_BINS);
+        for (const FaceBin &fb : facebins) {
+            if (fb.idx == size_t(-1)) continue;
+
+            Bin &b = grid[fb.idx];
+            b.normal    += float(fb.area) * fb.normal;
+            b.area      += fb.area;
+            b.sqrt_area += std::sqrt(fb.area);
+        }
+
+        for (Bin &b : grid)
+            if (b.area > 0.) {
+                b.normal.normalize();
+                m_bins.emplace_back(b);
+            }
+    }
+
+    const std::vector<Bin> &bins() const { return m_bins; }
+    size_t facecount() const { return m_facecount; }
+    bool empty() const { return m_bins.empty(); }
+};
+
 // Try to guess the number of support points needed to support a mesh
-double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
+double get_misalginment_score(const NormalHistogram &hist, const Transform3f &tr)
 {
-    if (mesh.its.vertices.empty()) return std::nan("");
+    if (hist.empty()) return std::nan("");
 
-    auto accessfn = [&mesh, &tr](size_t fi) {
-        Facestats fc{get_transformed_triangle(mesh, tr, fi)};
-
-        float score = fc.area
-                      * (std::abs(fc.normal.dot(Vec3f::UnitX()))
-                         + std::abs(fc.normal.dot(Vec3f::UnitY()))
-                         + std::abs(fc.normal.dot(Vec3f::UnitZ())));
+    double S = 0.;
+    for (const NormalHistogram::Bin &b : hist.bins()) {
+        Vec3f n = tr.linear() * b.normal;
 
         // We should score against the alignment with the reference planes
-        return scaled<int_fast64_t>(score);
-    };
-
-    size_t facecount = mesh.its.indices.size();
-    size_t Nthreads  = std::thread::hardware_concurrency();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+        S += b.area * (std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z()));
+    }
 
-    return S / facecount;
+    return S / hist.facecount();
 }
 
 // The score function for a particular face
-inline double get_supportedness_score(const Facestats &fc)
+inline double get_supportedness_score(const Vec3f &normal, double sqrt_area)
 {
     // Simply get the angle (acos of dot product) between the face normal and
     // the DOWN vector.
-    float cosphi = fc.normal.dot(DOWN);
+    float cosphi = std::clamp(normal.dot(DOWN), -1.f, 1.f);
     float phi = 1.f - std::acos(cosphi) / float(PI);
 
     // Make the huge slopes more significant than the smaller slopes
@@ -111,22 +173,55 @@ inline double get_supportedness_score(const Facestats &fc)
     // Multiply with the square root of face area of the current face,
     // the area is less important as it grows.
     // This makes many smaller overhangs a bigger impact.
-    return std::sqrt(fc.area) * POINTS_PER_UNIT_AREA * phi;
+    return sqrt_area * POINTS_PER_UNIT_AREA * phi;
+}
+
+inline double get_supportedness_score(const Facestats &fc)
+{
+    return get_supportedness_score(fc.normal, std::sqrt(fc.area));
 }
 
 // Try to guess the number of support points needed to support a mesh
+double get_supportedness_score(const NormalHistogram &hist, const Transform3f &tr)
+{
+    if (hist.empty()) return std::nan("");
+
+    double S = 0.;
+    for (const NormalHistogram::Bin &b : hist.bins())
+        S += get_supportedness_score(Vec3f{tr.linear() * b.normal}, b.sqrt_area);
+
+    return S / hist.facecount();
+}
+
+// Exact counterparts of the scores above, evaluated on every face of the mesh.
+double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
+{
+    if (mesh.its.vertices.empty()) return std::nan("");
+
+    auto accessfn = [&mesh, &tr](size_t fi) {
+        Facestats fc{get_transformed_triangle(mesh, tr, fi)};
+        return fc.area * (std::abs(fc.normal.x()) + std::abs(fc.normal.y()) + std::abs(fc.normal.z()));
+    };
+
+    size_t facecount = mesh.its.indices.size();
+    size_t Nthreads  = std::thread::hardware_concurrency();
+    double S = sum_score<double>(accessfn, facecount, Nthreads);
+
+    return S / facecount;
+}
+
 double get_supportedness_score(const TriangleMesh &mesh, const Transform3f &tr)
 {
     if (mesh.its.vertices.empty()) return std::nan("");
 
     auto accessfn = [&mesh, &tr](size_t fi) {
         Facestats fc{get_transformed_triangle(mesh, tr, fi)};
-        return scaled<int_fast64_t>(get_supportedness_score(fc));
+        return fc.area > 0. ? get_supportedness_score(fc) : 0.;
     };
 
     size_t facecount = mesh.its.indices.size();
     size_t Nthreads  = std::thread::hardware_concurrency();
-    double S = unscaled(sum_score<int_fast64_t>(accessfn, facecount, Nthreads));
+    double S = sum_score<double>(accessfn, facecount, Nthreads);
 
     return S / facecount;
 }
@@ -280,6 +375,81 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
     return ret;
 }
 
+// Multi-start search over the rotations around the X and Y axes. A coarse
+// grid of rotations is scored in parallel first, then the best few grid
+// points are refined concurrently with a local subplex optimizer, each one
+// confined to the neighborhood of its starting grid cell.
+template<class Fn, class StopCond>
+XYRotation find_best_rotation_multistart(Fn &&fn,
+                                         bool to_min,
+                                         size_t gridsize,
+                                         size_t num_starts,
+                                         unsigned local_iters,
+                                         StopCond &&stopfn)
+{
+    gridsize = std::max(gridsize, size_t(2));
+
+    // Turn every search into a minimization, unscorable inputs are skipped
+    double sgn = to_min ? 1. : -1.;
+    auto score = [&fn, sgn](const XYRotation &rot) {
+        double s = sgn * fn(rot);
+        return std::isnan(s) ? std::numeric_limits<double>::max() : s;
+    };
+
+    double step = 2 * PI / (gridsize - 1);
+    auto grid = reserve_vector<XYRotation>(gridsize * gridsize);
+    for (size_t i = 0; i < gridsize; ++i)
+        for (size_t j = 0; j < gridsize; ++j)
+            grid.push_back({-PI + i * step, -PI + j * step});
+
+    std::vector<double> scores(grid.size(), std::numeric_limits<double>::max());
+    size_t Nthreads = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+
+    execution::for_each(
+        ex_tbb, size_t(0), grid.size(), [&stopfn, &scores, &score, &grid](size_t i) {
+            if (stopfn()) return;
+
+            scores[i] = score(grid[i]);
+        },
+        std::max(size_t(1), grid.size() / Nthreads));
+
+    std::vector<size_t> order(grid.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    num_starts = std::min(num_starts, order.size());
+    std::partial_sort(order.begin(), order.begin() + num_starts, order.end(),
+                      [&scores](size_t a, size_t b) { return scores[a] < scores[b]; });
+
+    std::vector<opt::Result<2>> results(num_starts);
+    execution::for_each(
+        ex_tbb, size_t(0), num_starts,
+        [&](size_t s) {
+            const XYRotation &start = grid[order[s]];
+            results[s].optimum = start;
+            results[s].score   = scores[order[s]];
+
+            if (stopfn() || !local_iters) return;
+
+            opt::Optimizer<opt::AlgNLoptSubplex> solver(
+                opt::StopCriteria{}.max_iterations(local_iters)
+                                   .rel_score_diff(1e-6)
+                                   .stop_condition([&stopfn] { return stopfn(); }));
+
+            auto bounds = opt::bounds({ {start[X] - step, start[X] + step},
+                                        {start[Y] - step, start[Y] + step} });
+
+            opt::Result<2> r = solver.to_min().optimize(score, start, bounds);
+            if (r.score < results[s].score)
+                results[s] = r;
+        });
+
+    auto it = std::min_element(results.begin(), results.end(),
+                               [](const opt::Result<2> &a, const opt::Result<2> &b) {
+                                   return a.score < b.score;
+                               });
+
+    return it == results.end() ? XYRotation{0., 0.} : it->optimum;
+}
+
 } // namespace
 
 
@@ -288,10 +458,13 @@ template<unsigned MAX_ITER>
 struct RotfinderBoilerplate {
     static constexpr unsigned MAX_TRIES = MAX_ITER;
 
-    int status = 0;
+    // Number of local refinements in a multi-start search
+    static constexpr size_t NUM_STARTS = 8;
+
+    std::atomic<int> status = 0;
     TriangleMesh mesh;
-    unsigned max_tries;
     const RotOptimizeParams &params;
+    unsigned max_tries;
 
     // Assemble the mesh with the correct transformation to be used in rotation
     // optimization.
@@ -320,6 +493,18 @@ struct RotfinderBoilerplate {
 
     }
 
+    // Number of grid samples per dimension and iterations of each local
+    // refinement, so that a multi-start search stays within max_tries.
+    size_t gridsize() const { return std::max(size_t(2), size_t(std::sqrt(max_tries / 2.))); }
+    unsigned local_iters() const { return (max_tries / 2) / NUM_STARTS; }
+
+    // Set max_tries to the actual number of evaluations of a multi-start search
+    void prepare_multistart()
+    {
+        size_t gs = gridsize();
+        max_tries = unsigned(gs * gs + NUM_STARTS * local_iters());
+    }
+
     void statusfn() { params.statuscb()(++status * 100.0 / max_tries); }
     bool stopcond() { return ! params.statuscb()(-1); }
 };
@@ -328,28 +513,21 @@ Vec2d find_best_misalignment_rotation(const ModelObject &      mo,
                                       const RotOptimizeParams &params)
 {
     RotfinderBoilerplate<1000> bp{mo, params};
+    NormalHistogram hist{bp.mesh};
 
-    // Preparing the optimizer.
-    size_t gridsize = std::sqrt(bp.max_tries);
-    opt::Optimizer<opt::AlgBruteForce> solver(
-        opt::StopCriteria{}.max_iterations(bp.max_tries)
-                           .stop_condition([&bp] { return bp.stopcond(); }),
-        gridsize
-    );
+    bp.prepare_multistart();
 
     // We are searching rotations around only two axes x, y. Thus the
     // problem becomes a 2 dimensional optimization task.
-    // We can specify the bounds for a dimension in the following way:
-    auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
-
-    auto result = solver.to_max().optimize(
-        [&bp] (const XYRotation &rot)
-        {
+    XYRotation rot = find_best_rotation_multistart(
+        [&bp, &hist](const XYRotation &rot) {
             bp.statusfn();
-            return get_misalginment_score(bp.mesh, to_transform3f(rot));
-        }, opt::initvals({0., 0.}), bounds);
+            return get_misalginment_score(hist, to_transform3f(rot));
+        },
+        false, bp.gridsize(), bp.NUM_STARTS, bp.local_iters(),
+        [&bp] { return bp.stopcond(); });
 
-    return {result.optimum[0], result.optimum[1]};
+    return {rot[0], rot[1]};
 }
 
 Vec2d find_least_supports_rotation(const ModelObject &      mo,
@@ -385,28 +563,18 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
         });
 
     } else {
-        // Preparing the optimizer.
-        size_t gridsize = std::sqrt(bp.max_tries); // 2D grid has gridsize^2 calls
-        opt::Optimizer<opt::AlgBruteForce> solver(
-            opt::StopCriteria{}.max_iterations(bp.max_tries)
-                               .stop_condition([&bp] { return bp.stopcond(); }),
-            gridsize
-        );
+        NormalHistogram hist{bp.mesh};
+        bp.prepare_multistart();
 
         // We are searching rotations around only two axes x, y. Thus the
         // problem becomes a 2 dimensional optimization task.
-        // We can specify the bounds for a dimension in the following way:
-        auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
-
-        auto result = solver.to_min().optimize(
-            [&bp] (const XYRotation &rot)
-            {
+        rot = find_best_rotation_multistart(
+            [&bp, &hist](const XYRotation &rot) {
                 bp.statusfn();
-                return get_supportedness_score(bp.mesh, to_transform3f(rot));
-            }, opt::initvals({0., 0.}), bounds);
-
-        // Save the result
-        rot = result.optimum;
+                return get_supportedness_score(hist, to_transform3f(rot));
+            },
+            true, bp.gridsize(), bp.NUM_STARTS, bp.local_iters(),
+            [&bp] { return bp.stopcond(); });
     }
 
     return {rot[0], rot[1]};
@@ -473,4 +641,18 @@ Vec2d find_min_z_height_rotation(const ModelObject &mo,
     return {rot[0], rot[1]};
 }
 
+double get_misalignment_score(const TriangleMesh &mesh, const Vec2d &rot, bool exact)
+{
+    Transform3f tr = to_transform3f({rot.x(), rot.y()});
+    return exact ? get_misalginment_score(mesh, tr) :
+                   get_misalginment_score(NormalHistogram{mesh}, tr);
+}
+
+double get_supportedness_score(const TriangleMesh &mesh, const Vec2d &rot, bool exact)
+{
+    Transform3f tr = to_transform3f({rot.x(), rot.y()});
+    return exact ? get_supportedness_score(mesh, tr) :
+                   get_supportedness_score(NormalHistogram{mesh}, tr);
+}
+
 }} // namespace Slic3r::sla
@@ -66,6 +66,19 @@ Vec2d find_least_supports_rotation(const ModelObject &modelobj,
 Vec2d find_min_z_height_rotation(const ModelObject &mo,
                                  const RotOptimizeParams &params = {});
 
+/**
+  * The scores of the mesh rotated around the X and Y axes by rot, as
+  * maximized by find_best_misalignment_rotation() and minimized by
+  * find_least_supports_rotation() for elevated objects. The optimizers score
+  * the rotations on a histogram of the face normals of the mesh. If exact is
+  * true, the score is evaluated on every face of the mesh instead.
+  */
+double get_misalignment_score(const TriangleMesh &mesh, const Vec2d &rot,
+                              bool exact = false);
+
+double get_supportedness_score(const TriangleMesh &mesh, const Vec2d &rot,
+                               bool exact = false);
+
 } // namespace sla
 } // namespace Slic3r
 
@@ -34,47 +34,99 @@ void SupportTree::retrieve_full_mesh(indexed_triangle_set &outmesh) const {
 std::vector<ExPolygons> SupportTree::slice(const std::vector<float> &grid,
                                            float                     cr) const
 {
-    const indexed_triangle_set &sup_mesh = retrieve_mesh(MeshType::Support);
-    const indexed_triangle_set &pad_mesh = retrieve_mesh(MeshType::Pad);
-
-    using Slices = std::vector<ExPolygons>;
-    auto slices = reserve_vector<Slices>(2);
+    return merge_slices(slice(MeshType::Support, grid, cr),
+                        slice(MeshType::Pad, grid, cr), grid.size());
+}
 
-    if (!sup_mesh.empty()) {
-        slices.emplace_back();
-        slices.back() = slice_mesh_ex(sup_mesh, grid, cr, ctl().cancelfn);
-    }
+std::vector<ExPolygons> SupportTree::slice(MeshType                  meshtype,
+                                           const std::vector<float> &grid,
+                                           float                     cr) const
+{
+    const indexed_triangle_set &mesh = retrieve_mesh(meshtype);
 
-    if (!pad_mesh.empty()) {
-        slices.emplace_back();
+    if (mesh.empty())
+        return {};
 
-        auto bb = bounding_box(pad_mesh);
+    if (meshtype == MeshType::Pad) {
+        auto bb = bounding_box(mesh);
         auto maxzit = std::upper_bound(grid.begin(), grid.end(), bb.max.z());
-        
+
         auto cap = grid.end() - maxzit;
         auto padgrid = reserve_vector<float>(size_t(cap > 0 ? cap : 0));
         std::copy(grid.begin(), maxzit, std::back_inserter(padgrid));
 
-        slices.back() = slice_mesh_ex(pad_mesh, padgrid, cr, ctl().cancelfn);
+        return slice_mesh_ex(mesh, padgrid, cr, ctl().cancelfn);
     }
 
-    size_t len = grid.size();
-    for (const Slices &slv : slices) { len = std::min(len, slv.size()); }
+    return slice_mesh_ex(mesh, grid, cr, ctl().cancelfn);
+}
 
+std::vector<ExPolygons> SupportTree::merge_slices(std::vector<ExPolygons> &&support_slices,
+                                                  std::vector<ExPolygons> &&pad_slices,
+                                                  size_t gridsize)
+{
     // Either the support or the pad or both has to be non empty
-    if (slices.empty()) return {};
+    if (support_slices.empty())
+        return std::move(pad_slices);
+
+    size_t len = std::min(gridsize, support_slices.size());
+    if (!pad_slices.empty())
+        len = std::min(len, pad_slices.size());
+    else
+        return std::move(support_slices);
+
+    for (size_t i = 0; i < len; ++i) {
+        std::move(pad_slices[i].begin(), pad_slices[i].end(),
+                  std::back_inserter(support_slices[i]));
+        pad_slices[i] = {}; // clear and delete
+    }
 
-    Slices &mrg = slices.front();
+    return std::move(support_slices);
+}
 
-    for (auto it = std::next(slices.begin()); it != slices.end(); ++it) {
-        for (size_t i = 0; i < len; ++i) {
-            Slices &slv = *it;
-            std::copy(slv[i].begin(), slv[i].end(), std::back_inserter(mrg[i]));
-            slv[i] = {}; // clear and delete
+std::vector<ExPolygons> SupportTree::merge_slices(const std::vector<ExPolygons> &support_slices,
+                                                  std::vector<ExPolygons> &&pad_slices,
+                                                  size_t gridsize)
+{
+    if (support_slices.empty())
+        return std::move(pad_slices);
+
+    size_t len = std::min(gridsize, support_slices.size());
+    std::vector<ExPolygons> out(len);
+    for (size_t i = 0; i < len; ++i) {
+        size_t padcnt = i < pad_slices.size() ? pad_slices[i].size() : 0;
+        out[i].reserve(support_slices[i].size() + padcnt);
+        out[i].insert(out[i].end(), support_slices[i].begin(), support_slices[i].end());
+        if (padcnt > 0) {
+            std::move(pad_slices[i].begin(), pad_slices[i].end(),
+                      std::back_inserter(out[i]));
+            pad_slices[i] = {}; // clear and delete
         }
     }
 
-    return mrg;
+    return out;
+}
+
+const std::vector<ExPolygons> &SupportSlicesCache::slice(const SupportTree        &tree,
+                                                         const std::vector<float> &grid,
+                                                         float                     closing_radius)
+{
+    if (!m_valid || m_grid != grid || m_closing_radius != closing_radius) {
+        m_valid          = false;
+        m_slices         = tree.slice(MeshType::Support, grid, closing_radius);
+        m_grid           = grid;
+        m_closing_radius = closing_radius;
+        m_valid          = true;
+    }
+
+    return m_slices;
+}
+
+void SupportSlicesCache::clear()
+{
+    m_slices.clear();
+    m_grid.clear();
+    m_valid = false;
 }
 
 SupportTree::UPtr SupportTree::create(const SupportableMesh &sm,
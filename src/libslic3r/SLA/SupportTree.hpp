@@ -163,12 +163,49 @@ public:
     
     std::vector<ExPolygons> slice(const std::vector<float> &,
                                   float closing_radius) const;
+
+    /// Slice only the support or only the pad mesh. The pad is sliced only
+    /// up to its top, the returned vector can be shorter than the grid.
+    std::vector<ExPolygons> slice(MeshType meshtype,
+                                  const std::vector<float> &,
+                                  float closing_radius) const;
+
+    /// Merge the pad slices into the support slices, as returned by the
+    /// slice(MeshType...) method.
+    static std::vector<ExPolygons> merge_slices(std::vector<ExPolygons> &&support_slices,
+                                                std::vector<ExPolygons> &&pad_slices,
+                                                size_t gridsize);
+
+    /// Same as above, the support slices are kept intact.
+    static std::vector<ExPolygons> merge_slices(const std::vector<ExPolygons> &support_slices,
+                                                std::vector<ExPolygons> &&pad_slices,
+                                                size_t gridsize);
     
     void retrieve_full_mesh(indexed_triangle_set &outmesh) const;
     
     const JobController &ctl() const { return m_ctl; }
 };
 
+/// Slices of the support mesh of a support tree (without the pad). The slices
+/// are kept to avoid slicing the tree again when only the pad is regenerated.
+class SupportSlicesCache
+{
+    std::vector<ExPolygons> m_slices;
+    std::vector<float>      m_grid;
+    float                   m_closing_radius = 0.f;
+    bool                    m_valid = false;
+
+public:
+    /// Returns the kept slices if they were sliced for the same grid and
+    /// closing radius, otherwise slices the support mesh of the tree.
+    const std::vector<ExPolygons> &slice(const SupportTree        &tree,
+                                         const std::vector<float> &grid,
+                                         float                     closing_radius);
+
+    /// Has to be called whenever the support mesh changes.
+    void clear();
+};
+
 }
 
 }
@@ -28,18 +28,21 @@ Pad::Pad(const indexed_triangle_set &support_mesh,
          double                      ground_level,
          const PadConfig &           pcfg,
          ThrowOnCancel               thr)
+    : Pad{support_blueprint(support_mesh, ground_level, pcfg, thr),
+          model_contours, ground_level, pcfg, thr}
+{}
+
+Pad::Pad(const ExPolygons &support_contours,
+         const ExPolygons &model_contours,
+         double            ground_level,
+         const PadConfig & pcfg,
+         ThrowOnCancel     thr)
     : cfg(pcfg)
     , zlevel(ground_level + pcfg.full_height() - pcfg.required_elevation())
 {
     thr();
-    
-    ExPolygons sup_contours;
-    
-    float zstart = float(zlevel);
-    float zend   = zstart + float(pcfg.full_height() + EPSILON);
-    
-    pad_blueprint(support_mesh, sup_contours, grid(zstart, zend, 0.1f), thr);
-    create_pad(sup_contours, model_contours, tmesh, pcfg);
+
+    create_pad(support_contours, model_contours, tmesh, pcfg, thr);
     
     Vec3f offs{.0f, .0f, float(zlevel)};
     for (auto &p : tmesh.vertices) p += offs;
@@ -47,10 +50,46 @@ Pad::Pad(const indexed_triangle_set &support_mesh,
     its_merge_vertices(tmesh);
 }
 
+std::array<float, 2> Pad::blueprint_range(double           ground_level,
+                                          const PadConfig &pcfg)
+{
+    float zstart = float(ground_level + pcfg.full_height() -
+                         pcfg.required_elevation());
+    float zend   = zstart + float(pcfg.full_height() + EPSILON);
+
+    return {zstart, zend};
+}
+
+ExPolygons Pad::support_blueprint(const indexed_triangle_set &support_mesh,
+                                  double                      ground_level,
+                                  const PadConfig &           pcfg,
+                                  ThrowOnCancel               thr)
+{
+    thr();
+
+    ExPolygons sup_contours;
+    auto [zstart, zend] = blueprint_range(ground_level, pcfg);
+    pad_blueprint(support_mesh, sup_contours, grid(zstart, zend, 0.1f), thr);
+
+    return sup_contours;
+}
+
 const indexed_triangle_set &SupportTreeBuilder::add_pad(
     const ExPolygons &modelbase, const PadConfig &cfg)
 {
-    m_pad = Pad{merged_mesh(), modelbase, ground_level, cfg, ctl().cancelfn};
+    const indexed_triangle_set &support_mesh = merged_mesh();
+    std::array<float, 2> rng = Pad::blueprint_range(ground_level, cfg);
+
+    std::lock_guard<Mutex> lk(m_mutex);
+    if (!m_pad_blueprint_valid || m_pad_blueprint_range != rng) {
+        m_pad_blueprint_valid = false;
+        m_pad_blueprint = Pad::support_blueprint(support_mesh, ground_level,
+                                                 cfg, ctl().cancelfn);
+        m_pad_blueprint_range = rng;
+        m_pad_blueprint_valid = true;
+    }
+
+    m_pad = Pad{m_pad_blueprint, modelbase, ground_level, cfg, ctl().cancelfn};
     return m_pad.tmesh;
 }
 
@@ -64,6 +103,9 @@ SupportTreeBuilder::SupportTreeBuilder(SupportTreeBuilder &&o)
     , m_meshcache{std::move(o.m_meshcache)}
     , m_meshcache_valid{o.m_meshcache_valid}
     , m_model_height{o.m_model_height}
+    , m_pad_blueprint{std::move(o.m_pad_blueprint)}
+    , m_pad_blueprint_range{o.m_pad_blueprint_range}
+    , m_pad_blueprint_valid{o.m_pad_blueprint_valid}
     , ground_level{o.ground_level}
 {}
 
@@ -77,6 +119,9 @@ SupportTreeBuilder::SupportTreeBuilder(const SupportTreeBuilder &o)
     , m_meshcache{o.m_meshcache}
     , m_meshcache_valid{o.m_meshcache_valid}
     , m_model_height{o.m_model_height}
+    , m_pad_blueprint{o.m_pad_blueprint}
+    , m_pad_blueprint_range{o.m_pad_blueprint_range}
+    , m_pad_blueprint_valid{o.m_pad_blueprint_valid}
     , ground_level{o.ground_level}
 {}
 
@@ -91,6 +136,9 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(SupportTreeBuilder &&o)
     m_meshcache = std::move(o.m_meshcache);
     m_meshcache_valid = o.m_meshcache_valid;
     m_model_height = o.m_model_height;
+    m_pad_blueprint = std::move(o.m_pad_blueprint);
+    m_pad_blueprint_range = o.m_pad_blueprint_range;
+    m_pad_blueprint_valid = o.m_pad_blueprint_valid;
     ground_level = o.ground_level;
     return *this;
 }
@@ -106,6 +154,9 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(const SupportTreeBuilder &o)
     m_meshcache = o.m_meshcache;
     m_meshcache_valid = o.m_meshcache_valid;
     m_model_height = o.m_model_height;
+    m_pad_blueprint = o.m_pad_blueprint;
+    m_pad_blueprint_range = o.m_pad_blueprint_range;
+    m_pad_blueprint_valid = o.m_pad_blueprint_valid;
     ground_level = o.ground_level;
     return *this;
 }
@@ -119,7 +170,7 @@ void SupportTreeBuilder::add_pillar_base(long pid, double baseheight, double rad
                              std::max(radius, pll.r), pll.r);
 
     m_pedestals.back().id = m_pedestals.size() - 1;
-    m_meshcache_valid = false;
+    invalidate_meshcache();
 }
 
 const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
@@ -1,6 +1,8 @@
 #ifndef SLA_SUPPORTTREEBUILDER_HPP
 #define SLA_SUPPORTTREEBUILDER_HPP
 
+#include <array>
+
 #include <libslic3r/SLA/Concurrency.hpp>
 #include <libslic3r/SLA/SupportTree.hpp>
 //#include <libslic3r/SLA/Contour3D.hpp>
@@ -200,6 +202,24 @@ struct Pad {
         const PadConfig &           pcfg,
         ThrowOnCancel               thr);
 
+    // Same as above with the blueprint of the support mesh already at hand
+    // (see support_blueprint()).
+    Pad(const ExPolygons &support_contours,
+        const ExPolygons &model_contours,
+        double            ground_level,
+        const PadConfig & pcfg,
+        ThrowOnCancel     thr);
+
+    // The height range of the support mesh sampled for the pad blueprint.
+    static std::array<float, 2> blueprint_range(double           ground_level,
+                                                const PadConfig &pcfg);
+
+    // Sample the silhouette of the support mesh in the blueprint_range().
+    static ExPolygons support_blueprint(const indexed_triangle_set &support_mesh,
+                                        double                      ground_level,
+                                        const PadConfig &           pcfg,
+                                        ThrowOnCancel               thr);
+
     bool empty() const { return tmesh.indices.size() == 0; }
 };
 
@@ -237,6 +257,21 @@ class SupportTreeBuilder: public SupportTree {
     mutable Mutex m_mutex;
     mutable bool m_meshcache_valid = false;
     mutable double m_model_height = 0; // the full height of the model
+
+    // Silhouette of the merged support mesh sampled by the last add_pad()
+    // call. Regenerating the pad with different parameters can reuse it, as
+    // long as the support mesh and the sampled height range are the same.
+    ExPolygons           m_pad_blueprint;
+    std::array<float, 2> m_pad_blueprint_range = {0.f, 0.f};
+    bool                 m_pad_blueprint_valid = false;
+
+    // The support geometry changed, the merged mesh and the pad blueprint
+    // sampled from it are stale. Has to be called with m_mutex locked.
+    void invalidate_meshcache()
+    {
+        m_meshcache_valid     = false;
+        m_pad_blueprint_valid = false;
+    }
     
     template<class BridgeT, class...Args>
     const BridgeT& _add_bridge(std::vector<BridgeT> &br, Args&&... args)
@@ -244,7 +279,7 @@ class SupportTreeBuilder: public SupportTree {
         std::lock_guard<Mutex> lk(m_mutex);
         br.emplace_back(std::forward<Args>(args)...);
         br.back().id = long(br.size() - 1);
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return br.back();
     }
     
@@ -266,7 +301,7 @@ public:
         if (id >= m_head_indices.size()) m_head_indices.resize(id + 1);
         m_head_indices[id] = m_heads.size() - 1;
         
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return m_heads.back();
     }
     
@@ -288,7 +323,7 @@ public:
         pillar.start_junction_id = head.id;
         pillar.starts_from_head = true;
         
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return pillar.id;
     }
     
@@ -299,7 +334,7 @@ public:
         std::lock_guard<Mutex> lk(m_mutex);
         m_anchors.emplace_back(std::forward<Args>(args)...);
         m_anchors.back().id = long(m_junctions.size() - 1);
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return m_anchors.back();
     }
     
@@ -337,7 +372,7 @@ public:
         Pillar& pillar = m_pillars.back();
         pillar.id = long(m_pillars.size() - 1);
         pillar.starts_from_head = false;
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return pillar.id;
     }
     
@@ -346,7 +381,7 @@ public:
         std::lock_guard<Mutex> lk(m_mutex);
         m_junctions.emplace_back(std::forward<Args>(args)...);
         m_junctions.back().id = long(m_junctions.size() - 1);
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return m_junctions.back();
     }
     
@@ -365,7 +400,7 @@ public:
         m_bridges.back().id = long(m_bridges.size() - 1);
         
         h.bridge_id = m_bridges.back().id;
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return m_bridges.back();
     }
     
@@ -384,7 +419,7 @@ public:
         std::lock_guard<Mutex> lk(m_mutex);
         assert(id < m_head_indices.size());
         
-        m_meshcache_valid = false;
+        invalidate_meshcache();
         return m_heads[m_head_indices[id]];
     }
     
@@ -417,6 +452,9 @@ public:
     }
     
     const Pad& pad() const { return m_pad; }
+
+    // The silhouette of the support mesh the last pad was created from.
+    const ExPolygons &pad_blueprint() const { return m_pad_blueprint; }
     
     // WITHOUT THE PAD!!!
     const indexed_triangle_set &merged_mesh(size_t steps = 45) const;
@@ -7,6 +7,7 @@
 #include "Thread.hpp"
 
 #include <unordered_set>
+#include <atomic>
 #include <numeric>
 
 #include <tbb/parallel_for.h>
@@ -835,7 +836,8 @@ bool SLAPrint::invalidate_state_by_config_options(const std::vector<t_config_opt
         "display_pixels_y",
         "display_mirror_x",
         "display_mirror_y",
-        "display_orientation"
+        "display_orientation",
+        "rasterize_from_mesh"
     };
 
     static std::unordered_set<std::string> steps_ignore = {
@@ -904,7 +906,15 @@ SLAPrintObject::SLAPrintObject(SLAPrint *print, ModelObject *model_object)
             obj.transform(m_trafo);
         }
     })
-{}
+{
+    update_slices_stamp();
+}
+
+void SLAPrintObject::update_slices_stamp()
+{
+    static std::atomic<uint64_t> s_last_stamp { 0 };
+    m_slices_stamp = ++s_last_stamp;
+}
 
 SLAPrintObject::~SLAPrintObject() {}
 
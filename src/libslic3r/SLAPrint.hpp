@@ -111,6 +111,11 @@ public:
     // This method returns the support points of this SLAPrintObject.
     const std::vector<sla::SupportPoint>& get_support_points() const;
 
+    // Version stamp of the current model and support slices, including the
+    // placement of the instances. It changes whenever any of them changes and
+    // it is unique across all the print objects ever created.
+    uint64_t                slices_stamp() const { return m_slices_stamp; }
+
     // The public Slice record structure. It corresponds to one printable layer.
     class SliceRecord {
     public:
@@ -271,9 +276,17 @@ protected:
 
     void                    set_trafo(const Transform3d& trafo, bool left_handed) {
         m_transformed_rmesh.invalidate([this, &trafo, left_handed](){ m_trafo = trafo; m_left_handed = left_handed; });
+        m_hollowing_grid.reset();
+        m_pad_blueprint = {};
+    }
+
+    template<class InstVec> inline void set_instances(InstVec&& instances) {
+        m_instances = std::forward<InstVec>(instances);
+        update_slices_stamp();
     }
 
-    template<class InstVec> inline void set_instances(InstVec&& instances) { m_instances = std::forward<InstVec>(instances); }
+    // Mark the slices or the instance placement as changed.
+    void                    update_slices_stamp();
 
     // Invalidates the step, and its depending steps in SLAPrintObject and SLAPrint.
     bool                    invalidate_step(SLAPrintObjectStep step);
@@ -307,6 +320,8 @@ private:
 
     // Caching the transformed (m_trafo) raw mesh of the object
     mutable CachedObject<TriangleMesh>      m_transformed_rmesh;
+
+    uint64_t                                m_slices_stamp = 0;
     
     class SupportData : public sla::SupportableMesh
     {
@@ -314,6 +329,9 @@ private:
         sla::SupportTree::UPtr  support_tree_ptr; // the supports
         std::vector<ExPolygons> support_slices;   // sliced supports
         TriangleMesh tree_mesh, pad_mesh, full_mesh;
+
+        // Slices of the support tree alone (without the pad).
+        sla::SupportSlicesCache tree_slices;
         
         inline SupportData(const TriangleMesh &t)
             : sla::SupportableMesh{t.its, {}, {}}
@@ -323,6 +341,7 @@ private:
         {
             support_tree_ptr = sla::SupportTree::create(*this, ctl);
             tree_mesh = TriangleMesh{support_tree_ptr->retrieve_mesh(sla::MeshType::Support)};
+            tree_slices.clear();
             return support_tree_ptr;
         }
 
@@ -348,6 +367,21 @@ private:
     };
     
     std::unique_ptr<HollowingData> m_hollowing_data;
+
+    // Signed distance grid of the transformed mesh kept between hollowing
+    // runs, so that tuning the hollowing parameters does not need to convert
+    // the mesh to a grid again. Survives the invalidation of slaposHollowing.
+    sla::InteriorGridPtr m_hollowing_grid;
+
+    // Bottom silhouette of the transformed mesh used as the pad blueprint in
+    // the zero elevation mode. Valid for the sampled height and layer height
+    // stored along.
+    struct PadBlueprint {
+        ExPolygons contours;
+        float      height       = 0.f;
+        float      layer_height = 0.f;
+        bool       valid        = false;
+    } m_pad_blueprint;
 };
 
 using PrintObjects = std::vector<SLAPrintObject*>;
@@ -495,11 +529,20 @@ public:
 
         ExPolygons m_transformed_slices;
 
+        // Slice stamps of the print objects (see
+        // SLAPrintObject::slices_stamp()) the layer was merged from. If these
+        // match, the merged slices and areas of a previous run can be reused.
+        std::vector<uint64_t> m_stamps;
+
+        // Areas of the merged model and support slices (scaled)
+        double m_model_area = 0.;
+        double m_support_area = 0.;
+
         template<class Container> void transformed_slices(Container&& c)
         {
             m_transformed_slices = std::forward<Container>(c);
         }
-        
+
         friend class SLAPrint::Steps;
 
     public:
@@ -511,7 +554,13 @@ public:
             return m_level < other.m_level;
         }
 
-        void add(const SliceRecord& sr) { m_slices.emplace_back(sr); }
+        void add(const SliceRecord& sr)
+        {
+            m_slices.emplace_back(sr);
+            m_stamps.insert(std::upper_bound(m_stamps.begin(), m_stamps.end(),
+                                             sr.print_obj()->slices_stamp()),
+                            sr.print_obj()->slices_stamp());
+        }
 
         coord_t level() const { return m_level; }
 
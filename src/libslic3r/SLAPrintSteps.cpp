@@ -1,4 +1,5 @@
 #include <unordered_set>
+#include <unordered_map>
 
 #include <libslic3r/Exception.hpp>
 #include <libslic3r/SLAPrintSteps.hpp>
@@ -123,6 +124,7 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
 
     if (! po.m_config.hollowing_enable.getBool()) {
         BOOST_LOG_TRIVIAL(info) << "Skipping hollowing step!";
+        po.m_hollowing_grid.reset();
         return;
     }
 
@@ -133,7 +135,8 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     double closing_d = po.m_config.hollowing_closing_distance.getFloat();
     sla::HollowingConfig hlwcfg{thickness, quality, closing_d};
 
-    sla::InteriorPtr interior = generate_interior(po.transformed_mesh(), hlwcfg);
+    sla::InteriorPtr interior = generate_interior(po.transformed_mesh(), hlwcfg,
+                                                  {}, po.m_hollowing_grid);
 
     if (!interior || sla::get_mesh(*interior).empty())
         BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
@@ -381,7 +384,8 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
     );
 
     std::uniform_real_distribution<float> dist(0., float(EPSILON));
-    auto holes_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal({}, {});
+    // Holes are accumulated part by part, a hole is only united with the holes it overlaps.
+    MeshBoolean::cgal::PartitionedMesh holes_mesh_cgal;
     indexed_triangle_set part_to_drill = hollowed_mesh.its;
 
     bool hole_fail = false;
@@ -418,24 +422,24 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
             continue;
         }
 
-        auto cgal_hole = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
-        MeshBoolean::cgal::plus(*holes_mesh_cgal, *cgal_hole);
+        MeshBoolean::cgal::PartitionedMesh cgal_hole(m);
+        holes_mesh_cgal.plus(cgal_hole);
     }
 
-    if (MeshBoolean::cgal::does_self_intersect(*holes_mesh_cgal))
+    if (holes_mesh_cgal.does_self_intersect())
         throw Slic3r::SlicingError(L("Too many overlapping holes."));
 
-    auto hollowed_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal(hollowed_mesh);
+    MeshBoolean::cgal::PartitionedMesh hollowed_mesh_cgal(hollowed_mesh.its);
 
-    if (!MeshBoolean::cgal::does_bound_a_volume(*hollowed_mesh_cgal)) {
+    if (!hollowed_mesh_cgal.does_bound_a_volume()) {
         po.active_step_add_warning(
             PrintStateBase::WarningLevel::NON_CRITICAL,
             L("Mesh to be hollowed is not suitable for hollowing (does not "
               "bound a volume)."));
     }
 
-    if (!MeshBoolean::cgal::empty(*holes_mesh_cgal)
-        && !MeshBoolean::cgal::does_bound_a_volume(*holes_mesh_cgal)) {
+    if (!holes_mesh_cgal.empty()
+        && !holes_mesh_cgal.does_bound_a_volume()) {
         po.active_step_add_warning(
             PrintStateBase::WarningLevel::NON_CRITICAL,
             L("Unable to drill the current configuration of holes into the "
@@ -443,10 +447,12 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
     }
 
     try {
-        if (!MeshBoolean::cgal::empty(*holes_mesh_cgal))
-            MeshBoolean::cgal::minus(*hollowed_mesh_cgal, *holes_mesh_cgal);
+        // Only the parts of the hollowed mesh touched by the holes are corefined. The interior of a hollowed
+        // mesh is nested in its outer shell, thus the hollowed mesh is corefined as a whole.
+        if (!holes_mesh_cgal.empty())
+            hollowed_mesh_cgal.minus(holes_mesh_cgal);
 
-        hollowed_mesh = MeshBoolean::cgal::cgal_to_triangle_mesh(*hollowed_mesh_cgal);
+        hollowed_mesh = TriangleMesh(hollowed_mesh_cgal.to_its());
         mesh_view = hollowed_mesh;
 
         if (is_hollowed) {
@@ -492,6 +498,7 @@ void SLAPrint::Steps::slice_model(SLAPrintObject &po)
     coord_t maxZs = scaled(maxZ);
 
     po.m_slice_index.clear();
+    po.update_slices_stamp();
 
     size_t cap = size_t(1 + (maxZs - minZs - ilhs) / lhs);
     po.m_slice_index.reserve(cap);
@@ -709,9 +716,22 @@ void SLAPrint::Steps::generate_pad(SLAPrintObject &po) {
             // we sometimes call it "builtin pad" is enabled so we will
             // get a sample from the bottom of the mesh and use it for pad
             // creation.
-            sla::pad_blueprint(trmesh.its, bp, float(pad_h),
-                               float(po.m_config.layer_height.getFloat()),
-                               [this](){ throw_if_canceled(); });
+            // The blueprint depends only on the mesh and the sampled height
+            // range, so it is reused when other pad parameters are tuned.
+            auto &cache = po.m_pad_blueprint;
+            float h = float(pad_h);
+            float layer_h = float(po.m_config.layer_height.getFloat());
+
+            if (!cache.valid || cache.height != h || cache.layer_height != layer_h) {
+                cache = {};
+                sla::pad_blueprint(trmesh.its, cache.contours, h, layer_h,
+                                   [this](){ throw_if_canceled(); });
+                cache.height = h;
+                cache.layer_height = layer_h;
+                cache.valid = true;
+            }
+
+            bp = cache.contours;
         }
 
         po.m_supportdata->create_pad(bp, pcfg);
@@ -736,6 +756,7 @@ void SLAPrint::Steps::slice_supports(SLAPrintObject &po) {
     auto& sd = po.m_supportdata;
 
     if(sd) sd->support_slices.clear();
+    po.update_slices_stamp();
 
     // Don't bother if no supports and no pad is present.
     if (!po.m_config.supports_enable.getBool() && !po.m_config.pad_enable.getBool())
@@ -746,8 +767,14 @@ void SLAPrint::Steps::slice_supports(SLAPrintObject &po) {
 
         for(auto& rec : po.m_slice_index) heights.emplace_back(rec.slice_level());
 
-        sd->support_slices = sd->support_tree_ptr->slice(
-            heights, float(po.config().slice_closing_radius.value));
+        auto cr = float(po.config().slice_closing_radius.value);
+
+        // The support tree is only sliced again if it was regenerated or the
+        // slice grid changed, a new pad alone needs only the pad to be sliced.
+        sd->support_slices = sla::SupportTree::merge_slices(
+            sd->tree_slices.slice(*sd->support_tree_ptr, heights, cr),
+            sd->support_tree_ptr->slice(sla::MeshType::Pad, heights, cr),
+            heights.size());
     }
 
     for (size_t i = 0; i < sd->support_slices.size() && i < po.m_slice_index.size(); ++i)
@@ -866,8 +893,14 @@ void SLAPrint::Steps::initialize_printer_input()
 
 // Merging the slices from all the print objects into one slice grid and
 // calculating print statistics from the merge result.
+// Layers whose contributing objects did not change since the previous run
+// (according to their slice stamps) are taken over without merging them
+// again, so changing one object on a crowded plate only re-merges the layers
+// this object is present in.
 void SLAPrint::Steps::merge_slices_and_eval_stats() {
 
+    std::vector<PrintLayer> prev_printer_input = std::move(m_print->m_printer_input);
+
     initialize_printer_input();
 
     auto &print_statistics = m_print->m_print_statistics;
@@ -890,40 +923,25 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
     const auto height         = scaled<double>(printer_config.display_height.getFloat());
     const double display_area = width*height;
 
-    double supports_volume(0.0);
-    double models_volume(0.0);
-
-    double estim_time(0.0);
-    std::vector<double> layers_times;
-    layers_times.reserve(printer_input.size());
-
-    size_t slow_layers = 0;
-    size_t fast_layers = 0;
-
-    const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
-    double fade_layer_time = init_exp_time;
-
-    sla::ccr::SpinningMutex mutex;
-    using Lock = std::lock_guard<sla::ccr::SpinningMutex>;
-
     // Going to parallel:
-    auto printlayerfn = [this,
-            // functions and read only vars
-            area_fill, display_area, exp_time, init_exp_time, fast_tilt, slow_tilt, delta_fade_time,
-
-            // write vars
-            &mutex, &models_volume, &supports_volume, &estim_time, &slow_layers,
-            &fast_layers, &fade_layer_time, &layers_times](size_t sliced_layer_cnt)
+    auto printlayerfn = [&prev_printer_input](PrintLayer &layer)
     {
-        PrintLayer &layer = m_print->m_printer_input[sliced_layer_cnt];
-
         // vector of slice record references
         auto& slicerecord_references = layer.slices();
 
         if(slicerecord_references.empty()) return;
 
-        // Layer height should match for all object slices for a given level.
-        const auto l_height = double(slicerecord_references.front().get().layer_height());
+        auto prev = std::lower_bound(prev_printer_input.begin(),
+                                     prev_printer_input.end(), layer);
+
+        if (prev != prev_printer_input.end() &&
+            prev->level() == layer.level() && prev->m_stamps == layer.m_stamps) {
+            // None of the objects in this layer changed, reuse the result.
+            layer.transformed_slices(std::move(prev->m_transformed_slices));
+            layer.m_model_area   = prev->m_model_area;
+            layer.m_support_area = prev->m_support_area;
+            return;
+        }
 
         // Calculation of the consumed material
 
@@ -963,10 +981,6 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         for (const ExPolygon& polygon : model_polygons)
             layer_model_area += area(polygon);
 
-        if (layer_model_area < 0 || layer_model_area > 0) {
-            Lock lck(mutex); models_volume += layer_model_area * l_height;
-        }
-
         if(!supports_polygons.empty()) {
             if(model_polygons.empty()) supports_polygons = union_ex(supports_polygons);
             else supports_polygons = diff_ex(supports_polygons, model_polygons);
@@ -977,9 +991,8 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         for (const ExPolygon& polygon : supports_polygons)
             layer_support_area += area(polygon);
 
-        if (layer_support_area < 0 || layer_support_area > 0) {
-            Lock lck(mutex); supports_volume += layer_support_area * l_height;
-        }
+        layer.m_model_area   = layer_model_area;
+        layer.m_support_area = layer_support_area;
 
         // Here we can save the expensively calculated polygons for printing
         ExPolygons trslices;
@@ -988,39 +1001,65 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
         for(ExPolygon& poly : supports_polygons) trslices.emplace_back(std::move(poly));
 
         layer.transformed_slices(union_ex(trslices));
+    };
+
+    // sequential version for debugging:
+    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(printer_input[i]);
+    sla::ccr::for_each(printer_input.begin(), printer_input.end(), printlayerfn);
+
+    // The statistics are accumulated from the per layer areas in a cheap
+    // sequential pass, the fading of the exposure times depends on the
+    // order of the layers.
+    double supports_volume(0.0);
+    double models_volume(0.0);
+
+    double estim_time(0.0);
+    std::vector<double> layers_times;
+    layers_times.reserve(printer_input.size());
+
+    size_t slow_layers = 0;
+    size_t fast_layers = 0;
+
+    const double delta_fade_time = (init_exp_time - exp_time) / (fade_layers_cnt + 1);
+    double fade_layer_time = init_exp_time;
+
+    for (size_t sliced_layer_cnt = 0; sliced_layer_cnt < printer_input.size(); ++sliced_layer_cnt) {
+        const PrintLayer &layer = printer_input[sliced_layer_cnt];
+
+        if (layer.slices().empty()) continue;
+
+        // Layer height should match for all object slices for a given level.
+        const auto l_height = double(layer.slices().front().get().layer_height());
+
+        models_volume   += layer.m_model_area * l_height;
+        supports_volume += layer.m_support_area * l_height;
 
         // Calculation of the slow and fast layers to the future controlling those values on FW
 
-        const bool is_fast_layer = (layer_model_area + layer_support_area) <= display_area*area_fill;
+        const bool is_fast_layer = (layer.m_model_area + layer.m_support_area) <= display_area*area_fill;
         const double tilt_time = is_fast_layer ? fast_tilt : slow_tilt;
 
-        { Lock lck(mutex);
-            if (is_fast_layer)
-                fast_layers++;
-            else
-                slow_layers++;
-
-            // Calculation of the printing time
+        if (is_fast_layer)
+            fast_layers++;
+        else
+            slow_layers++;
 
-            double layer_times = 0.0;
-            if (sliced_layer_cnt < 3)
-                layer_times += init_exp_time;
-            else if (fade_layer_time > exp_time) {
-                fade_layer_time -= delta_fade_time;
-                layer_times += fade_layer_time;
-            }
-            else
-                layer_times += exp_time;
-            layer_times += tilt_time;
+        // Calculation of the printing time
 
-            layers_times.push_back(layer_times);
-            estim_time += layer_times;
+        double layer_times = 0.0;
+        if (sliced_layer_cnt < 3)
+            layer_times += init_exp_time;
+        else if (fade_layer_time > exp_time) {
+            fade_layer_time -= delta_fade_time;
+            layer_times += fade_layer_time;
         }
-    };
+        else
+            layer_times += exp_time;
+        layer_times += tilt_time;
 
-    // sequential version for debugging:
-    // for(size_t i = 0; i < m_printer_input.size(); ++i) printlayerfn(i);
-    sla::ccr::for_each(size_t(0), printer_input.size(), printlayerfn);
+        layers_times.push_back(layer_times);
+        estim_time += layer_times;
+    }
 
     auto SCALING2 = SCALING_FACTOR * SCALING_FACTOR;
     print_statistics.support_used_material = supports_volume * SCALING2;
@@ -1041,11 +1080,102 @@ void SLAPrint::Steps::merge_slices_and_eval_stats() {
     report_status(-2, "", SlicingStatus::RELOAD_SLA_PREVIEW);
 }
 
+struct SLAPrint::Steps::MeshSegments {
+    // Sliced one record at a time by the rasterizer, see MeshSegmentSlicer.
+    MeshSegmentSlicer model;   // one plane per slice record of the object
+    MeshSegmentSlicer support;
+    MeshSegmentSlicer pad;
+    sla::RasterBase::FillRule model_rule = sla::RasterBase::frNonZero;
+
+    // The printer corrections can only be applied on the slice polygons.
+    // Slice records below this index have to be drawn from the polygons.
+    size_t polygon_records = 0;
+};
+
+SLAPrint::Steps::MeshSegments SLAPrint::Steps::slice_segments(const SLAPrintObject &po)
+{
+    MeshSegments ret;
+
+    auto   faded_lyrs = size_t(po.m_config.faded_layers.getInt());
+    double start_efc  = m_print->m_printer_config.elefant_foot_compensation.getFloat();
+    double doffs      = m_print->m_printer_config.absolute_correction.getFloat();
+
+    if (scaled(doffs) != 0 || po.m_config.slicing_mode.value == SlicingMode::CloseHoles) {
+        ret.polygon_records = po.m_slice_index.size();
+        return ret;
+    }
+
+    if (start_efc > 0.)
+        ret.polygon_records = std::min(po.m_slice_index.size(), faded_lyrs);
+
+    if (po.m_config.slicing_mode.value == SlicingMode::EvenOdd)
+        ret.model_rule = sla::RasterBase::frEvenOdd;
+
+    auto heights = reserve_vector<float>(po.m_slice_index.size());
+    for (const SliceRecord &rec : po.m_slice_index)
+        heights.emplace_back(rec.slice_level());
+
+    auto thr = [this]() { m_print->throw_if_canceled(); };
+
+    // The mesh to slice already contains the hollowed interior with
+    // inverted normals, the non-zero rule subtracts it from the model.
+    ret.model = MeshSegmentSlicer(po.get_mesh_to_slice().its, heights,
+                                  Transform3d::Identity(), thr);
+
+    bool has_supports = po.m_config.supports_enable.getBool() ||
+                        po.m_config.pad_enable.getBool();
+
+    if (has_supports && po.m_supportdata && po.m_supportdata->support_tree_ptr) {
+        const sla::SupportTree &tree = *po.m_supportdata->support_tree_ptr;
+        ret.support = MeshSegmentSlicer(tree.retrieve_mesh(sla::MeshType::Support),
+                                        heights, Transform3d::Identity(), thr);
+        ret.pad     = MeshSegmentSlicer(tree.retrieve_mesh(sla::MeshType::Pad),
+                                        heights, Transform3d::Identity(), thr);
+    }
+
+    return ret;
+}
+
+// Place the segments of an object to the position of one of its instances,
+// the same way as get_all_polygons() does with the slice polygons.
+static Lines get_instance_segments(const Lines &                   segments,
+                                   const SLAPrintObject::Instance &inst,
+                                   bool                            is_lefthanded)
+{
+    Lines ret = segments;
+
+    for (Line &l : ret) {
+        if (is_lefthanded) {
+            l.a.x() = -l.a.x();
+            l.b.x() = -l.b.x();
+            l.reverse();
+        }
+
+        l.a.rotate(double(inst.rotation));
+        l.b.rotate(double(inst.rotation));
+        l.translate(inst.shift);
+    }
+
+    return ret;
+}
+
 // Rasterizing the model objects, and their supports
 void SLAPrint::Steps::rasterize()
 {
     if(canceled() || !m_print->m_printer) return;
 
+    // Intersection segments of all the objects for direct rasterization
+    std::vector<MeshSegments> segments;
+    std::unordered_map<const SLAPrintObject *, size_t> segments_idx;
+
+    if (m_print->m_printer_config.rasterize_from_mesh.getBool()) {
+        segments.reserve(m_print->m_objects.size());
+        for (const SLAPrintObject *po : m_print->m_objects) {
+            segments_idx[po] = segments.size();
+            segments.emplace_back(slice_segments(*po));
+        }
+    }
+
     // coefficient to map the rasterization state (0-99) to the allocated
     // portion (slot) of the process state
     double sd = (100 - max_objstatus) / 100.0;
@@ -1064,14 +1194,50 @@ void SLAPrint::Steps::rasterize()
 
     // procedure to process one height level. This will run in parallel
     auto lvlfn =
-        [this, &slck, increment, &dstatus, &pst]
+        [this, &slck, increment, &dstatus, &pst, &segments, &segments_idx]
         (sla::RasterBase& raster, size_t idx)
     {
         PrintLayer& printlayer = m_print->m_printer_input[idx];
         if(canceled()) return;
 
-        for (const ExPolygon& poly : printlayer.transformed_slices())
-            raster.draw(poly);
+        if (segments.empty()) {
+            for (const ExPolygon& poly : printlayer.transformed_slices())
+                raster.draw(poly);
+        } else for (const SliceRecord &rec : printlayer.slices()) {
+            const SLAPrintObject &po   = *rec.print_obj();
+            const MeshSegments   &segs = segments[segments_idx.at(&po)];
+            auto recidx = size_t(&rec - po.m_slice_index.data());
+
+            if (recidx < segs.polygon_records) {
+                for (const ExPolygon &poly : get_all_polygons(rec, soModel))
+                    raster.draw(poly);
+                for (const ExPolygon &poly : get_all_polygons(rec, soSupport))
+                    raster.draw(poly);
+
+                continue;
+            }
+
+            // Each record is sliced by the thread rasterizing its layer.
+            Lines model = recidx < segs.model.num_planes() ?
+                              segs.model.slice(recidx) : Lines();
+            Lines support;
+            if (recidx < segs.support.num_planes()) {
+                support = segs.support.slice(recidx);
+                append(support, segs.pad.slice(recidx));
+            }
+
+            for (const SLAPrintObject::Instance &inst : po.instances()) {
+                if (!model.empty())
+                    raster.draw(get_instance_segments(model, inst,
+                                                      po.is_left_handed()),
+                                segs.model_rule);
+
+                if (!support.empty())
+                    raster.draw(get_instance_segments(support, inst,
+                                                      po.is_left_handed()),
+                                sla::RasterBase::frNonZero);
+            }
+        }
 
         // Status indication guarded with the spinlock
         {
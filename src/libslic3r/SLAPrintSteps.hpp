@@ -45,6 +45,11 @@ private:
     
     void apply_printer_corrections(SLAPrintObject &po, SliceOrigin o);
     
+    // Mesh intersection segments of an object for each of its slice records,
+    // to be rasterized directly without building the slice polygons.
+    struct MeshSegments;
+    MeshSegments slice_segments(const SLAPrintObject &po);
+    
 public:
     explicit Steps(SLAPrint *print);
     
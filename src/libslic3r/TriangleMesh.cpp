@@ -14,8 +14,10 @@
 #include <libqhullcpp/QhullFacetList.h>
 #include <libqhullcpp/QhullVertexSet.h>
 
+#include <atomic>
 #include <cmath>
 #include <deque>
+#include <numeric>
 #include <queue>
 #include <vector>
 #include <utility>
@@ -24,6 +26,8 @@
 
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/predef/other/endian.h>
 
 #include <Eigen/Core>
@@ -31,6 +35,11 @@
 
 #include <assert.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_scan.h>
+#include <tbb/parallel_sort.h>
+
 namespace Slic3r {
 
 static void update_bounding_box(const indexed_triangle_set &its, TriangleMeshStats &out)
@@ -177,8 +186,116 @@ static void trianglemesh_repair_on_import(stl_file &stl)
     BOOST_LOG_TRIVIAL(debug) << "TriangleMesh::repair() finished";
 }
 
+// Would trianglemesh_repair_on_import() leave the mesh unchanged? That is the case if the mesh is a closed, consistently oriented
+// 2-manifold without degenerate faces: each directed edge is used by a single face and its reverse by another single face,
+// and the faces around each vertex form a single fan. Then admesh would find all the neighbors by exact matching, it would flip nothing
+// and stl_generate_shared_vertices() would create exactly the vertices shared by its_read_stl_binary().
+// Fills in the face neighbors in the order of its_face_neighbors().
+static bool its_is_closed_oriented_manifold(const indexed_triangle_set &its, std::vector<Vec3i> &face_neighbors)
+{
+    const int num_corners = int(its.indices.size() * 3);
+    for (const stl_triangle_vertex_indices &face : its.indices)
+        if (face(0) == face(1) || face(1) == face(2) || face(2) == face(0))
+            return false;
+
+    // Directed edges sorted by their vertices, an edge is identified by the corner it starts at.
+    auto edge_key = [](int v0, int v1) { return (uint64_t(uint32_t(v0)) << 32) | uint64_t(uint32_t(v1)); };
+    std::vector<std::pair<uint64_t, int>> edges(num_corners);
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_corners, 65536), [&its, &edges, &edge_key](const tbb::blocked_range<int> &range) {
+        for (int i = range.begin(); i < range.end(); ++ i) {
+            const stl_triangle_vertex_indices &face = its.indices[i / 3];
+            edges[i] = { edge_key(face(i % 3), face(i % 3 == 2 ? 0 : i % 3 + 1)), i };
+        }
+    });
+    tbb::parallel_sort(edges.begin(), edges.end());
+
+    // Corner, where the opposite edge starts.
+    std::vector<int>  twin(num_corners, -1);
+    std::atomic<bool> manifold { true };
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_corners, 65536), [&edges, &twin, &manifold](const tbb::blocked_range<int> &range) {
+        for (int i = range.begin(); i < range.end() && manifold; ++ i) {
+            const uint64_t key = edges[i].first;
+            if (i + 1 < int(edges.size()) && edges[i + 1].first == key) {
+                // Edge used twice in the same direction: either flipped faces or a non-manifold edge.
+                manifold = false;
+                break;
+            }
+            const uint64_t opposite = (key >> 32) | (key << 32);
+            auto it = std::lower_bound(edges.begin(), edges.end(), std::make_pair(opposite, 0));
+            if (it == edges.end() || it->first != opposite) {
+                // Open edge.
+                manifold = false;
+                break;
+            }
+            twin[edges[i].second] = it->second;
+        }
+    });
+    if (! manifold)
+        return false;
+
+    // Walk the fan around each vertex, starting at its first corner. Corner "c" of face "f" continues to the corner of the face
+    // on the other side of the edge starting at "c", which is the corner following the start of the opposite edge.
+    std::vector<int>  num_incident(its.vertices.size(), 0);
+    for (const stl_triangle_vertex_indices &face : its.indices)
+        for (int i = 0; i < 3; ++ i)
+            ++ num_incident[face(i)];
+    std::vector<char> vertex_visited(its.vertices.size(), false);
+    for (int corner = 0; corner < num_corners; ++ corner) {
+        const int vertex = its.indices[corner / 3](corner % 3);
+        if (vertex_visited[vertex])
+            continue;
+        vertex_visited[vertex] = true;
+        int fan_size = 0;
+        int c        = corner;
+        do {
+            const int t = twin[c];
+            c = t - t % 3 + (t % 3 == 2 ? 0 : t % 3 + 1);
+            assert(its.indices[c / 3](c % 3) == vertex);
+            if (++ fan_size > num_incident[vertex])
+                return false;
+        } while (c != corner);
+        if (fan_size != num_incident[vertex])
+            // More than one fan around this vertex: admesh would split the vertex.
+            return false;
+    }
+
+    face_neighbors.assign(its.indices.size(), Vec3i(-1, -1, -1));
+    for (int corner = 0; corner < num_corners; ++ corner)
+        face_neighbors[corner / 3](corner % 3) = twin[corner] / 3;
+    return true;
+}
+
 bool TriangleMesh::ReadSTLFile(const char* input_file, bool repair)
 { 
+    // Binary STLs are mapped and indexed directly, skipping the stl_file facet array.
+    // The admesh repair only runs if it would change anything, otherwise the statistics are calculated on the indexed mesh.
+    // ASCII STLs and meshes to be repaired are loaded by admesh.
+    if (its_read_stl_binary(input_file, this->its)) {
+        if (! repair) {
+            m_stats.clear();
+            m_stats.number_of_facets = uint32_t(this->its.indices.size());
+            m_stats.volume           = its_volume(this->its);
+            update_bounding_box(this->its, m_stats);
+            // Connectivity was not checked, report the open edges the same way as the unrepaired admesh path does.
+            m_stats.open_edges = int(m_stats.number_of_facets) * 3;
+            return true;
+        }
+        std::vector<Vec3i> face_neighbors;
+        if (! this->its.indices.empty() && its_is_closed_oriented_manifold(this->its, face_neighbors)) {
+            // A negative volume would make admesh flip all the faces.
+            if (float volume = its_volume(this->its); volume >= 0.f) {
+                m_stats.clear();
+                m_stats.number_of_facets = uint32_t(this->its.indices.size());
+                m_stats.volume           = volume;
+                update_bounding_box(this->its, m_stats);
+                m_stats.number_of_parts  = int(its_number_of_patches(this->its, face_neighbors));
+                m_stats.open_edges       = 0;
+                return true;
+            }
+        }
+        this->its.clear();
+    }
+
     stl_file stl;
     if (! stl_open(&stl, input_file))
         return false;
@@ -1307,6 +1424,99 @@ static inline void big_endian_reverse_quads(char *buf, size_t cnt)
 }
 #endif // BOOST_ENDIAN_LITTLE_BYTE
 
+bool its_read_stl_binary(const char *file, indexed_triangle_set &its)
+{
+    boost::iostreams::mapped_file_source mapped;
+    try {
+        mapped.open(boost::filesystem::path(file));
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "its_read_stl_binary: Couldn't map " << file << ": " << ex.what();
+        return false;
+    }
+
+    // Binary / ASCII detection and the file size check follow stl_open_count_facets().
+    const size_t  file_size = mapped.size();
+    const char   *data      = mapped.data();
+    if (file_size < STL_MIN_FILE_SIZE ||
+        std::none_of(data + HEADER_SIZE, data + HEADER_SIZE + 128, [](char c) { return static_cast<unsigned char>(c) > 127; }))
+        return false;
+    if ((file_size - HEADER_SIZE) % SIZEOF_STL_FACET != 0) {
+        BOOST_LOG_TRIVIAL(error) << "its_read_stl_binary: The file " << file << " has the wrong size.";
+        return false;
+    }
+    const size_t num_faces = (file_size - HEADER_SIZE) / SIZEOF_STL_FACET;
+    if (num_faces * 3 > size_t(std::numeric_limits<int>::max()))
+        return false;
+    const int num_corners = int(num_faces * 3);
+
+    // 1) Copy the facet vertices out of the mapped file, skipping the facet normals, which are recalculated from the vertices anyway.
+    static_assert(sizeof(stl_vertex) == 3 * sizeof(float), "stl_vertex is expected to be tightly packed");
+    std::vector<stl_vertex> corners(num_corners);
+    std::atomic<bool>       all_finite { true };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_faces, 4096), [data, &corners, &all_finite](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            char *dst = reinterpret_cast<char*>(corners[i * 3].data());
+            ::memcpy(dst, data + HEADER_SIZE + i * SIZEOF_STL_FACET + 3 * sizeof(float), 9 * sizeof(float));
+            big_endian_reverse_quads(dst, 9 * sizeof(float));
+            if (! corners[i * 3].allFinite() || ! corners[i * 3 + 1].allFinite() || ! corners[i * 3 + 2].allFinite())
+                all_finite = false;
+        }
+    });
+    mapped.close();
+    // NaNs would break the ordering below. Let admesh deal with such a broken file.
+    if (! all_finite)
+        return false;
+
+    // 2) Sort the corners lexicographically by coordinates AND corner index, the same ordering as its_merge_vertices() uses.
+    std::vector<int> sorted(num_corners);
+    std::iota(sorted.begin(), sorted.end(), 0);
+    tbb::parallel_sort(sorted.begin(), sorted.end(), [&corners](int il, int ir) {
+        const Vec3f &l = corners[il];
+        const Vec3f &r = corners[ir];
+        return l.x() < r.x() || (l.x() == r.x() && (l.y() < r.y() || (l.y() == r.y() && (l.z() < r.z() || (l.z() == r.z() && il < ir)))));
+    });
+
+    // 3) The first corner of a run of identical corners (the one with the lowest index) becomes a vertex.
+    // Number the vertices in the order of the corners, the other corners of a run are marked with -1.
+    std::vector<int> vertex_id(num_corners, 0);
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_corners, 65536), [&corners, &sorted, &vertex_id](const tbb::blocked_range<int> &range) {
+        for (int i = range.begin(); i < range.end(); ++ i)
+            if (i == 0 || corners[sorted[i]] != corners[sorted[i - 1]])
+                vertex_id[sorted[i]] = 1;
+    });
+    const int num_vertices = tbb::parallel_scan(tbb::blocked_range<int>(0, num_corners, 65536), 0,
+        [&vertex_id](const tbb::blocked_range<int> &range, int sum, bool is_final) {
+            for (int i = range.begin(); i < range.end(); ++ i) {
+                const int head = vertex_id[i];
+                if (is_final)
+                    vertex_id[i] = head ? sum : -1;
+                sum += head;
+            }
+            return sum;
+        }, std::plus<int>());
+
+    // 4) Emit the vertices and the faces. Each block of the sorted corners starts by looking back for the head of its first run.
+    its.clear();
+    its.vertices.resize(num_vertices);
+    its.indices.resize(num_faces);
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_corners, 65536), [&its, &corners, &sorted, &vertex_id](const tbb::blocked_range<int> &range) {
+        int head = range.begin();
+        while (vertex_id[sorted[head]] == -1)
+            -- head;
+        int id = vertex_id[sorted[head]];
+        for (int i = range.begin(); i < range.end(); ++ i) {
+            const int corner = sorted[i];
+            if (vertex_id[corner] != -1) {
+                id = vertex_id[corner];
+                its.vertices[id] = corners[corner];
+            }
+            its.indices[corner / 3](corner % 3) = id;
+        }
+    });
+
+    return true;
+}
+
 bool its_write_stl_ascii(const char *file, const char *label, const std::vector<stl_triangle_vertex_indices> &indices, const std::vector<stl_vertex> &vertices)
 {
     FILE *fp = boost::nowide::fopen(file, "w");
@@ -92,6 +92,8 @@ public:
     TriangleMesh(std::vector<Vec3f> &&vertices, const std::vector<Vec3i> &&faces);
     explicit TriangleMesh(const indexed_triangle_set &M);
     explicit TriangleMesh(indexed_triangle_set &&M, const RepairedMeshErrors& repaired_errors = RepairedMeshErrors());
+    // Mesh with statistics known in advance, for example restored from the mesh cache. The statistics are not recalculated.
+    TriangleMesh(indexed_triangle_set &&M, const TriangleMeshStats &stats) : its(std::move(M)), m_stats(stats) { assert(m_stats.number_of_facets == this->its.indices.size()); }
     void clear() { this->its.clear(); this->m_stats.clear(); }
     bool ReadSTLFile(const char* input_file, bool repair = true);
     bool write_ascii(const char* output_file);
@@ -313,6 +315,11 @@ bool        its_write_stl_ascii(const char *file, const char *label, const std::
 inline bool its_write_stl_ascii(const char *file, const char *label, const indexed_triangle_set &its) { return its_write_stl_ascii(file, label, its.indices, its.vertices); }
 bool        its_write_stl_binary(const char *file, const char *label, const std::vector<stl_triangle_vertex_indices> &indices, const std::vector<stl_vertex> &vertices);
 inline bool its_write_stl_binary(const char *file, const char *label, const indexed_triangle_set &its) { return its_write_stl_binary(file, label, its.indices, its.vertices); }
+// Load a binary STL by memory mapping the file, merge the bit-identical vertices in parallel and fill in the indexed triangle set
+// without going through the admesh stl_file. Vertices are numbered in the order of their first occurence in the file.
+// Returns false if the file could not be mapped, is not a binary STL or contains non-finite coordinates,
+// the caller is expected to fall back to stl_open() in that case.
+bool        its_read_stl_binary(const char *file, indexed_triangle_set &its);
 
 inline BoundingBoxf3 bounding_box(const TriangleMesh &m) { return m.bounding_box(); }
 inline BoundingBoxf3 bounding_box(const indexed_triangle_set& its)
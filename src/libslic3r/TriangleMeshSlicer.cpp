@@ -1,3 +1,4 @@
+#include "BandedMesh.hpp"
 #include "ClipperUtils.hpp"
 #include "Geometry.hpp"
 #include "Tesselate.hpp"
@@ -303,20 +304,15 @@ static FacetSliceType slice_facet(
     return FacetSliceType::NoSlice;
 }
 
-template<typename TransformVertex>
-void slice_facet_at_zs(
-    // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
-    const std::vector<Vec3f>                         &mesh_vertices,
-    const TransformVertex                            &transform_vertex_fn,
+static void slice_facet_at_zs(
+    // 3 vertices of the triangle, XY scaled. Z scaled or unscaled (same as zs).
+    const stl_vertex                                 *vertices,
     const stl_triangle_vertex_indices                &indices,
     const Vec3i                                      &edge_ids,
-    // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
     const std::vector<float>                         &zs,
     std::vector<IntersectionLines>                   &lines,
     std::array<std::mutex, 64>                       &lines_mutex)
 {
-    stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
-
     // find facet extents
     const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
     const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
@@ -338,6 +334,22 @@ void slice_facet_at_zs(
     }
 }
 
+template<typename TransformVertex>
+void slice_facet_at_zs(
+    // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
+    const std::vector<Vec3f>                         &mesh_vertices,
+    const TransformVertex                            &transform_vertex_fn,
+    const stl_triangle_vertex_indices                &indices,
+    const Vec3i                                      &edge_ids,
+    // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
+    const std::vector<float>                         &zs,
+    std::vector<IntersectionLines>                   &lines,
+    std::array<std::mutex, 64>                       &lines_mutex)
+{
+    stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
+    slice_facet_at_zs(vertices, indices, edge_ids, zs, lines, lines_mutex);
+}
+
 template<typename TransformVertex, typename ThrowOnCancel>
 static inline std::vector<IntersectionLines> slice_make_lines(
     const std::vector<stl_vertex>                   &vertices,
@@ -1311,6 +1323,44 @@ static Polygons make_loops(
     return loops;
 }
 
+// Chain the lines of a single layer and orient the loops according to the slicing mode of the layer.
+static Polygons make_layer_loops(
+    // Lines will have their flags modified.
+    IntersectionLines              &lines,
+    const MeshSlicingParams        &params,
+    size_t                          layer_idx)
+{
+    Polygons polygons = make_loops(lines);
+
+    auto this_mode = layer_idx < params.slicing_mode_normal_below_layer ? params.mode_below : params.mode;
+    if (! polygons.empty()) {
+        if (this_mode == MeshSlicingParams::SlicingMode::Positive) {
+            // Reorient all loops to be CCW.
+            for (Polygon& p : polygons)
+                p.make_counter_clockwise();
+        }
+        else if (this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour) {
+            // Keep just the largest polygon, make it CCW.
+            double   max_area = 0.;
+            Polygon* max_area_polygon = nullptr;
+            for (Polygon& p : polygons) {
+                double a = p.area();
+                if (std::abs(a) > std::abs(max_area)) {
+                    max_area = a;
+                    max_area_polygon = &p;
+                }
+            }
+            assert(max_area_polygon != nullptr);
+            if (max_area < 0.)
+                max_area_polygon->reverse();
+            Polygon p(std::move(*max_area_polygon));
+            polygons.clear();
+            polygons.emplace_back(std::move(p));
+        }
+    }
+    return polygons;
+}
+
 template<typename ThrowOnCancel>
 static std::vector<Polygons> make_loops(
     // Lines will have their flags modified.
@@ -1326,36 +1376,7 @@ static std::vector<Polygons> make_loops(
             for (size_t line_idx = range.begin(); line_idx < range.end(); ++ line_idx) {
                 if ((line_idx & 0x0ffff) == 0)
                     throw_on_cancel();
-
-                Polygons &polygons = layers[line_idx];
-                polygons = make_loops(lines[line_idx]);
-
-                auto this_mode = line_idx < params.slicing_mode_normal_below_layer ? params.mode_below : params.mode;
-                if (! polygons.empty()) {
-                    if (this_mode == MeshSlicingParams::SlicingMode::Positive) {
-                        // Reorient all loops to be CCW.
-                        for (Polygon& p : polygons)
-                            p.make_counter_clockwise();
-                    }
-                    else if (this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour) {
-                        // Keep just the largest polygon, make it CCW.
-                        double   max_area = 0.;
-                        Polygon* max_area_polygon = nullptr;
-                        for (Polygon& p : polygons) {
-                            double a = p.area();
-                            if (std::abs(a) > std::abs(max_area)) {
-                                max_area = a;
-                                max_area_polygon = &p;
-                            }
-                        }
-                        assert(max_area_polygon != nullptr);
-                        if (max_area < 0.)
-                            max_area_polygon->reverse();
-                        Polygon p(std::move(*max_area_polygon));
-                        polygons.clear();
-                        polygons.emplace_back(std::move(p));
-                    }
-                }
+                layers[line_idx] = make_layer_loops(lines[line_idx], params, line_idx);
             }
         }
     );
@@ -1768,6 +1789,102 @@ std::vector<Polygons> slice_mesh(
     return layers;
 }
 
+std::vector<Lines> slice_mesh_segments(
+    const indexed_triangle_set       &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const Transform3d                &trafo,
+    std::function<void()>             throw_on_cancel)
+{
+    BOOST_LOG_TRIVIAL(debug) << "slice_mesh to segments";
+
+    MeshSegmentSlicer slicer(mesh, zs, trafo, throw_on_cancel);
+    throw_on_cancel();
+
+    std::vector<Lines> layers(zs.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, zs.size()),
+        [&slicer, &layers, &throw_on_cancel](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                if ((layer_idx & 0x0ff) == 0)
+                    throw_on_cancel();
+                layers[layer_idx] = slicer.slice(layer_idx);
+            }
+        });
+
+    return layers;
+}
+
+MeshSegmentSlicer::MeshSegmentSlicer(
+    const indexed_triangle_set       &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const Transform3d                &trafo,
+    std::function<void()>             throw_on_cancel) :
+    m_vertices(transform_mesh_vertices_for_slicing(mesh, trafo)),
+    m_indices(mesh.indices),
+    m_face_edge_ids(its_face_edge_ids(mesh)),
+    m_zs(zs)
+{
+    assert(std::is_sorted(m_zs.begin(), m_zs.end()));
+    throw_on_cancel();
+
+    // Range of the planes spanned by each face, the same as in slice_facet_at_zs().
+    // Horizontal faces are skipped, they never produce a segment.
+    std::vector<std::pair<int, int>> face_planes(m_indices.size());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, m_indices.size()),
+        [this, &face_planes](const tbb::blocked_range<size_t> &range) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
+                const Vec3i &f     = m_indices[face_idx];
+                const float  min_z = std::min(m_vertices[f(0)].z(), std::min(m_vertices[f(1)].z(), m_vertices[f(2)].z()));
+                const float  max_z = std::max(m_vertices[f(0)].z(), std::max(m_vertices[f(1)].z(), m_vertices[f(2)].z()));
+                if (min_z == max_z)
+                    face_planes[face_idx] = { 0, 0 };
+                else {
+                    auto min_plane = std::lower_bound(m_zs.begin(), m_zs.end(), min_z);
+                    auto max_plane = std::upper_bound(min_plane, m_zs.end(), max_z);
+                    face_planes[face_idx] = { int(min_plane - m_zs.begin()), int(max_plane - m_zs.begin()) };
+                }
+            }
+        });
+    throw_on_cancel();
+
+    // Count the faces per plane and scatter the face indices in their order.
+    m_plane_faces_begin.assign(m_zs.size() + 1, 0);
+    for (const std::pair<int, int> &planes : face_planes)
+        for (int i = planes.first; i < planes.second; ++ i)
+            ++ m_plane_faces_begin[i + 1];
+    for (size_t i = 1; i < m_plane_faces_begin.size(); ++ i)
+        m_plane_faces_begin[i] += m_plane_faces_begin[i - 1];
+    m_plane_faces.assign(m_plane_faces_begin.back(), 0);
+    std::vector<size_t> cursor(m_plane_faces_begin.begin(), m_plane_faces_begin.end() - 1);
+    for (int face_idx = 0; face_idx < int(face_planes.size()); ++ face_idx)
+        for (int i = face_planes[face_idx].first; i < face_planes[face_idx].second; ++ i)
+            m_plane_faces[cursor[i] ++] = face_idx;
+}
+
+Lines MeshSegmentSlicer::slice(size_t plane_idx) const
+{
+    const float slice_z = m_zs[plane_idx];
+    Lines       out;
+    out.reserve(m_plane_faces_begin[plane_idx + 1] - m_plane_faces_begin[plane_idx]);
+    for (size_t i = m_plane_faces_begin[plane_idx]; i < m_plane_faces_begin[plane_idx + 1]; ++ i) {
+        const int    face_idx = m_plane_faces[i];
+        const Vec3i &indices  = m_indices[face_idx];
+        stl_vertex   vertices[3] { m_vertices[indices(0)], m_vertices[indices(1)], m_vertices[indices(2)] };
+        const float  min_z    = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
+        int          idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
+        IntersectionLine il;
+        // Only the faces below an edge lying on the plane produce a segment (FacetSliceType::Slicing), see slice_facet().
+        if (slice_facet(slice_z, vertices, indices, m_face_edge_ids[face_idx], idx_vertex_lowest, false, il) == FacetSliceType::Slicing &&
+            // slice_facet() may create zero length segments due to rounding.
+            il.a != il.b)
+            out.emplace_back(il.a, il.b);
+    }
+    return out;
+}
+
 // Specialized version for a single slicing plane only, running on a single thread.
 Polygons slice_mesh(
     const indexed_triangle_set       &mesh,
@@ -1831,6 +1948,30 @@ Polygons slice_mesh(
     return layers.front();
 }
 
+// Convert loops of a single layer produced by slice_mesh() into expolygons, according to the slicing mode of the layer.
+static ExPolygons make_layer_expolygons(const Polygons &loops, const MeshSlicingParamsEx &params, size_t layer_id)
+{
+    ExPolygons expolygons;
+    const auto this_mode = layer_id < params.slicing_mode_normal_below_layer ? params.mode_below : params.mode;
+    Slic3r::make_expolygons(
+        loops, params.closing_radius, params.extra_offset,
+        this_mode == MeshSlicingParams::SlicingMode::EvenOdd ? ClipperLib::pftEvenOdd : 
+        this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour ? ClipperLib::pftPositive : ClipperLib::pftNonZero,
+        &expolygons);
+    //FIXME simplify
+    if (this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
+        keep_largest_contour_only(expolygons);
+    auto resolution = scaled<float>(params.resolution);
+    if (resolution != 0.) {
+        ExPolygons simplified;
+        simplified.reserve(expolygons.size());
+        for (const ExPolygon &ex : expolygons)
+            append(simplified, ex.simplify(resolution));
+        expolygons = std::move(simplified);
+    }
+    return expolygons;
+}
+
 std::vector<ExPolygons> slice_mesh_ex(
     const indexed_triangle_set       &mesh,
     const std::vector<float>         &zs,
@@ -1853,26 +1994,9 @@ std::vector<ExPolygons> slice_mesh_ex(
         tbb::blocked_range<size_t>(0, layers_p.size()),
         [&layers_p, &params, &layers, throw_on_cancel]
         (const tbb::blocked_range<size_t>& range) {
-            auto resolution = scaled<float>(params.resolution);
             for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
                 throw_on_cancel();
-                ExPolygons &expolygons = layers[layer_id];
-                const auto this_mode = layer_id < params.slicing_mode_normal_below_layer ? params.mode_below : params.mode;
-                Slic3r::make_expolygons(
-                    layers_p[layer_id], params.closing_radius, params.extra_offset,
-                    this_mode == MeshSlicingParams::SlicingMode::EvenOdd ? ClipperLib::pftEvenOdd : 
-                    this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour ? ClipperLib::pftPositive : ClipperLib::pftNonZero,
-                    &expolygons);
-                //FIXME simplify
-                if (this_mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
-                    keep_largest_contour_only(expolygons);
-                if (resolution != 0.) {
-                    ExPolygons simplified;
-                    simplified.reserve(expolygons.size());
-                    for (const ExPolygon &ex : expolygons)
-                        append(simplified, ex.simplify(resolution));
-                    expolygons = std::move(simplified);
-                }
+                layers[layer_id] = make_layer_expolygons(layers_p[layer_id], params, layer_id);
             }
         });
 //    BOOST_LOG_TRIVIAL(debug) << "slice_mesh make_expolygons in parallel - end";
@@ -1880,6 +2004,92 @@ std::vector<ExPolygons> slice_mesh_ex(
     return layers;
 }
 
+// Slice the bands one after the other. Once a band is sliced, the layers below the next band are complete,
+// their lines are chained and released.
+template<typename LayerFn>
+static void slice_banded_mesh(
+    const BandedMesh                 &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel,
+    // Called in parallel with each layer index and its loops.
+    LayerFn                           layer_fn)
+{
+    std::vector<IntersectionLines>  lines(zs.size(), IntersectionLines());
+    std::array<std::mutex, 64>      lines_mutex;
+    size_t                          num_layers_finished = 0;
+    auto finish_layers = [&](size_t layers_end) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(num_layers_finished, layers_end),
+            [&lines, &params, &layer_fn, &throw_on_cancel](const tbb::blocked_range<size_t> &range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    throw_on_cancel();
+                    Polygons polygons = make_layer_loops(lines[layer_idx], params, layer_idx);
+                    IntersectionLines().swap(lines[layer_idx]);
+                    layer_fn(layer_idx, std::move(polygons));
+                }
+            });
+        num_layers_finished = layers_end;
+    };
+
+    for (size_t band_idx = 0; band_idx < mesh.num_bands(); ++ band_idx) {
+        throw_on_cancel();
+        {
+            BandedMesh::Band band = mesh.map_band(band_idx);
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, band.size()),
+                [&band, &zs, &lines, &lines_mutex](const tbb::blocked_range<size_t> &range) {
+                    for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
+                        const BandedFacet &facet = band[facet_idx];
+                        slice_facet_at_zs(facet.vertices, facet.indices, facet.edge_ids, zs, lines, lines_mutex);
+                    }
+                });
+        }
+        // Facets of the following bands start at or above next_min_z.
+        float next_min_z = band_idx + 1 < mesh.num_bands() ? mesh.band_info(band_idx + 1).min_z : std::numeric_limits<float>::max();
+        finish_layers(std::lower_bound(zs.begin() + num_layers_finished, zs.end(), next_min_z) - zs.begin());
+    }
+    finish_layers(zs.size());
+}
+
+std::vector<Polygons> slice_mesh(
+    const BandedMesh                 &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel)
+{
+    BOOST_LOG_TRIVIAL(debug) << "slice_mesh to polygons, " << mesh.num_bands() << " bands of " << mesh.path();
+    assert(is_identity(params.trafo));
+    std::vector<Polygons> layers(zs.size(), Polygons{});
+    slice_banded_mesh(mesh, zs, params, throw_on_cancel, [&layers](size_t layer_idx, Polygons &&polygons) {
+        layers[layer_idx] = std::move(polygons);
+    });
+    return layers;
+}
+
+std::vector<ExPolygons> slice_mesh_ex(
+    const BandedMesh                 &mesh,
+    // Unscaled Zs
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel)
+{
+    BOOST_LOG_TRIVIAL(debug) << "slice_mesh to expolygons, " << mesh.num_bands() << " bands of " << mesh.path();
+    assert(is_identity(params.trafo));
+    MeshSlicingParams slicing_params(params);
+    if (params.mode == MeshSlicingParams::SlicingMode::PositiveLargestContour)
+        slicing_params.mode = MeshSlicingParams::SlicingMode::Positive;
+    if (params.mode_below == MeshSlicingParams::SlicingMode::PositiveLargestContour)
+        slicing_params.mode_below = MeshSlicingParams::SlicingMode::Positive;
+    std::vector<ExPolygons> layers(zs.size(), ExPolygons{});
+    slice_banded_mesh(mesh, zs, slicing_params, throw_on_cancel, [&layers, &params](size_t layer_idx, Polygons &&polygons) {
+        layers[layer_idx] = make_layer_expolygons(polygons, params, layer_idx);
+    });
+    return layers;
+}
+
 // Slice a triangle set with a set of Z slabs (thick layers).
 // The effect is similar to producing the usual top / bottom layers from a sliced mesh by 
 // subtracting layer[i] from layer[i - 1] for the top surfaces resp.
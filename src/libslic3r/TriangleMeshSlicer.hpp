@@ -63,6 +63,46 @@ std::vector<Polygons>           slice_mesh(
     const MeshSlicingParams          &params,
     std::function<void()>             throw_on_cancel = []{});
 
+// Slice the mesh into the raw oriented intersection segments, without chaining them into closed loops.
+// For a closed mesh, the segments of each plane bound the slice consistently with slice_mesh(),
+// so the slice may be filled with a non-zero or even-odd winding rule directly (e.g. by a rasterizer).
+// The faces touching a plane are resolved the same way as by slice_mesh(): horizontal faces are ignored,
+// an edge lying on the plane is only produced by the face below the plane and a face touching the plane
+// with a single vertex produces no segment.
+std::vector<Lines>              slice_mesh_segments(
+    const indexed_triangle_set       &mesh,
+    const std::vector<float>         &zs,
+    const Transform3d                &trafo,
+    std::function<void()>             throw_on_cancel = []{});
+
+// Same as slice_mesh_segments(), but the segments are produced one plane at a time, thus the planes may be sliced
+// in parallel by the caller, for example while rasterizing, without holding the segments of all planes in memory.
+// The constructor prepares the transformed vertices and the lists of faces spanning each plane.
+class MeshSegmentSlicer
+{
+public:
+    MeshSegmentSlicer() = default;
+    MeshSegmentSlicer(
+        const indexed_triangle_set       &mesh,
+        const std::vector<float>         &zs,
+        const Transform3d                &trafo,
+        std::function<void()>             throw_on_cancel = []{});
+
+    size_t                          num_planes() const { return m_zs.size(); }
+    // Thread safe.
+    Lines                           slice(size_t plane_idx) const;
+
+private:
+    // XY scaled, Z unscaled.
+    std::vector<Vec3f>              m_vertices;
+    std::vector<Vec3i>              m_indices;
+    std::vector<Vec3i>              m_face_edge_ids;
+    std::vector<float>              m_zs;
+    // Indices of the non-horizontal faces spanning a plane: m_plane_faces[m_plane_faces_begin[i] .. m_plane_faces_begin[i + 1]).
+    std::vector<size_t>             m_plane_faces_begin;
+    std::vector<int>                m_plane_faces;
+};
+
 // Specialized version for a single slicing plane only, running on a single thread.
 Polygons                        slice_mesh(
     const indexed_triangle_set       &mesh,
@@ -94,6 +134,23 @@ inline std::vector<ExPolygons>  slice_mesh_ex(
     return slice_mesh_ex(mesh, zs, params, throw_on_cancel);
 }
 
+class BandedMesh;
+
+// Slice an out-of-core mesh band by band, see BandedMesh. Only a single band of triangles and the intersection lines
+// of the layers not yet finished are kept in memory, thus the peak memory is bounded by the band size rather than by the mesh size.
+// The transformation is applied by BandedMesh::create(), thus params.trafo has to be identity.
+std::vector<Polygons>           slice_mesh(
+    const BandedMesh                 &mesh,
+    const std::vector<float>         &zs,
+    const MeshSlicingParams          &params,
+    std::function<void()>             throw_on_cancel = []{});
+
+std::vector<ExPolygons>         slice_mesh_ex(
+    const BandedMesh                 &mesh,
+    const std::vector<float>         &zs,
+    const MeshSlicingParamsEx        &params,
+    std::function<void()>             throw_on_cancel = []{});
+
 // Slice a triangle set with a set of Z slabs (thick layers).
 // The effect is similar to producing the usual top / bottom layers from a sliced mesh by 
 // subtracting layer[i] from layer[i - 1] for the top surfaces resp.
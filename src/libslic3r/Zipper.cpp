@@ -1,4 +1,5 @@
 #include <exception>
+#include <deque>
 
 #include "Exception.hpp"
 #include "Zipper.hpp"
@@ -22,6 +23,47 @@ class Zipper::Impl: public MZ_Archive {
 public:
     std::string m_zipname;
 
+    // Entries being compressed on worker threads, written to the archive in
+    // the order of their addition once enough data is pending.
+    struct PendingEntry {
+        std::string        name;
+        MZ_ParallelDeflate deflate;
+    };
+    std::deque<PendingEntry> m_pending;
+    size_t                   m_pending_bytes = 0;
+
+    static constexpr size_t MaxPendingBytes = 64 * 1024 * 1024;
+
+    void add_entry(const std::string &name, const void *data, size_t bytes, mz_uint level)
+    {
+        if (level == MZ_NO_COMPRESSION) {
+            write_pending();
+            if (!mz_zip_writer_add_mem(&arch, name.c_str(), data, bytes, level))
+                blow_up();
+            return;
+        }
+
+        PendingEntry &entry = m_pending.emplace_back(PendingEntry{name, MZ_ParallelDeflate{level}});
+        entry.deflate.append(data, bytes);
+        entry.deflate.finish();
+
+        m_pending_bytes += bytes;
+        if (m_pending_bytes >= MaxPendingBytes)
+            write_pending();
+    }
+
+    void write_pending()
+    {
+        while (!m_pending.empty()) {
+            PendingEntry entry = std::move(m_pending.front());
+            m_pending.pop_front();
+            if (!entry.deflate.add_to_archive(arch, entry.name))
+                blow_up();
+        }
+
+        m_pending_bytes = 0;
+    }
+
     std::string formatted_errorstr() const
     {
         return L("Error with zip archive") + " " + m_zipname + ": " +
@@ -57,7 +99,7 @@ Zipper::~Zipper()
 {
     if(m_impl->is_alive()) {
         // Flush the current entry if not finished yet.
-        try { finish_entry(); } catch(...) {
+        try { finish_entry(); m_impl->write_pending(); } catch(...) {
             BOOST_LOG_TRIVIAL(error) << m_impl->formatted_errorstr();
         }
 
@@ -97,15 +139,7 @@ void Zipper::add_entry(const std::string &name, const void *data, size_t l)
     if(!m_impl->is_alive()) return;
 
     finish_entry();
-    mz_uint cmpr = MZ_NO_COMPRESSION;
-    switch (m_compression) {
-    case NO_COMPRESSION: cmpr = MZ_NO_COMPRESSION; break;
-    case FAST_COMPRESSION: cmpr = MZ_BEST_SPEED; break;
-    case TIGHT_COMPRESSION: cmpr = MZ_BEST_COMPRESSION; break;
-    }
-
-    if(!mz_zip_writer_add_mem(&m_impl->arch, name.c_str(), data, l, cmpr))
-        m_impl->blow_up();
+    m_impl->add_entry(name, data, l, compression_level());
 
     m_entry.clear();
     m_data.clear();
@@ -115,20 +149,8 @@ void Zipper::finish_entry()
 {
     if(!m_impl->is_alive()) return;
 
-    if(!m_data.empty() && !m_entry.empty()) {
-        mz_uint compression = MZ_NO_COMPRESSION;
-
-        switch (m_compression) {
-        case NO_COMPRESSION: compression = MZ_NO_COMPRESSION; break;
-        case FAST_COMPRESSION: compression = MZ_BEST_SPEED; break;
-        case TIGHT_COMPRESSION: compression = MZ_BEST_COMPRESSION; break;
-        }
-
-        if(!mz_zip_writer_add_mem(&m_impl->arch, m_entry.c_str(),
-                                  m_data.c_str(),
-                                  m_data.size(),
-                                  compression)) m_impl->blow_up();
-    }
+    if(!m_data.empty() && !m_entry.empty())
+        m_impl->add_entry(m_entry, m_data.data(), m_data.size(), compression_level());
 
     m_data.clear();
     m_entry.clear();
@@ -138,8 +160,22 @@ void Zipper::finalize()
 {
     finish_entry();
 
-    if(m_impl->is_alive()) if(!mz_zip_writer_finalize_archive(&m_impl->arch))
-        m_impl->blow_up();
+    if(m_impl->is_alive()) {
+        m_impl->write_pending();
+        if(!mz_zip_writer_finalize_archive(&m_impl->arch))
+            m_impl->blow_up();
+    }
+}
+
+unsigned Zipper::compression_level() const
+{
+    switch (m_compression) {
+    case NO_COMPRESSION: return MZ_NO_COMPRESSION;
+    case FAST_COMPRESSION: return MZ_BEST_SPEED;
+    case TIGHT_COMPRESSION: return MZ_BEST_COMPRESSION;
+    }
+
+    return MZ_NO_COMPRESSION;
 }
 
 const std::string &Zipper::get_filename() const
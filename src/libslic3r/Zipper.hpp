@@ -7,7 +7,9 @@
 
 namespace Slic3r {
 
-// Class for creating zip archives.
+// Class for creating zip archives. Unless stored without compression, the
+// entries are compressed on worker threads and written to the file in the
+// order of their addition, a batch at a time.
 class Zipper {
 public:
     // Three compression levels supported
@@ -24,6 +26,8 @@ private:
     std::string m_entry;
     e_compression m_compression;
 
+    unsigned compression_level() const;
+
 public:
 
     // Will blow up in a runtime exception if the file cannot be created.
@@ -77,11 +81,14 @@ public:
     /// If the buffer was written, but no entry was added, the buffer will be
     /// cleared after this call.
     ///
-    /// This method will throw a runtime exception if an error occures. The
-    /// entry will still be open (with the data intact) but the state of the
-    /// file is up to minz after the erroneous write.
+    /// This method will throw a runtime exception if an error occures while
+    /// writing the pending entries. As the entries are compressed in the
+    /// background, the error may belong to a previously finished entry. The
+    /// state of the file is up to minz after the erroneous write.
     void finish_entry();
 
+    /// Write all the pending entries and the central directory. Throws like
+    /// finish_entry() does.
     void finalize();
 
     const std::string & get_filename() const;
@@ -1,7 +1,17 @@
 #include <exception>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "miniz_extension.hpp"
 
+#include <tbb/task_group.h>
+
 #if defined(_MSC_VER) || defined(__MINGW64__)
 #include "boost/nowide/cstdio.hpp"
 #endif
@@ -156,4 +166,183 @@ std::string MZ_Archive::get_errorstr(mz_zip_error mz_err)
     return "unknown error";
 }
 
+namespace {
+
+// Compress a single block of a deflate stream with a fresh compressor. The
+// block does not refer to the data of the previous blocks. The last block is
+// finished, the other ones are ended with a full flush at a byte boundary.
+bool deflate_block(const std::string &src, std::string &dst, mz_uint level, bool last)
+{
+    std::unique_ptr<tdefl_compressor, decltype(&free)> comp(
+        static_cast<tdefl_compressor *>(malloc(sizeof(tdefl_compressor))), &free);
+
+    if (!comp)
+        return false;
+
+    auto put_buf = [](const void *buf, int len, void *user) -> mz_bool {
+        static_cast<std::string *>(user)->append(static_cast<const char *>(buf), size_t(len));
+        return MZ_TRUE;
+    };
+
+    // Negative window bits make a raw deflate stream without the zlib header.
+    int flags = int(tdefl_create_comp_flags_from_zip_params(int(level), -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+    if (tdefl_init(comp.get(), put_buf, &dst, flags) != TDEFL_STATUS_OKAY)
+        return false;
+
+    dst.reserve(src.size() / 2);
+    tdefl_status status = tdefl_compress_buffer(comp.get(), src.data(), src.size(),
+                                                last ? TDEFL_FINISH : TDEFL_FULL_FLUSH);
+
+    return status == (last ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+}
+
+} // namespace
+
+class MZ_ParallelDeflate::Impl {
+public:
+    enum BlockState { Pending, Running, Done };
+    struct Block {
+        std::string data, compressed;
+        bool        last = false;
+        // A block is compressed either by a worker or by add_to_archive() if no worker picked it up yet.
+        std::atomic<int> state { Pending };
+    };
+
+    mz_uint   level;
+    size_t    block_size;
+    mz_uint32 crc  = MZ_CRC32_INIT;
+    mz_uint64 size = 0;
+    bool      finished = false;
+
+    std::string current;
+    // The compressed blocks are kept in order, a deque keeps the references
+    // held by the workers valid.
+    std::deque<Block> blocks;
+    std::atomic<bool> failed { false };
+    std::atomic<size_t> done { 0 };
+    // Signals a block being Done.
+    std::mutex              mutex;
+    std::condition_variable cond;
+    tbb::task_group tasks;
+
+    Impl(mz_uint lvl, size_t bsize) : level(lvl), block_size(std::max(bsize, size_t(1))) {}
+    ~Impl() { tasks.wait(); }
+
+    void compress(Block &block)
+    {
+        int expected = Pending;
+        if (!block.state.compare_exchange_strong(expected, Running))
+            return;
+        if (!deflate_block(block.data, block.compressed, level, block.last))
+            failed = true;
+        // Release the uncompressed data.
+        std::string().swap(block.data);
+        ++done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            block.state = Done;
+        }
+        cond.notify_all();
+    }
+
+    // Compress the block on this thread if no worker took it yet, otherwise wait for the worker.
+    void wait_for(Block &block)
+    {
+        compress(block);
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&block] { return block.state == Done; });
+    }
+
+    void dispatch(bool last)
+    {
+        // Do not let the uncompressed data pile up if the compression is
+        // slower than the producer of the data.
+        size_t max_pending = 2 * std::max(std::thread::hardware_concurrency(), 1u);
+        if (blocks.size() - done >= max_pending)
+            tasks.wait();
+
+        Block &block = blocks.emplace_back();
+        block.data.swap(current);
+        block.last = last;
+        crc = mz_uint32(mz_crc32(crc, reinterpret_cast<const mz_uint8 *>(block.data.data()), block.data.size()));
+
+        tasks.run([this, &block] { compress(block); });
+    }
+};
+
+MZ_ParallelDeflate::MZ_ParallelDeflate(mz_uint level, size_t block_size)
+    : m_impl(new Impl(level, block_size))
+{}
+
+MZ_ParallelDeflate::~MZ_ParallelDeflate() = default;
+MZ_ParallelDeflate::MZ_ParallelDeflate(MZ_ParallelDeflate &&) = default;
+MZ_ParallelDeflate &MZ_ParallelDeflate::operator=(MZ_ParallelDeflate &&) = default;
+
+bool MZ_ParallelDeflate::append(const void *data, size_t size)
+{
+    assert(!m_impl->finished);
+
+    const char *ptr = static_cast<const char *>(data);
+    m_impl->size += size;
+    while (size > 0) {
+        size_t n = std::min(size, m_impl->block_size - m_impl->current.size());
+        if (m_impl->current.empty())
+            m_impl->current.reserve(m_impl->block_size);
+        m_impl->current.append(ptr, n);
+        ptr  += n;
+        size -= n;
+        if (m_impl->current.size() == m_impl->block_size)
+            m_impl->dispatch(false);
+    }
+
+    return !m_impl->failed;
+}
+
+void MZ_ParallelDeflate::finish()
+{
+    if (!m_impl->finished) {
+        // The last block may be empty, it then carries just the final marker.
+        m_impl->dispatch(true);
+        m_impl->finished = true;
+    }
+}
+
+mz_uint64 MZ_ParallelDeflate::size() const { return m_impl->size; }
+
+bool MZ_ParallelDeflate::add_to_archive(mz_zip_archive &zip, const std::string &name, mz_uint64 max_size, mz_uint flags)
+{
+    finish();
+
+    // Empty entries are stored, as they would be by miniz.
+    if (m_impl->size == 0) {
+        m_impl->tasks.wait();
+        return mz_zip_writer_add_mem(&zip, name.c_str(), nullptr, 0, flags);
+    }
+
+    // The compressed blocks are written in order as soon as they are ready.
+    mz_zip_writer_staged_context context;
+    if (!mz_zip_writer_add_staged_open(&zip, &context, name.c_str(), std::max(max_size, m_impl->size), nullptr, nullptr, 0,
+                                       m_impl->level | flags | MZ_ZIP_FLAG_COMPRESSED_DATA, nullptr, 0, nullptr, 0)) {
+        m_impl->tasks.wait();
+        return false;
+    }
+
+    bool ok = true;
+    for (Impl::Block &block : m_impl->blocks) {
+        m_impl->wait_for(block);
+        if (m_impl->failed) {
+            zip.m_last_error = MZ_ZIP_COMPRESSION_FAILED;
+            ok = false;
+            break;
+        }
+        ok = mz_zip_writer_add_staged_data(&context, block.compressed.data(), block.compressed.size());
+        std::string().swap(block.compressed);
+        if (!ok)
+            break;
+    }
+    m_impl->tasks.wait();
+
+    return ok && mz_zip_writer_add_staged_finish_compressed(&context, m_impl->size, m_impl->crc);
+}
+
 } // namespace Slic3r
@@ -2,6 +2,7 @@
 #define MINIZ_EXTENSION_HPP
 
 #include <string>
+#include <memory>
 #include <miniz.h>
 
 namespace Slic3r {
@@ -30,6 +31,42 @@ public:
     }
 };
 
+// Compresses a stream of data with the deflate method in independent blocks
+// on worker threads. Each block is ended with a full flush, thus the
+// concatenation of the compressed blocks is a valid deflate stream, which is
+// then stored into a zip archive as already compressed data.
+class MZ_ParallelDeflate {
+public:
+    static constexpr size_t DefaultBlockSize = 4 * 1024 * 1024;
+
+    explicit MZ_ParallelDeflate(mz_uint level      = MZ_DEFAULT_LEVEL,
+                                size_t  block_size = DefaultBlockSize);
+    ~MZ_ParallelDeflate();
+
+    MZ_ParallelDeflate(MZ_ParallelDeflate &&);
+    MZ_ParallelDeflate &operator=(MZ_ParallelDeflate &&);
+
+    // Append data to the stream, full blocks are compressed in the background.
+    // Returns false if the compression of a previous block has failed.
+    bool append(const void *data, size_t size);
+
+    // Start compressing the rest of the data. No data may be appended after.
+    void finish();
+
+    // Number of the uncompressed bytes appended so far.
+    mz_uint64 size() const;
+
+    // Add the compressed stream as a new entry of the archive, the blocks are
+    // written in order as their compression completes. A max_size above 4GB-1
+    // reserves the zip64 fields in the local header. Returns false on failure,
+    // the archive then carries the error code.
+    bool add_to_archive(mz_zip_archive &zip, const std::string &name, mz_uint64 max_size = 0, mz_uint flags = 0);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
 } // namespace Slic3r
 
 #endif // MINIZ_EXTENSION_HPP
@@ -6714,16 +6714,15 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
         level_and_flags = MZ_DEFAULT_LEVEL;
     level = level_and_flags & 0xF;
 
+    pContext->compressed_data = (level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA) != 0;
+
     /* Sanity checks */
-    if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || (!pArchive_name) || ((comment_size) && (!pComment)) || (level == 0) || (level > MZ_UBER_COMPRESSION) || (max_size < 4))
+    if ((!pZip) || (!pZip->m_pState) || (pZip->m_zip_mode != MZ_ZIP_MODE_WRITING) || (!pArchive_name) || ((comment_size) && (!pComment)) ||
+        (! pContext->compressed_data && ((level == 0) || (level > MZ_UBER_COMPRESSION) || (max_size < 4))) || (max_size == 0))
         return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
 
     pState = pZip->m_pState;
 
-    /* We could support this, but why? */
-    if (level_and_flags & MZ_ZIP_FLAG_COMPRESSED_DATA)
-        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
-
     if (!mz_zip_writer_validate_archive_name(pArchive_name))
         return mz_zip_set_error(pZip, MZ_ZIP_INVALID_FILENAME);
 
@@ -6832,6 +6831,15 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     }
 
     assert(max_size);
+
+    pContext->add_state.m_pZip = pZip;
+    pContext->add_state.m_cur_archive_file_ofs = pContext->cur_archive_file_ofs;
+    pContext->add_state.m_comp_size = 0;
+
+    /* Already compressed data is written as is. */
+    if (pContext->compressed_data)
+        return MZ_TRUE;
+
     assert(level);
 
     pContext->pCompressor = (tdefl_compressor*)pZip->m_pAlloc(pZip->m_pAlloc_opaque, 1, sizeof(tdefl_compressor));
@@ -6840,10 +6848,6 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
         return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
     }
 
-    pContext->add_state.m_pZip = pZip;
-    pContext->add_state.m_cur_archive_file_ofs = pContext->cur_archive_file_ofs;
-    pContext->add_state.m_comp_size = 0;
-
     if (tdefl_init(pContext->pCompressor, mz_zip_writer_add_put_buf_callback, &pContext->add_state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
     {
         pZip->m_pFree(pZip->m_pAlloc_opaque, pContext->pCompressor);
@@ -6857,6 +6861,10 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
 {
     tdefl_flush  flush = TDEFL_NO_FLUSH;
 
+    if (pContext->compressed_data)
+        return mz_zip_writer_add_put_buf_callback(pRead_buf, (int)n, &pContext->add_state) ? MZ_TRUE :
+            mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_WRITE_FAILED);
+
     if (pContext->file_ofs + n > pContext->max_size)
     {
         mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_READ_FAILED);
@@ -6883,15 +6891,30 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+mz_bool mz_zip_writer_add_staged_finish_compressed(mz_zip_writer_staged_context *pContext, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32)
+{
+    if (! pContext->compressed_data || uncomp_size > pContext->max_size)
+        return mz_zip_set_error(pContext->pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    pContext->file_ofs     = uncomp_size;
+    pContext->uncomp_crc32 = uncomp_crc32;
+    return mz_zip_writer_add_staged_finish(pContext);
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
-    if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
-        // Either never opened, or already finished.
-        ! pContext->pCompressor)
-        return MZ_FALSE;
+    if (pContext->compressed_data) {
+        // Only finished once.
+        pContext->compressed_data = MZ_FALSE;
+    } else {
+        if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
+            // Either never opened, or already finished.
+            ! pContext->pCompressor)
+            return MZ_FALSE;
 
-    pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
-    pContext->pCompressor = NULL;
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+    }
 
     // Rewrite preallocated phony custom block in local dir header by ZIP64 extension. Also, other values are adjusted in the header.
     if (pContext->file_ofs >= MZ_UINT32_MAX || pContext->add_state.m_comp_size >= MZ_UINT32_MAX) {
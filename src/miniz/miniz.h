@@ -1332,6 +1332,8 @@ typedef struct mz_zip_writer_staged_context
     mz_zip_writer_add_state  add_state;
     tdefl_compressor        *pCompressor;
     mz_uint64                file_ofs;
+    /* Data passed to mz_zip_writer_add_staged_data() is already compressed. */
+    mz_bool                  compressed_data;
 
     /*
      * The following data is passed to the "finish" stage, the referenced pointers must still be valid!
@@ -1350,6 +1352,10 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
+/* With MZ_ZIP_FLAG_COMPRESSED_DATA passed to mz_zip_writer_add_staged_open(), the data passed to mz_zip_writer_add_staged_data() is a raw deflate stream, */
+/* which is stored as is. Such an entry is finished by mz_zip_writer_add_staged_finish_compressed() with the size and CRC-32 of the uncompressed data, */
+/* max_size is then the maximum size of the uncompressed data. */
+mz_bool mz_zip_writer_add_staged_finish_compressed(mz_zip_writer_staged_context* pContext, mz_uint64 uncomp_size, mz_uint32 uncomp_crc32);
 
 /* Adds a file to an archive by fully cloning the data from another archive. */
 /* This function fully clones the source file's compressed data (no recompression), along with its full filename, extra data (it may add or modify the zip64 local header extra data field), and the optional descriptor following the compressed data. */
@@ -452,7 +452,11 @@ void GLGizmoSimplify::process()
 
         // Start the actual calculation.
         try {
-            its_quadric_edge_collapse(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
+            // Big meshes are simplified in parallel batches of independent edge collapses.
+            if (its->indices.size() > 1000000)
+                its_quadric_edge_collapse_par(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
+            else
+                its_quadric_edge_collapse(*its, triangle_count, &max_error, throw_on_cancel, statusfn);
         } catch (SimplifyCanceledException &) {
             std::lock_guard lk(m_state_mutex);
             m_state.status = State::idle;
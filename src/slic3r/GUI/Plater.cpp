@@ -2481,7 +2481,8 @@ std::vector<size_t> Plater::priv::load_files(const std::vector<fs::path>& input_
                 }
             }
             else {
-                model = Slic3r::Model::read_from_file(path.string(), nullptr, nullptr, only_if(load_config, Model::LoadAttribute::CheckVersion));
+                model = Slic3r::Model::read_from_file(path.string(), nullptr, nullptr,
+                    only_if(load_config, Model::LoadAttribute::CheckVersion) | only_if(wxGetApp().app_config->get("mesh_cache") == "1", Model::LoadAttribute::UseMeshCache));
                 for (auto obj : model.objects)
                     if (obj->name.empty())
                         obj->name = fs::path(obj->input_file).filename().string();
@@ -150,6 +150,14 @@ void PreferencesDialog::build(size_t selected_tab)
 		option = Option(def, "export_sources_full_pathnames");
 		m_optgroup_general->append_single_option_line(option);
 
+		def.label = L("Cache imported STL and OBJ meshes");
+		def.type = coBool;
+		def.tooltip = L("If enabled, the repaired meshes of imported STL and OBJ files are stored in the configuration folder, "
+			"so that loading the same files again is faster.");
+		def.set_default_value(new ConfigOptionBool(app_config->get("mesh_cache") == "1"));
+		option = Option(def, "mesh_cache");
+		m_optgroup_general->append_single_option_line(option);
+
 #ifdef _WIN32
 		// Please keep in sync with ConfigWizard
 		def.label = L("Associate .3mf files to PrusaSlicer");
@@ -1649,6 +1649,7 @@ void TabPrint::build()
         optgroup = page->new_optgroup(L("Slicing"));
         optgroup->append_single_option_line("slice_closing_radius");
         optgroup->append_single_option_line("slicing_mode");
+        optgroup->append_single_option_line("slicing_out_of_core_facets");
         optgroup->append_single_option_line("resolution");
         optgroup->append_single_option_line("gcode_resolution");
         optgroup->append_single_option_line("xy_size_compensation");
@@ -2505,6 +2506,7 @@ void TabPrinter::build_sla()
     optgroup->append_single_option_line("elefant_foot_compensation");
     optgroup->append_single_option_line("elefant_foot_min_width");
     optgroup->append_single_option_line("gamma_correction");
+    optgroup->append_single_option_line("rasterize_from_mesh");
     
     optgroup = page->new_optgroup(L("Exposure"));
     optgroup->append_single_option_line("min_exposure_time");
@@ -83,3 +83,31 @@ SCENARIO("ExtrusionEntityCollection: Polygon flattening", "[ExtrusionEntity]") {
         }
     }
 }
+
+SCENARIO("ExtrusionEntityCollection: Cloning", "[ExtrusionEntity]") {
+    srand(0xDEADBEEF); // consistent seed for test reproducibility.
+
+    GIVEN("A Extrusion Entity Collection with a nested collection") {
+        Slic3r::ExtrusionEntityCollection sub;
+        sub.append(random_paths());
+        Slic3r::ExtrusionEntityCollection sample;
+        sample.append(random_paths(3));
+        sample.append(sub);
+
+        WHEN("The EEC is cloned") {
+            std::unique_ptr<ExtrusionEntity> clone(sample.clone());
+            auto *cloned = dynamic_cast<ExtrusionEntityCollection*>(clone.get());
+            THEN("The clone is a deep copy with the same entities in the same order") {
+                REQUIRE(cloned != nullptr);
+                REQUIRE(cloned->entities.size() == sample.entities.size());
+                CHECK(cloned->items_count() == sample.items_count());
+                for (size_t i = 0; i < sample.entities.size(); ++ i) {
+                    CHECK(cloned->entities[i] != sample.entities[i]);
+                    CHECK(cloned->entities[i]->is_collection() == sample.entities[i]->is_collection());
+                    CHECK(cloned->entities[i]->first_point() == sample.entities[i]->first_point());
+                    CHECK(cloned->entities[i]->last_point() == sample.entities[i]->last_point());
+                }
+            }
+        }
+    }
+}
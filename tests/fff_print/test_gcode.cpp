@@ -2,7 +2,12 @@
 
 #include <memory>
 
+#include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/AvoidCrossingPerimeters.hpp"
+#include "libslic3r/GCode/CoolingBuffer.hpp"
+#include "libslic3r/GCode/PressureEqualizer.hpp"
+#include "libslic3r/GCode/WipeTower.hpp"
 
 using namespace Slic3r;
 
@@ -20,3 +25,235 @@ SCENARIO("Origin manipulation", "[GCode]") {
     	}
     }
 }
+
+SCENARIO("Cooling buffer handles extrusion blocks the same way as the parsed G-code", "[GCode]") {
+	GIVEN("G-code generator with cooling enabled and a short layer") {
+		PrintConfig print_config;
+		print_config.cooling.values                   = { true };
+		print_config.slowdown_below_layer_time.values = { 100 };
+		print_config.min_print_speed.values           = { 10. };
+		print_config.use_relative_e_distances.value   = true;
+		Slic3r::GCode gcodegen;
+		gcodegen.apply_print_config(print_config);
+		GCodeWriter &writer = gcodegen.writer();
+		writer.set_extruders({ 0 });
+		writer.set_extruder(0);
+
+		// Emit a layer the same way GCode::_extrude() does, recording the extrusion blocks.
+		std::string                    gcode;
+		CoolingBuffer::ExtrusionBlocks blocks;
+		writer.travel_to_z(gcode, 0.2);
+		for (int i = 0; i < 4; ++ i) {
+			bool  bridge   = i == 2;
+			Vec2d position = Vec2d(10. * i, 5.);
+			writer.retract(gcode);
+			writer.travel_to_xy(gcode, position);
+			writer.unretract(gcode);
+			if (bridge)
+				gcode += ";_BRIDGE_FAN_START\n";
+			CoolingBuffer::ExtrusionBlock block;
+			block.set_speed_start = gcode.size();
+			writer.set_speed(gcode, 1800., "", bridge ? "" : ";_EXTRUDE_SET_SPEED");
+			block.set_speed_end = gcode.size();
+			for (int j = 1; j <= 3; ++ j)
+				writer.extrude_to_xy(gcode, position + Vec2d(2. * j, double(j % 2)), 0.1);
+			block.moves_end = gcode.size();
+			gcode += bridge ? ";_BRIDGE_FAN_END\n" : ";_EXTRUDE_END\n";
+			block.end                = gcode.size();
+			block.feedrate           = 30.f;
+			block.length             = float(3. * sqrt(5.));
+			block.x                  = float(writer.get_position().x());
+			block.y                  = float(writer.get_position().y());
+			block.e                  = float(writer.extruder()->E());
+			block.adjustable         = ! bridge;
+			block.external_perimeter = false;
+			block.bridge             = bridge;
+			blocks.emplace_back(block);
+		}
+
+		WHEN("The layer is processed with and without the extrusion blocks") {
+			CoolingBuffer parsed(gcodegen);
+			CoolingBuffer structured(gcodegen);
+			std::string gcode_parsed     = parsed.process_layer(std::string(gcode), 1, true);
+			std::string gcode_structured = structured.process_layer(std::move(gcode), std::move(blocks), 1, true);
+			THEN("The extrusions are slowed down to the minimum print speed") {
+				REQUIRE(gcode_parsed.find("G1 F600") != std::string::npos);
+			}
+			THEN("The resulting G-code is the same") {
+				REQUIRE(gcode_parsed == gcode_structured);
+			}
+		}
+	}
+}
+
+SCENARIO("Pressure equalizer limits the extrusion rate changes between extrusion roles", "[GCode]") {
+	GIVEN("Two layers of slow perimeters followed by fast infill") {
+		PrintConfig config;
+		// Emit a layer of G-code the way GCode does with m_enable_extrusion_role_markers set.
+		float e = 0.f;
+		auto layer = [&e](float z) {
+			std::string gcode = "G1 Z" + std::to_string(z) + " F7800\n";
+			auto extrude = [&gcode, &e](ExtrusionRole role, float feedrate) {
+				gcode += ";_EXTRUSION_ROLE:" + std::to_string(int(role)) + "\n";
+				gcode += "G1 F" + std::to_string(int(feedrate)) + "\n";
+				for (int i = 0; i < 30; ++ i) {
+					e += 0.1f;
+					gcode += "G1 X" + std::to_string(10 * (i % 2)) + " Y" + std::to_string(i) + " E" + std::to_string(e) + "\n";
+				}
+			};
+			extrude(erPerimeter, 1200.f);
+			extrude(erInternalInfill, 6000.f);
+			return gcode;
+		};
+		std::string layer1 = layer(0.2f);
+		std::string layer2 = layer(0.4f);
+		WHEN("The layers are processed one by one and at once") {
+			PressureEqualizer by_layer(&config);
+			PressureEqualizer at_once(&config);
+			std::string out_by_layer = by_layer.process_layer(std::string(layer1), false);
+			out_by_layer += by_layer.process_layer(std::string(layer2), false);
+			out_by_layer += by_layer.process_layer(std::string(), true);
+			std::string out_at_once  = at_once.process_layer(layer1 + layer2, true);
+			THEN("The output does not depend on how the G-code is split into layers") {
+				REQUIRE(out_by_layer == out_at_once);
+			}
+			THEN("The extrusion role markers are removed") {
+				REQUIRE(out_by_layer.find(";_EXTRUSION_ROLE") == std::string::npos);
+			}
+			THEN("The infill extrusion rate is ramped up") {
+				REQUIRE(out_by_layer != layer1 + layer2);
+				// Some of the infill moves were slowed down below the infill feed rate.
+				size_t num_ramped = 0;
+				for (size_t pos = out_by_layer.find(" F"); pos != std::string::npos; pos = out_by_layer.find(" F", pos + 2)) {
+					float feedrate = std::stof(out_by_layer.substr(pos + 2));
+					if (feedrate > 1200.f + EPSILON && feedrate < 6000.f - EPSILON)
+						++ num_ramped;
+				}
+				REQUIRE(num_ramped > 0);
+			}
+			THEN("The extruded filament is not changed") {
+				std::string last_e = out_by_layer.substr(out_by_layer.rfind(" E") + 2);
+				REQUIRE(std::stof(last_e) == Approx(e));
+			}
+		}
+	}
+}
+
+SCENARIO("Travel router finds the shortest path inside a U-shaped boundary", "[GCode]") {
+	GIVEN("U-shaped boundary with a notch between its arms") {
+		const Polygon u_shape({ { 0, 0 }, { 30, 0 }, { 30, 30 }, { 20, 30 }, { 20, 10 }, { 10, 10 }, { 10, 30 }, { 0, 30 } });
+		Polygon boundary = u_shape;
+		boundary.scale(scale_(1.));
+		auto layer_boundaries = std::make_shared<AvoidCrossingPerimeters::LayerBoundaries>();
+		layer_boundaries->internal.init({ boundary });
+		AvoidCrossingPerimeters::TravelRouter router;
+		router.init(layer_boundaries, layer_boundaries->internal);
+
+		WHEN("Travelling from the tip of one arm to the tip of the other arm") {
+			const Point start = Point::new_scale(5., 25.);
+			const Point end   = Point::new_scale(25., 25.);
+			Points      path;
+			REQUIRE(router.shortest_path(start, end, path));
+			Polyline route;
+			route.append(start);
+			route.append(path);
+			route.append(end);
+			THEN("The route goes around the notch") {
+				REQUIRE(path.size() == 2);
+			}
+			THEN("The route stays inside the boundary") {
+				double length_inside = 0.;
+				for (const Polyline &pl : intersection_pl(Polylines{ route }, Polygons{ boundary }))
+					length_inside += pl.length();
+				REQUIRE(length_inside == Approx(route.length()));
+			}
+			THEN("The route is not longer than the walk along the contour") {
+				// Along the arm to the bottom of the notch, along the bottom of the notch and up the other arm.
+				const double contour_walk = 5. + 15. + 10. + 15. + 5.;
+				REQUIRE(unscale<double>(route.length()) <= contour_walk);
+				REQUIRE(unscale<double>(route.length()) == Approx(2. * sqrt(5. * 5. + 15. * 15.) + 10.).epsilon(0.01));
+			}
+			THEN("The same route is returned once the router is initialized with the same boundary again") {
+				router.init(layer_boundaries, layer_boundaries->internal);
+				Points path2;
+				REQUIRE(router.shortest_path(start, end, path2));
+				REQUIRE(path2 == path);
+			}
+		}
+		WHEN("Travelling inside a single arm") {
+			Points path { Point(1, 1) };
+			THEN("The direct travel is returned") {
+				REQUIRE(router.shortest_path(Point::new_scale(5., 5.), Point::new_scale(5., 25.), path));
+				REQUIRE(path.empty());
+			}
+		}
+	}
+}
+
+SCENARIO("Wipe tower emits the same G-code in parallel and reuses its layout", "[GCode]") {
+	GIVEN("Single extruder multi material printer with four filaments") {
+		PrintConfig config;
+		config.single_extruder_multi_material.value = true;
+		config.temperature.values = { 200, 210, 220, 230 };
+		std::vector<std::vector<float>> wipe_volumes(4, std::vector<float>(4, 140.f));
+		for (size_t i = 0; i < wipe_volumes.size(); ++ i)
+			wipe_volumes[i][i] = 0.f;
+
+		// Plan two tool changes on each of the lower ten layers, the upper ten layers are sparse.
+		auto generate = [&wipe_volumes](const PrintConfig &config, WipeTower::LayoutCache *layout_cache, bool parallel) {
+			const unsigned int num_extruders = (unsigned int)wipe_volumes.size();
+			WipeTower wipe_tower(config, wipe_volumes, 0);
+			for (size_t i = 0; i < num_extruders; ++ i)
+				wipe_tower.set_extruder(i, config);
+			unsigned int tool = 0;
+			for (int layer = 0; layer < 20; ++ layer) {
+				float z = 0.2f * float(layer + 1);
+				wipe_tower.plan_toolchange(z, 0.2f, tool, tool);
+				for (int i = 0; layer < 10 && i < 2; ++ i) {
+					unsigned int next = (tool + 1) % num_extruders;
+					wipe_tower.plan_toolchange(z, 0.2f, tool, next, wipe_volumes[tool][next]);
+					tool = next;
+				}
+			}
+			std::vector<std::vector<WipeTower::ToolChangeResult>> result;
+			wipe_tower.generate(result, layout_cache, parallel);
+			REQUIRE(result.size() == 20);
+			std::string gcode;
+			for (const std::vector<WipeTower::ToolChangeResult> &layer : result)
+				for (const WipeTower::ToolChangeResult &tcr : layer)
+					gcode += tcr.gcode;
+			return gcode;
+		};
+
+		WHEN("The layers are generated serially and in parallel") {
+			std::string serial   = generate(config, nullptr, false);
+			std::string parallel = generate(config, nullptr, true);
+			THEN("The G-code is the same") {
+				REQUIRE(! serial.empty());
+				REQUIRE(serial == parallel);
+			}
+		}
+		WHEN("The tower is generated again with a layout cache") {
+			WipeTower::LayoutCache layout_cache;
+			std::string gcode = generate(config, &layout_cache, true);
+			REQUIRE(layout_cache.num_layouts() == 1);
+			THEN("The layout is reused if nothing changed") {
+				REQUIRE(generate(config, &layout_cache, true) == gcode);
+				REQUIRE(layout_cache.num_layouts() == 1);
+			}
+			THEN("The layout is reused if the temperatures change") {
+				config.temperature.values = { 205, 215, 225, 235 };
+				std::string gcode_temperature = generate(config, &layout_cache, true);
+				REQUIRE(layout_cache.num_layouts() == 1);
+				REQUIRE(gcode_temperature != gcode);
+				REQUIRE(gcode_temperature == generate(config, nullptr, false));
+			}
+			THEN("The layout is calculated again if the ramming changes") {
+				config.filament_ramming_parameters.values = { "120 100 10 10 10 10 10 10 10 10 10 10 10 10" };
+				std::string gcode_ramming = generate(config, &layout_cache, true);
+				REQUIRE(layout_cache.num_layouts() == 2);
+				REQUIRE(gcode_ramming == generate(config, nullptr, false));
+			}
+		}
+	}
+}
@@ -94,3 +94,47 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("Append-style G-code emitting produces the same output as the string returning API.", "[GCodeWriter]") {
+
+    GIVEN("Two GCodeWriter instances with two extruders") {
+        GCodeWriter writer1, writer2;
+        for (GCodeWriter *writer : { &writer1, &writer2 }) {
+            writer->config.gcode_comments.value = true;
+            writer->set_extruders({ 0, 1 });
+        }
+        WHEN("a sequence of moves is emitted by both APIs") {
+            std::string expected;
+            expected += writer1.toolchange(1);
+            expected += writer1.set_speed(1200., "", ";_EXTRUDE_SET_SPEED");
+            expected += writer1.extrude_to_xy(Vec2d(10., 20.), 0.5, "perimeter");
+            expected += writer1.retract();
+            expected += writer1.lift();
+            expected += writer1.travel_to_xy(Vec2d(30., 5.), "travel");
+            expected += writer1.unlift();
+            expected += writer1.unretract();
+            expected += writer1.set_acceleration(1000);
+
+            std::string out;
+            writer2.toolchange(out, 1);
+            writer2.set_speed(out, 1200., "", ";_EXTRUDE_SET_SPEED");
+            writer2.extrude_to_xy(out, Vec2d(10., 20.), 0.5, "perimeter");
+            writer2.retract(out);
+            writer2.lift(out);
+            writer2.travel_to_xy(out, Vec2d(30., 5.), "travel");
+            writer2.unlift(out);
+            writer2.unretract(out);
+            writer2.set_acceleration(out, 1000);
+            THEN("The emitted G-code is identical") {
+                REQUIRE(out == expected);
+            }
+        }
+    }
+    GIVEN("Fan speed set to 50%") {
+        THEN("The fan speed is emitted in the same format as before") {
+            std::string out;
+            GCodeWriter::set_fan(out, gcfMarlinLegacy, false, 50);
+            REQUIRE_THAT(out, Catch::Equals("M106 S127.5\n"));
+        }
+    }
+}
@@ -126,3 +126,80 @@ SCENARIO("Print: Brim generation", "[Print]") {
         }
     }
 }
+
+SCENARIO("Print: Slicing out of core", "[Print]") {
+    GIVEN("20mm cube and a model with overhangs") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        Slic3r::Print print, print_out_of_core;
+        Slic3r::Model model, model_out_of_core;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20, TestMesh::overhang}, print, model, config);
+        config.set_deserialize_strict({ { "slicing_out_of_core_facets", 1 } });
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20, TestMesh::overhang}, print_out_of_core, model_out_of_core, config);
+        print.process();
+        print_out_of_core.process();
+        THEN("The layers are the same as if sliced in memory") {
+            REQUIRE(print_out_of_core.objects().size() == print.objects().size());
+            for (size_t i = 0; i < print.objects().size(); ++ i) {
+                const PrintObject &object            = *print.objects()[i];
+                const PrintObject &object_out_of_core = *print_out_of_core.objects()[i];
+                REQUIRE(object_out_of_core.layers().size() == object.layers().size());
+                for (size_t j = 0; j < object.layers().size(); ++ j) {
+                    const ExPolygons &slices             = object.layers()[j]->lslices;
+                    const ExPolygons &slices_out_of_core = object_out_of_core.layers()[j]->lslices;
+                    REQUIRE(slices_out_of_core.size() == slices.size());
+                    REQUIRE(area(slices_out_of_core) == Approx(area(slices)));
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Print: Low memory mode", "[Print]") {
+    GIVEN("20mm cube with supports and a bridge") {
+        auto layer_memsize = [](const Print &print) {
+            LayerMemsize out;
+            for (const PrintObject *object : print.objects()) {
+                for (const Layer *layer : object->layers())
+                    out += layer->memsize();
+                for (const SupportLayer *layer : object->support_layers())
+                    out += layer->memsize();
+            }
+            return out;
+        };
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "support_material",   true },
+            { "fill_density",       "20%" }
+        });
+        Slic3r::Print print, print_low_memory;
+        Slic3r::Model model, model_low_memory;
+        Slic3r::Test::init_print({TestMesh::overhang}, print, model, config);
+        Slic3r::Test::init_print({TestMesh::overhang}, print_low_memory, model_low_memory, config);
+        print_low_memory.set_low_memory(true);
+        // Strip the "generated by" header line with the timestamp.
+        auto strip_header = [](std::string gcode) { return gcode.erase(0, gcode.find('\n') + 1); };
+        std::string gcode            = strip_header(Slic3r::Test::gcode(print));
+        std::string gcode_low_memory = strip_header(Slic3r::Test::gcode(print_low_memory));
+        THEN("The G-code is not changed") {
+            REQUIRE(! gcode_low_memory.empty());
+            REQUIRE(gcode_low_memory == gcode);
+        }
+        THEN("The extrusions are kept") {
+            LayerMemsize memsize            = layer_memsize(print);
+            LayerMemsize memsize_low_memory = layer_memsize(print_low_memory);
+            REQUIRE(memsize_low_memory.slices           <= memsize.slices);
+            REQUIRE(memsize_low_memory.infill           == memsize.infill);
+            REQUIRE(memsize_low_memory.support_material == memsize.support_material);
+        }
+        THEN("The intermediate layer data are released") {
+            LayerMemsize memsize = layer_memsize(print_low_memory);
+            REQUIRE(memsize.total() < layer_memsize(print).total());
+            REQUIRE(memsize.fill_surfaces == 0);
+            for (const Layer *layer : print_low_memory.objects().front()->layers())
+                for (const LayerRegion *layerm : layer->regions()) {
+                    REQUIRE(layerm->thin_fills.empty());
+                    REQUIRE(layerm->fill_expolygons.empty());
+                }
+        }
+    }
+}
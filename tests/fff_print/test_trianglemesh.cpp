@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 
+#include "libslic3r/BandedMesh.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/TriangleMeshSlicer.hpp"
 #include "libslic3r/Point.hpp"
@@ -11,6 +12,8 @@
 #include <future>
 #include <chrono>
 
+#include <boost/filesystem/operations.hpp>
+
 //#include "test_options.hpp"
 #include "test_data.hpp"
 
@@ -177,6 +180,40 @@ SCENARIO( "TriangleMesh: slice behavior.") {
     }
 }
 
+SCENARIO( "TriangleMesh: slicing out of core.") {
+    GIVEN( "A transformed sphere stored into a banded mesh with small bands") {
+        indexed_triangle_set sphere = its_make_sphere(10., PI / 100.);
+        Transform3d trafo = Transform3d::Identity();
+        trafo.rotate(Eigen::AngleAxisd(0.3, Vec3d::UnitX()));
+        trafo.pretranslate(Vec3d(5., 3., 12.));
+        const std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%-%%%%.bmesh")).string();
+        REQUIRE(BandedMesh::create(sphere, trafo, path, 500));
+        BandedMesh banded;
+        REQUIRE(banded.open(path));
+        THEN( "All facets are stored in multiple bands") {
+            REQUIRE(banded.num_facets() == sphere.indices.size());
+            REQUIRE(banded.num_bands() > 10);
+        }
+        WHEN( "The banded mesh and the in-memory mesh are sliced") {
+            std::vector<float> zs;
+            for (float z = 2.05f; z < 23.f; z += 0.2f)
+                zs.emplace_back(z);
+            MeshSlicingParamsEx params;
+            params.trafo = trafo;
+            std::vector<ExPolygons> slices        = slice_mesh_ex(sphere, zs, params);
+            std::vector<ExPolygons> slices_banded = slice_mesh_ex(banded, zs, MeshSlicingParamsEx{});
+            THEN( "The slices are the same") {
+                REQUIRE(slices_banded.size() == slices.size());
+                for (size_t i = 0; i < zs.size(); ++ i) {
+                    REQUIRE(slices_banded[i].size() == slices[i].size());
+                    REQUIRE(std::abs(area(slices_banded[i]) - area(slices[i])) < 1e-6 * area(slices[i]) + 1.);
+                }
+            }
+        }
+        boost::filesystem::remove(path);
+    }
+}
+
 SCENARIO( "make_xxx functions produce meshes.") {
     GIVEN("make_cube() function") {
         WHEN("make_cube() is called with arguments 20,20,20") {
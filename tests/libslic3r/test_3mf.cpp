@@ -80,6 +80,95 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
     }
 }
 
+SCENARIO("Export+Import of several objects and volumes to/from 3mf file cycle", "[3mf]") {
+    GIVEN("a model of three objects, the first one made of three volumes") {
+        Model src_model;
+        ModelObject *object = src_model.add_object();
+        object->name = "multipart";
+        object->add_volume(make_cube(20., 10., 5.))->name = "cube";
+        ModelVolume *cylinder = object->add_volume(make_cylinder(3., 8., 2. * PI / 36.));
+        cylinder->name = "cylinder";
+        cylinder->set_offset(Vec3d(10., 5., 5.));
+        ModelVolume *modifier = object->add_volume(make_sphere(4., 2. * PI / 18.), ModelVolumeType::PARAMETER_MODIFIER);
+        modifier->name = "modifier";
+        modifier->set_offset(Vec3d(0., 0., 2.5));
+        src_model.add_object()->add_volume(make_cylinder(5., 10., 2. * PI / 24.))->name = "cylinder";
+        src_model.objects.back()->name = "cylinder";
+        src_model.add_object()->add_volume(make_cube(2., 3., 4.))->name = "cube";
+        src_model.objects.back()->name = "cube";
+        src_model.add_default_instances();
+        for (size_t i = 0; i < src_model.objects.size(); ++ i)
+            src_model.objects[i]->instances.front()->set_offset(Vec3d(30. * double(i), 0., 0.));
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = (boost::filesystem::temp_directory_path() / "multiple_objects.3mf").string();
+            REQUIRE(store_3mf(test_file.c_str(), &src_model, nullptr, false));
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                REQUIRE(load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false));
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("each volume gets its own mesh back") {
+                REQUIRE(dst_model.objects.size() == src_model.objects.size());
+                for (size_t i = 0; i < src_model.objects.size(); ++ i) {
+                    const ModelObject &src_object = *src_model.objects[i];
+                    const ModelObject &dst_object = *dst_model.objects[i];
+                    REQUIRE(dst_object.name == src_object.name);
+                    REQUIRE(dst_object.volumes.size() == src_object.volumes.size());
+                    for (size_t j = 0; j < src_object.volumes.size(); ++ j) {
+                        const ModelVolume &src_volume = *src_object.volumes[j];
+                        const ModelVolume &dst_volume = *dst_object.volumes[j];
+                        REQUIRE(dst_volume.name == src_volume.name);
+                        REQUIRE(dst_volume.type() == src_volume.type());
+                        REQUIRE(dst_volume.mesh().facets_count() == src_volume.mesh().facets_count());
+                        REQUIRE(dst_volume.mesh().its.vertices.size() == src_volume.mesh().its.vertices.size());
+                        REQUIRE(dst_volume.mesh().stats().volume == Approx(src_volume.mesh().stats().volume).epsilon(1e-4));
+                        BoundingBoxf3 src_bbox = src_volume.mesh().transformed_bounding_box(src_object.instances.front()->get_matrix() * src_volume.get_matrix());
+                        BoundingBoxf3 dst_bbox = dst_volume.mesh().transformed_bounding_box(dst_object.instances.front()->get_matrix() * dst_volume.get_matrix());
+                        REQUIRE(dst_bbox.min.isApprox(src_bbox.min, 1e-5));
+                        REQUIRE(dst_bbox.max.isApprox(src_bbox.max, 1e-5));
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("2D convex hull of object above the bed", "[3mf]") {
+    GIVEN("model") {
+        Model model;
+        std::string src_file = std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl";
+        load_stl(src_file.c_str(), &model);
+        model.add_default_instances();
+
+        WHEN("model is rotated and scaled above the bed") {
+            ModelObject* object = model.objects.front();
+            object->center_around_origin(false);
+
+            ModelInstance* instance = object->instances.front();
+            instance->set_rotation({ -M_PI / 4.0, 0.1, 0.7 });
+            instance->set_scaling_factor({ 2.0, 1.5, 2.0 });
+            instance->set_offset(Vec3d::Zero());
+            instance->set_offset(Z, - object->get_instance_min_z(0) + 1.);
+
+            // 2D convex hull calculated from the cached 3D convex hull of the volume.
+            const Transform3d trafo   = instance->get_transformation().get_matrix();
+            Polygon           hull_2d = object->convex_hull_2d(trafo);
+            // 2D convex hull calculated from all the vertices of the mesh.
+            Polygon           hull_2d_mesh = its_convex_hull_2d_above(object->volumes.front()->mesh().its,
+                (trafo * object->volumes.front()->get_matrix()).cast<float>(), 0.f);
+
+            THEN("2D convex hull matches the convex hull of the mesh projection") {
+                REQUIRE(! hull_2d.empty());
+                REQUIRE(std::abs(hull_2d.area() - hull_2d_mesh.area()) < 1e-6 * hull_2d_mesh.area());
+            }
+        }
+    }
+}
+
 SCENARIO("2D convex hull of sinking object", "[3mf]") {
     GIVEN("model") {
         // load a model
@@ -130,4 +219,3 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
         }
     }
 }
-
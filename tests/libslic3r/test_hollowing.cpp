@@ -19,3 +19,35 @@ TEST_CASE("Hollow two overlapping spheres") {
     sphere1.WriteOBJFile("twospheres.obj");
 }
 
+
+TEST_CASE("Interior generated from a cached grid matches the uncached one") {
+    using namespace Slic3r;
+
+    TriangleMesh sphere = make_sphere(10., 2 * PI / 20.);
+
+    sla::HollowingConfig hcfg;
+    sla::InteriorGridPtr grid_cache;
+
+    sla::InteriorPtr interior = sla::generate_interior(sphere, hcfg, {}, grid_cache);
+    REQUIRE(interior);
+    REQUIRE(grid_cache);
+
+    // Thinner walls should be generated from the already cached grid
+    hcfg.min_thickness = 1.5;
+    sla::InteriorGrid *cached = grid_cache.get();
+    sla::InteriorPtr interior_cached = sla::generate_interior(sphere, hcfg, {}, grid_cache);
+    sla::InteriorPtr interior_uncached = sla::generate_interior(sphere, hcfg);
+
+    REQUIRE(grid_cache.get() == cached);
+    REQUIRE(interior_cached);
+    REQUIRE(interior_uncached);
+
+    double vol_cached   = its_volume(sla::get_mesh(*interior_cached));
+    double vol_uncached = its_volume(sla::get_mesh(*interior_uncached));
+    REQUIRE(vol_cached == Approx(vol_uncached).epsilon(0.01));
+
+    // Different quality means different voxel size, the grid is regenerated
+    hcfg.quality = 1.;
+    sla::generate_interior(sphere, hcfg, {}, grid_cache);
+    REQUIRE(grid_cache);
+}
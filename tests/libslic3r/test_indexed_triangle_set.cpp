@@ -282,6 +282,28 @@ TEST_CASE("Simplify mesh by Quadric edge collapse to 5%", "[its]")
     CHECK(is_similar(its, mesh.its, cfg));
 }
 
+TEST_CASE("Simplify mesh by Quadric edge collapse in parallel batches to 5%", "[its]")
+{
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    double original_volume = its_volume(mesh.its);
+    uint32_t wanted_count = mesh.its.indices.size() * 0.05;
+    REQUIRE_FALSE(mesh.empty());
+    indexed_triangle_set its = mesh.its; // copy
+    float max_error = std::numeric_limits<float>::max();
+    its_quadric_edge_collapse_par(its, wanted_count, &max_error);
+    CHECK(its.indices.size() <= wanted_count);
+    double volume = its_volume(its);
+    CHECK(fabs(original_volume - volume) < 33.);
+
+    // The edges are collapsed in batches, thus in a slightly different order than one by one.
+    CompareConfig cfg;
+    cfg.max_average_distance = 0.045f;
+    cfg.max_distance         = 0.35f;
+
+    CHECK(is_similar(mesh.its, its, cfg));
+    CHECK(is_similar(its, mesh.its, cfg));
+}
+
 bool exist_triangle_with_twice_vertices(const std::vector<stl_triangle_vertex_indices>& indices)
 {
     for (const auto &face : indices)
@@ -301,6 +323,16 @@ TEST_CASE("Simplify trouble case", "[its]")
     CHECK(!exist_triangle_with_twice_vertices(tm.its.indices));
 }
 
+TEST_CASE("Simplify trouble case in parallel batches", "[its]")
+{
+    TriangleMesh tm = load_model("simplification.obj");
+    REQUIRE_FALSE(tm.empty());
+    float max_error = std::numeric_limits<float>::max();
+    uint32_t wanted_count = 0;
+    its_quadric_edge_collapse_par(tm.its, wanted_count, &max_error);
+    CHECK(!exist_triangle_with_twice_vertices(tm.its.indices));
+}
+
 TEST_CASE("Simplified cube should not be empty.", "[its]")
 {
     auto its = its_make_cube(1, 2, 3);
@@ -23,3 +23,64 @@ TEST_CASE("CGAL and TriangleMesh conversions", "[MeshBoolean]") {
     
     REQUIRE(! MeshBoolean::cgal::does_self_intersect(M));
 }
+
+TEST_CASE("Boolean operations run only on the overlapping parts", "[MeshBoolean]") {
+    // Two disjoint cubes, the second one with a nested cube inside to form a hollow shell.
+    indexed_triangle_set A = its_make_cube(10., 10., 10.);
+    indexed_triangle_set far = its_make_cube(10., 10., 10.);
+    its_transform(far, identity3f().translate(Vec3f{30.f, 0.f, 0.f}));
+    indexed_triangle_set inner = its_make_cube(4., 4., 4.);
+    its_flip_triangles(inner);
+    its_transform(inner, identity3f().translate(Vec3f{33.f, 3.f, 3.f}));
+    its_merge(A, far);
+    its_merge(A, inner);
+
+    MeshBoolean::cgal::PartitionedMesh partitioned(A);
+    REQUIRE(partitioned.num_parts() == 2);
+    REQUIRE(partitioned.does_bound_a_volume());
+
+    // Cut a corner off the first cube.
+    indexed_triangle_set B = its_make_cube(10., 10., 10.);
+    its_transform(B, identity3f().translate(Vec3f{5.f, 5.f, 5.f}));
+    MeshBoolean::cgal::PartitionedMesh partitionedB(B);
+    partitioned.minus(partitionedB);
+    REQUIRE(partitioned.num_parts() == 2);
+
+    indexed_triangle_set result = partitioned.to_its();
+    REQUIRE(its_volume(result) == Approx(1000. - 125. + 1000. - 64.));
+
+    TriangleMesh meshA(A);
+    MeshBoolean::cgal::minus(meshA, TriangleMesh(B));
+    REQUIRE(meshA.volume() == Approx(its_volume(result)));
+}
+
+TEST_CASE("Several holes are subtracted from a hollowed part at once", "[MeshBoolean]") {
+    // Hollowed cube: the outer shell and the interior shell form a single part.
+    indexed_triangle_set A = its_make_cube(20., 20., 20.);
+    indexed_triangle_set interior = its_make_cube(16., 16., 16.);
+    its_flip_triangles(interior);
+    its_transform(interior, identity3f().translate(Vec3f{2.f, 2.f, 2.f}));
+    its_merge(A, interior);
+    MeshBoolean::cgal::PartitionedMesh partitioned(A);
+    REQUIRE(partitioned.num_parts() == 1);
+
+    // Two disjoint holes drilled through the bottom wall, both overlapping the hollowed part.
+    indexed_triangle_set holes;
+    for (float x : { 5.f, 13.f }) {
+        indexed_triangle_set hole = its_make_cube(2., 2., 4.);
+        its_transform(hole, identity3f().translate(Vec3f{x, 5.f, -1.f}));
+        its_merge(holes, hole);
+    }
+    MeshBoolean::cgal::PartitionedMesh partitioned_holes(holes);
+    REQUIRE(partitioned_holes.num_parts() == 2);
+
+    partitioned.minus(partitioned_holes);
+    REQUIRE(partitioned.num_parts() == 1);
+    REQUIRE(its_volume(partitioned.to_its()) == Approx(8000. - 4096. - 2. * 8.));
+}
+
+TEST_CASE("An empty partitioned mesh does not bound a volume", "[MeshBoolean]") {
+    MeshBoolean::cgal::PartitionedMesh empty;
+    REQUIRE(empty.empty());
+    REQUIRE(! empty.does_bound_a_volume());
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+#include "libslic3r/Format/objparser.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+using namespace Slic3r;
+
+SCENARIO("Reading an OBJ file", "[obj]") {
+    GIVEN("an OBJ file with quads") {
+        const std::string path = std::string(TEST_DATA_DIR) + "/extruder_idler_quads.obj";
+        WHEN("the file is loaded into a mesh") {
+            TriangleMesh mesh;
+            REQUIRE(load_obj(path.c_str(), &mesh));
+            THEN("the mesh matches the faces parsed by ObjParser") {
+                ObjParser::ObjData data;
+                REQUIRE(ObjParser::objparse(path.c_str(), data));
+                size_t num_triangles = 0;
+                for (size_t i = 0, cnt = 0; i < data.vertices.size(); ++ i)
+                    if (data.vertices[i].coordIdx == -1) {
+                        num_triangles += cnt - 2;
+                        cnt = 0;
+                    } else
+                        ++ cnt;
+                REQUIRE(mesh.its.vertices.size() == data.coordinates.size() / 4);
+                REQUIRE(mesh.its.indices.size() == num_triangles);
+            }
+        }
+    }
+    GIVEN("an OBJ file with relative vertex indices and mixed line endings") {
+        const std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("obj_test_%%%%-%%%%.obj")).string();
+        {
+            boost::nowide::ofstream out(path, std::ios::binary);
+            out << "v 0 0 0\nv 10 0 0\nv 0 10 0\r\nv 0 0 10\r\n"
+                   "f -4 -2 -3\nf 1/1/1 2/2/2 4/3/3\r\nf 1//1 4//1 3//1\nf 2 3 4\n";
+        }
+        WHEN("the file is loaded into a mesh") {
+            TriangleMesh mesh;
+            bool loaded = load_obj(path.c_str(), &mesh);
+            boost::filesystem::remove(path);
+            THEN("a closed tetrahedron is loaded") {
+                REQUIRE(loaded);
+                REQUIRE(mesh.its.vertices.size() == 4);
+                REQUIRE(mesh.its.indices.size() == 4);
+                REQUIRE(mesh.its.indices.front() == stl_triangle_vertex_indices(0, 2, 1));
+                REQUIRE(mesh.volume() == Approx(1000. / 6.));
+            }
+        }
+    }
+}
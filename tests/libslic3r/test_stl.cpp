@@ -1,7 +1,12 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/Model.hpp"
+#include "libslic3r/Format/MeshCache.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/Utils.hpp"
+
+#include <boost/filesystem.hpp>
 
 using namespace Slic3r;
 
@@ -54,4 +59,123 @@ SCENARIO("Reading an STL file", "[stl]") {
 			}
 		}
 	}
+	GIVEN("a binary STL file read without repair") {
+		const std::string path = stl_path("Geräte/20mmbox-čřšřěá.stl");
+		TriangleMesh repaired;
+		REQUIRE(repaired.ReadSTLFile(path.c_str()));
+		WHEN("the file is memory mapped and indexed directly") {
+			TriangleMesh mesh;
+			REQUIRE(mesh.ReadSTLFile(path.c_str(), false));
+			THEN("the vertices are shared the same way as after the repair") {
+				REQUIRE(mesh.facets_count() == repaired.facets_count());
+				REQUIRE(mesh.its.vertices.size() == repaired.its.vertices.size());
+				REQUIRE(is_approx(mesh.size(), repaired.size()));
+				// The repair may flip a facet, thus compare the facet corners regardless of their order.
+				for (size_t i = 0; i < mesh.its.indices.size(); ++ i)
+					for (int j = 0; j < 3; ++ j) {
+						const stl_vertex &v = mesh.its.vertices[mesh.its.indices[i](j)];
+						const stl_triangle_vertex_indices &f = repaired.its.indices[i];
+						REQUIRE((v == repaired.its.vertices[f(0)] || v == repaired.its.vertices[f(1)] || v == repaired.its.vertices[f(2)]));
+					}
+			}
+		}
+	}
+	GIVEN("an ASCII STL file") {
+		THEN("the direct binary loader refuses it") {
+			indexed_triangle_set its;
+			REQUIRE(! its_read_stl_binary(stl_path("ASCII/20mmbox-LF.stl").c_str(), its));
+		}
+	}
+}
+
+SCENARIO("Loading a binary STL file with the default repair", "[stl]") {
+	auto write_and_load = [](const indexed_triangle_set &its, const char *name) {
+		const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(std::string(name) + "_%%%%-%%%%.stl");
+		REQUIRE(its_write_stl_binary(path.string().c_str(), "", its));
+		Model model;
+		const bool loaded = load_stl(path.string().c_str(), &model);
+		boost::filesystem::remove(path);
+		REQUIRE(loaded);
+		return model.objects.front()->volumes.front()->mesh();
+	};
+	GIVEN("a closed and consistently oriented binary STL") {
+		const std::string path = stl_path("Geräte/20mmbox-čřšřěá.stl");
+		WHEN("it is loaded by load_stl()") {
+			Model model;
+			REQUIRE(load_stl(path.c_str(), &model));
+			const TriangleMesh &mesh = model.objects.front()->volumes.front()->mesh();
+			THEN("the statistics match a repaired 20mm box") {
+				REQUIRE(mesh.facets_count() == 12);
+				REQUIRE(mesh.its.vertices.size() == 8);
+				REQUIRE(mesh.stats().volume == Approx(8000.));
+				REQUIRE(mesh.stats().number_of_parts == 1);
+				REQUIRE(mesh.stats().open_edges == 0);
+				REQUIRE(! mesh.stats().repaired());
+				REQUIRE(is_approx(mesh.size(), Vec3d(20, 20, 20)));
+			}
+		}
+	}
+	GIVEN("two separate cubes") {
+		indexed_triangle_set its = its_make_cube(10., 10., 10.);
+		indexed_triangle_set other = its_make_cube(10., 10., 10.);
+		for (stl_vertex &v : other.vertices)
+			v.x() += 20.f;
+		its_merge(its, other);
+		THEN("the loaded mesh reports two parts") {
+			TriangleMesh mesh = write_and_load(its, "two_cubes");
+			REQUIRE(mesh.stats().number_of_parts == 2);
+			REQUIRE(mesh.stats().volume == Approx(2000.));
+			REQUIRE(mesh.its.vertices.size() == 16);
+		}
+	}
+	GIVEN("a cube with a flipped face") {
+		indexed_triangle_set its = its_make_cube(10., 10., 10.);
+		std::swap(its.indices.back()(0), its.indices.back()(1));
+		THEN("the loaded mesh is repaired by admesh") {
+			TriangleMesh mesh = write_and_load(its, "flipped_face");
+			REQUIRE(mesh.stats().repaired_errors.facets_reversed == 1);
+			REQUIRE(mesh.stats().volume == Approx(1000.));
+			REQUIRE(mesh.stats().open_edges == 0);
+		}
+	}
+	GIVEN("a cube turned inside out") {
+		indexed_triangle_set its = its_make_cube(10., 10., 10.);
+		for (stl_triangle_vertex_indices &face : its.indices)
+			std::swap(face(0), face(1));
+		THEN("the loaded mesh is flipped by admesh") {
+			TriangleMesh mesh = write_and_load(its, "inside_out");
+			REQUIRE(mesh.stats().repaired_errors.facets_reversed == 12);
+			REQUIRE(mesh.stats().volume == Approx(1000.));
+		}
+	}
+}
+
+SCENARIO("Loading an STL file through the mesh cache", "[stl]") {
+	GIVEN("a binary STL file and an empty cache directory") {
+		const std::string             path         = stl_path("Geräte/20mmbox-čřšřěá.stl");
+		const std::string             old_data_dir = data_dir();
+		const boost::filesystem::path cache_dir    = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mesh_cache_%%%%-%%%%");
+		set_data_dir(cache_dir.string());
+		WHEN("the file is loaded twice") {
+			TriangleMesh mesh, convex_hull;
+			const bool   cached_before = mesh_cache_load(path.c_str(), mesh, convex_hull);
+			Model        first         = Model::read_from_file(path, nullptr, nullptr, Model::LoadAttribute::UseMeshCache);
+			const bool   cached_after  = mesh_cache_load(path.c_str(), mesh, convex_hull);
+			Model        second        = Model::read_from_file(path, nullptr, nullptr, Model::LoadAttribute::UseMeshCache);
+			set_data_dir(old_data_dir);
+			boost::filesystem::remove_all(cache_dir);
+			THEN("the second load is served from the cache and produces the same model") {
+				REQUIRE(! cached_before);
+				REQUIRE(cached_after);
+				const ModelVolume &v1 = *first.objects.front()->volumes.front();
+				const ModelVolume &v2 = *second.objects.front()->volumes.front();
+				REQUIRE(v1.mesh().its.vertices == v2.mesh().its.vertices);
+				REQUIRE(v1.mesh().its.indices == v2.mesh().its.indices);
+				REQUIRE(v1.mesh().stats().number_of_parts == v2.mesh().stats().number_of_parts);
+				REQUIRE(v1.mesh().stats().volume == v2.mesh().stats().volume);
+				REQUIRE(v1.get_convex_hull().its.vertices == v2.get_convex_hull().its.vertices);
+				REQUIRE(is_approx(v1.get_offset(), v2.get_offset()));
+			}
+		}
+	}
 }
@@ -0,0 +1,93 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Zipper.hpp"
+#include "libslic3r/miniz_extension.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+using namespace Slic3r;
+
+SCENARIO("Zip entries compressed in parallel blocks", "[Zipper]") {
+    GIVEN("data spanning multiple compression blocks") {
+        std::string data;
+        for (int i = 0; i < 100000; ++ i)
+            data += "<vertex x=\"" + std::to_string(i % 977) + "\"/>\n";
+
+        std::string path = (boost::filesystem::temp_directory_path() / "parallel_deflate.zip").string();
+
+        WHEN("written by blocks and by the Zipper") {
+            {
+                mz_zip_archive archive;
+                mz_zip_zero_struct(&archive);
+                REQUIRE(open_zip_writer(&archive, path));
+                MZ_ParallelDeflate stream(MZ_DEFAULT_LEVEL, 10000);
+                for (size_t i = 0; i < data.size(); i += 3333)
+                    stream.append(data.data() + i, std::min<size_t>(3333, data.size() - i));
+                REQUIRE(stream.add_to_archive(archive, "blocks.txt"));
+                MZ_ParallelDeflate empty;
+                REQUIRE(empty.add_to_archive(archive, "empty.txt"));
+                REQUIRE(mz_zip_writer_finalize_archive(&archive));
+                close_zip_writer(&archive);
+            }
+
+            std::string zipper_path = path + ".2";
+            {
+                Zipper zipper(zipper_path);
+                zipper.add_entry("streamed.txt");
+                zipper << data;
+                zipper.add_entry("buffer.txt", data.data(), data.size());
+                zipper.finalize();
+            }
+
+            THEN("the entries read back intact") {
+                for (const std::string &fname : { path, zipper_path }) {
+                    mz_zip_archive archive;
+                    mz_zip_zero_struct(&archive);
+                    REQUIRE(open_zip_reader(&archive, fname));
+                    REQUIRE(mz_zip_reader_get_num_files(&archive) == 2);
+                    for (mz_uint i = 0; i < 2; ++ i) {
+                        mz_zip_archive_file_stat stat;
+                        REQUIRE(mz_zip_reader_file_stat(&archive, i, &stat));
+                        std::string out(size_t(stat.m_uncomp_size), '\0');
+                        if (!out.empty())
+                            REQUIRE(mz_zip_reader_extract_to_mem(&archive, i, out.data(), out.size(), 0));
+                        REQUIRE((out.empty() || out == data));
+                    }
+                    close_zip_reader(&archive);
+                    boost::filesystem::remove(fname);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Zip entry of parallel blocks with a maximum size above 4GB", "[Zipper]") {
+    GIVEN("an entry reserving the zip64 fields") {
+        std::string data(100000, 'a');
+        std::string path = (boost::filesystem::temp_directory_path() / "parallel_deflate_zip64.zip").string();
+        {
+            mz_zip_archive archive;
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_writer(&archive, path));
+            MZ_ParallelDeflate stream(MZ_DEFAULT_LEVEL, 30000);
+            stream.append(data.data(), data.size());
+            REQUIRE(stream.add_to_archive(archive, "zip64.txt", (uint64_t(1) << 30) * 16));
+            REQUIRE(mz_zip_writer_finalize_archive(&archive));
+            close_zip_writer(&archive);
+        }
+        THEN("the entry reads back intact") {
+            mz_zip_archive archive;
+            mz_zip_zero_struct(&archive);
+            REQUIRE(open_zip_reader(&archive, path));
+            REQUIRE(mz_zip_reader_get_num_files(&archive) == 1);
+            mz_zip_archive_file_stat stat;
+            REQUIRE(mz_zip_reader_file_stat(&archive, 0, &stat));
+            REQUIRE(stat.m_uncomp_size == data.size());
+            std::string out(data.size(), '\0');
+            REQUIRE(mz_zip_reader_extract_to_mem(&archive, 0, out.data(), out.size(), 0));
+            REQUIRE(out == data);
+            close_zip_reader(&archive);
+            boost::filesystem::remove(path);
+        }
+    }
+}
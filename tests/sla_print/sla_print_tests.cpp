@@ -9,6 +9,7 @@
 #include <libslic3r/TriangleMeshSlicer.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/SLA/Concurrency.hpp>
+#include <libslic3r/SLA/Rotfinder.hpp>
 
 namespace {
 
@@ -126,6 +127,88 @@ TEST_CASE("WingedPadAroundObjectIsValid", "[SLASupportGeneration]") {
     for (auto &fname : AROUND_PAD_TEST_OBJECTS) test_pad(fname, padcfg);
 }
 
+TEST_CASE("Pad geometry does not depend on the meshing order", "[SLASupportGeneration]") {
+    sla::PadConfig padcfg;
+    padcfg.wall_height_mm = 1.;
+    padcfg.max_merge_dist_mm = 1.;
+
+    // Distant squares with holes give multiple pad parts with holes
+    ExPolygons blueprint;
+    for (int i = 0; i < 4; ++i) {
+        blueprint.emplace_back(square_with_hole(20.));
+        blueprint.back().translate(scaled(i * 50.), 0);
+    }
+
+    indexed_triangle_set first, second;
+    sla::create_pad(blueprint, {}, first, padcfg);
+    sla::create_pad(blueprint, {}, second, padcfg);
+
+    REQUIRE_FALSE(first.empty());
+    REQUIRE(first.vertices == second.vertices);
+    REQUIRE(first.indices == second.indices);
+
+    check_validity(TriangleMesh{first});
+}
+
+TEST_CASE("Pad from a support blueprint matches the pad from the mesh", "[SLASupportGeneration]") {
+    sla::PadConfig padcfg;
+    TriangleMesh supports = make_cube(20., 20., 10.);
+    double ground_level = 0.;
+
+    sla::Pad direct{supports.its, {}, ground_level, padcfg, [] {}};
+
+    ExPolygons bp = sla::Pad::support_blueprint(supports.its, ground_level,
+                                                padcfg, [] {});
+    sla::Pad cached{bp, {}, ground_level, padcfg, [] {}};
+
+    REQUIRE_FALSE(direct.empty());
+    REQUIRE(direct.tmesh.vertices == cached.tmesh.vertices);
+    REQUIRE(direct.tmesh.indices == cached.tmesh.indices);
+}
+
+TEST_CASE("Pad blueprint is reused until the supports or the pad range change", "[SLASupportGeneration]") {
+    sla::SupportTreeBuilder builder;
+    for (double x : {0., 20.})
+        for (double y : {0., 20.})
+            builder.add_pillar(Vec3d{x, y, 0.}, 10., 1.);
+
+    sla::PadConfig padcfg;
+    builder.add_pad({}, padcfg);
+    const ExPolygons  blueprint = builder.pad_blueprint();
+    const ExPolygon  *data      = builder.pad_blueprint().data();
+    REQUIRE(blueprint.size() == 4);
+    REQUIRE_FALSE(builder.pad().empty());
+
+    SECTION("Unchanged supports and pad range reuse the blueprint") {
+        padcfg.brim_size_mm = 3.;
+        padcfg.max_merge_dist_mm = 10.;
+        builder.add_pad({}, padcfg);
+        REQUIRE(builder.pad_blueprint().data() == data);
+        REQUIRE(builder.pad_blueprint() == blueprint);
+    }
+
+    // A new blueprint is allocated before the old one is released, thus
+    // its storage differs from the reused one.
+    SECTION("Changed pad range samples the blueprint again") {
+        padcfg.wall_height_mm = 2.;
+        builder.add_pad({}, padcfg);
+        REQUIRE(builder.pad_blueprint().data() != data);
+    }
+
+    SECTION("Changed supports sample the blueprint again") {
+        builder.add_pillar(Vec3d{100., 0., 0.}, 10., 1.);
+        builder.add_pad({}, padcfg);
+        REQUIRE(builder.pad_blueprint().size() == blueprint.size() + 1);
+    }
+
+    SECTION("Removing the pad keeps the blueprint") {
+        builder.remove_pad();
+        REQUIRE(builder.pad().empty());
+        builder.add_pad({}, padcfg);
+        REQUIRE(builder.pad_blueprint().data() == data);
+    }
+}
+
 TEST_CASE("ElevatedSupportGeometryIsValid", "[SLASupportGeneration]") {
     sla::SupportTreeConfig supportcfg;
     supportcfg.object_elevation_mm = 10.;
@@ -140,6 +223,42 @@ TEST_CASE("FloorSupportGeometryIsValid", "[SLASupportGeneration]") {
     for (auto &fname: SUPPORT_TEST_MODELS) test_supports(fname, supportcfg);
 }
 
+TEST_CASE("Support slices are reused for an unchanged slice grid", "[SLASupportGeneration]") {
+    sla::SupportTreeConfig supportcfg;
+    supportcfg.object_elevation_mm = 10.;
+
+    SupportByproducts byproducts;
+    test_supports(SUPPORT_TEST_MODELS[0], supportcfg, byproducts);
+    const sla::SupportTree &tree = byproducts.supporttree;
+    const std::vector<float> &grid = byproducts.slicegrid;
+
+    sla::SupportSlicesCache cache;
+    REQUIRE(cache.slice(tree, grid, CLOSING_RADIUS).size() == grid.size());
+
+    SECTION("Slicing with the same grid returns the same slices") {
+        REQUIRE(cache.slice(tree, grid, CLOSING_RADIUS) ==
+                tree.slice(sla::MeshType::Support, grid, CLOSING_RADIUS));
+    }
+
+    SECTION("Slicing with a different grid slices the tree again") {
+        std::vector<float> coarse;
+        for (size_t i = 0; i < grid.size(); i += 2) coarse.emplace_back(grid[i]);
+        REQUIRE(cache.slice(tree, coarse, CLOSING_RADIUS) ==
+                tree.slice(sla::MeshType::Support, coarse, CLOSING_RADIUS));
+    }
+
+    SECTION("Slicing with a different closing radius slices the tree again") {
+        REQUIRE(cache.slice(tree, grid, 2 * CLOSING_RADIUS) ==
+                tree.slice(sla::MeshType::Support, grid, 2 * CLOSING_RADIUS));
+    }
+
+    SECTION("Slicing after clear() slices the tree again") {
+        cache.clear();
+        REQUIRE(cache.slice(tree, grid, CLOSING_RADIUS) ==
+                tree.slice(sla::MeshType::Support, grid, CLOSING_RADIUS));
+    }
+}
+
 TEST_CASE("ElevatedSupportsDoNotPierceModel", "[SLASupportGeneration]") {
     
     sla::SupportTreeConfig supportcfg;
@@ -223,6 +342,154 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
 }
 
 
+TEST_CASE("RasterizedSegmentsShouldMatchPolygon", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::RasterBase::Resolution res{2560, 1440};
+    sla::RasterBase::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+
+    sla::RasterGrayscaleAAGammaPower raster_poly(res, pixdim, {}, 1.);
+    sla::RasterGrayscaleAAGammaPower raster_segm(res, pixdim, {}, 1.);
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+
+    ExPolygon poly = square_with_hole(30.);
+    poly.translate(bb.center().x(), bb.center().y());
+    raster_poly.draw(poly);
+
+    // The order of the segments should not matter
+    Lines segments = to_lines(poly);
+    std::reverse(segments.begin(), segments.end());
+    raster_segm.draw(segments, sla::RasterBase::frNonZero);
+
+    REQUIRE(raster_white_area(raster_segm) == Approx(raster_white_area(raster_poly)));
+
+    raster_segm.clear();
+    raster_segm.draw(segments, sla::RasterBase::frEvenOdd);
+    REQUIRE(raster_white_area(raster_segm) == Approx(raster_white_area(raster_poly)));
+
+    // Segments of a sliced mesh should fill the cross section
+    TriangleMesh cube = make_cube(20., 20., 20.);
+    cube.translate(disp_w / 2., disp_h / 2., 0.);
+    std::vector<Lines> layers = slice_mesh_segments(cube.its, {10.f}, Transform3d::Identity());
+    REQUIRE(layers.size() == 1);
+
+    raster_segm.clear();
+    raster_segm.draw(layers.front(), sla::RasterBase::frNonZero);
+    REQUIRE(raster_white_area(raster_segm) == Approx(400.).epsilon(0.01));
+}
+
+TEST_CASE("RasterizedSegmentsOnDegenerateSlicesShouldMatchPolygons", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::RasterBase::Resolution res{2560, 1440};
+    sla::RasterBase::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+
+    sla::RasterGrayscaleAAGammaPower raster_poly(res, pixdim, {}, 1.);
+    sla::RasterGrayscaleAAGammaPower raster_segm(res, pixdim, {}, 1.);
+
+    // A 20x20x10 block with a 10x10x10 block standing on it, their touching
+    // horizontal faces lie in the z = 10 plane.
+    indexed_triangle_set mesh = its_make_cube(20., 20., 10.);
+    indexed_triangle_set upper = its_make_cube(10., 10., 10.);
+    for (Vec3f &v : upper.vertices)
+        v.z() += 10.f;
+    its_merge(mesh, upper);
+
+    // An octahedron with its equator edges in the z = 10 plane and its apexes
+    // touching the z = 5 and z = 15 planes.
+    const float r = 5.f;
+    indexed_triangle_set octahedron;
+    octahedron.vertices = { {40.f + r, 10.f, 10.f}, {40.f, 10.f + r, 10.f},
+                            {40.f - r, 10.f, 10.f}, {40.f, 10.f - r, 10.f},
+                            {40.f, 10.f, 10.f + r}, {40.f, 10.f, 10.f - r} };
+    octahedron.indices  = { {0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {3, 0, 4},
+                            {1, 0, 5}, {2, 1, 5}, {3, 2, 5}, {0, 3, 5} };
+    its_merge(mesh, octahedron);
+
+    // A tetrahedron with a vertex at each of the z = 0, 5, 10 and 15 planes.
+    indexed_triangle_set tetrahedron;
+    tetrahedron.vertices = { {-30.f, 0.f, 0.f}, {-10.f, 5.f, 5.f}, {-25.f, 20.f, 10.f}, {-20.f, 8.f, 15.f} };
+    tetrahedron.indices  = { {0, 2, 1}, {0, 1, 3}, {1, 2, 3}, {2, 0, 3} };
+    its_merge(mesh, tetrahedron);
+
+    for (Vec3f &v : mesh.vertices) {
+        v.x() += float(disp_w / 2.);
+        v.y() += float(disp_h / 2. - 10.);
+    }
+
+    const std::vector<float> zs = { 0.f, 2.5f, 5.f, 7.5f, 10.f, 12.5f, 15.f, 17.5f, 20.f };
+    std::vector<ExPolygons> slices = slice_mesh_ex(mesh, zs);
+    std::vector<Lines> layers = slice_mesh_segments(mesh, zs, Transform3d::Identity());
+    MeshSegmentSlicer slicer(mesh, zs, Transform3d::Identity());
+    REQUIRE(slices.size() == zs.size());
+    REQUIRE(layers.size() == zs.size());
+    REQUIRE(slicer.num_planes() == zs.size());
+
+    for (size_t i = 0; i < zs.size(); ++ i) {
+        // Slicing a single plane gives the same segments as slicing all of them.
+        REQUIRE(slicer.slice(i) == layers[i]);
+
+        raster_poly.clear();
+        for (const ExPolygon &poly : slices[i])
+            raster_poly.draw(poly);
+
+        for (sla::RasterBase::FillRule rule : { sla::RasterBase::frNonZero, sla::RasterBase::frEvenOdd }) {
+            raster_segm.clear();
+            raster_segm.draw(layers[i], rule);
+            REQUIRE(raster_white_area(raster_segm) == Approx(raster_white_area(raster_poly)).epsilon(0.01).margin(0.1));
+        }
+    }
+
+    // The touching horizontal faces, the edges and the vertices lying on the planes neither add nor remove any area.
+    raster_segm.clear();
+    raster_segm.draw(layers[4], sla::RasterBase::frNonZero);
+    double tetrahedron_area = 0.;
+    for (const ExPolygon &poly : slices[4])
+        if (poly.contour.bounding_box().max.x() < scaled(disp_w / 2. - 5.))
+            tetrahedron_area += unscaled<double>(unscaled<double>(poly.area()));
+    REQUIRE(tetrahedron_area > 0.);
+    REQUIRE(raster_white_area(raster_segm) == Approx(400. + 2. * r * r + tetrahedron_area).epsilon(0.01));
+}
+
+TEST_CASE("Rotation scores on the normal histogram match the exact scores", "[SLARotfinder]") {
+    TriangleMesh mesh = load_model("frog_legs.obj");
+    REQUIRE_FALSE(mesh.empty());
+
+    // Rotations around the X and Y axes on a grid with a step of 22.5 degrees.
+    std::vector<Vec2d> rotations;
+    for (int i = 0; i < 16; ++i)
+        for (int j = 0; j < 16; ++j)
+            rotations.emplace_back(-PI + i * PI / 8., -PI + j * PI / 8.);
+
+    auto check_scores = [&mesh, &rotations](auto scorefn, bool maximize) {
+        std::vector<double> exact, proxy;
+        for (const Vec2d &rot : rotations) {
+            exact.emplace_back(scorefn(mesh, rot, true));
+            proxy.emplace_back(scorefn(mesh, rot, false));
+            REQUIRE(proxy.back() == Approx(exact.back()).epsilon(0.01));
+        }
+
+        auto best = [maximize](const std::vector<double> &scores) {
+            return size_t(maximize ? std::max_element(scores.begin(), scores.end()) - scores.begin() :
+                                     std::min_element(scores.begin(), scores.end()) - scores.begin());
+        };
+
+        // The rotation chosen by the proxy score is the best one or one as
+        // good as the best one.
+        REQUIRE(exact[best(proxy)] == Approx(exact[best(exact)]).epsilon(0.01));
+    };
+
+    SECTION("Misalignment score") {
+        check_scores([](const TriangleMesh &m, const Vec2d &rot, bool exact) {
+            return sla::get_misalignment_score(m, rot, exact);
+        }, true);
+    }
+
+    SECTION("Supportedness score") {
+        check_scores([](const TriangleMesh &m, const Vec2d &rot, bool exact) {
+            return sla::get_supportedness_score(m, rot, exact);
+        }, false);
+    }
+}
+
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
 